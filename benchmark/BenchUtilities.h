@@ -0,0 +1,115 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** helper functions shared by the benchmark executables */
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#include "boost/chrono.hpp"
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+	#include <unistd.h>
+	#include <cstdio>
+	#ifdef __APPLE__
+		#include <mach/mach.h>
+	#endif
+#endif
+
+
+/** monotonic wall time [ms] */
+inline double wallTime()
+{
+	return boost::chrono::duration<double,boost::milli>( boost::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+/** peak resident set size of the process in bytes */
+inline size_t peakRSS()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS info;
+	GetProcessMemoryInfo( GetCurrentProcess(), &info, sizeof(info) );
+	return (size_t)info.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if( getrusage( RUSAGE_SELF, &usage )!=0 ) return 0;
+	#ifdef __APPLE__
+		return (size_t)usage.ru_maxrss; // bytes on OS X
+	#else
+		return (size_t)usage.ru_maxrss*1024; // kilobytes on Linux
+	#endif
+#endif
+}
+
+/** current resident set size of the process in bytes: unlike the peak, it can be attributed to a single run of several in the same process */
+inline size_t currentRSS()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS info;
+	GetProcessMemoryInfo( GetCurrentProcess(), &info, sizeof(info) );
+	return (size_t)info.WorkingSetSize;
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count )!=KERN_SUCCESS ) return 0;
+	return (size_t)info.resident_size;
+#else
+	FILE* statm = fopen( "/proc/self/statm", "r" );
+	if( statm==NULL ) return 0;
+	long pages = 0, resident = 0;
+	int read = fscanf( statm, "%ld %ld", &pages, &resident );
+	fclose( statm );
+	if( read!=2 ) return 0;
+	return (size_t)resident*(size_t)sysconf( _SC_PAGESIZE );
+#endif
+}
+
+/** nearest rank percentile of a sorted vector */
+inline double percentile( const std::vector<double>& _sorted, double _p )
+{
+	if( _sorted.empty() ) return 0;
+	unsigned int rank = (unsigned int)ceil( _p/100*_sorted.size() );
+	if( rank>0 ) rank--;
+	if( rank>=_sorted.size() ) rank = _sorted.size()-1;
+	return _sorted[rank];
+}
+
+/** splits a comma separated list, empty entries are skipped */
+inline std::vector<std::string> splitList( std::string _list )
+{
+	std::vector<std::string> entries;
+	size_t start = 0;
+	while( start<=_list.size() )
+	{
+		size_t end = _list.find( ',', start );
+		if( end==std::string::npos ) end = _list.size();
+		if( end>start ) entries.push_back( _list.substr( start, end-start ) );
+		start = end+1;
+	}
+	return entries;
+}
@@ -0,0 +1,97 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "DynamicsHost.h"
+
+
+DynamicsHost::DynamicsHost( ObjectHandler* _environmentControl, string _dynamicsType, Size _frameSize, unsigned int _historyLength ):GenericObject( _environmentControl, -1 ), pDynamicsType(_dynamicsType), pFrameSize(_frameSize), pHistoryLength(_historyLength)
+{
+	// the dynamics module holds a pointer to its object: the additional reference keeps it from deleting the host when it is destroyed itself
+	Ptr<GenericObject> self(this);
+	self.addref();
+
+	pDynamics = Dynamics::createDynamics( _dynamicsType, self );
+	if( pDynamics.empty() )
+	{
+		cerr<<endl<<"DynamicsHost::DynamicsHost:: Unknown dynamics type "<<_dynamicsType<<endl;
+		return;
+	}
+
+	GenericMultiLevelMap<string> dynamicsOptions;
+	Dynamics::setStandardSettings( _dynamicsType, dynamicsOptions );
+	pDynamics->setOptions( dynamicsOptions );
+}
+
+
+DynamicsHost::~DynamicsHost(void)
+{
+
+}
+
+
+bool DynamicsHost::valid()
+{
+	return !pDynamics.empty();
+}
+
+
+string DynamicsHost::dynamicsType()
+{
+	return pDynamicsType;
+}
+
+
+bool DynamicsHost::addState( Ptr<SceneObject::State> _newState, RectangleRegion& _regionOfInterest, vector<Point>& _contour )
+{
+	bool success = GenericObject::addState( _newState, _regionOfInterest, _contour );
+	if( pHistoryLength>0 )
+	{
+		while( pHistory.size()>pHistoryLength ) pHistory.pop_front();
+	}
+	return success;
+}
+
+
+void DynamicsHost::classProperties( string& _className, Scalar& _classColor )
+{
+	_className = pDynamicsType;
+	_classColor = color();
+}
+
+
+Scalar DynamicsHost::color()
+{
+	return Scalar(0,0,255);
+}
+
+
+bool DynamicsHost::touchesImageBorder()
+{
+	int minX = min( min(pROI[0].x,pROI[1].x), min(pROI[2].x,pROI[3].x) );
+	int maxX = max( max(pROI[0].x,pROI[1].x), max(pROI[2].x,pROI[3].x) );
+
+	int minY = min( min(pROI[0].y,pROI[1].y), min(pROI[2].y,pROI[3].y) );
+	int maxY = max( max(pROI[0].y,pROI[1].y), max(pROI[2].y,pROI[3].y) );
+
+	int borderRange = (*Options::General)["object_detection"]["window_border_range"].as<unsigned int>();
+
+	return minX<=borderRange || minY<=borderRange || maxX>=pFrameSize.width-borderRange || maxY>=pFrameSize.height-borderRange;
+}
@@ -0,0 +1,55 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Dynamics.h"
+
+/** a generic object without class that hosts an arbitrary registered dynamics module
+*
+* Used by the benchmarks to drive the dynamics modules outside of the tracking pipeline. The object never enters an ObjectHandler
+* object list, the handler is only needed for the options of the base classes.
+*/
+class DynamicsHost: public GenericObject
+{
+public:
+	/**
+	* @param	_environmentControl	handler whose options the object uses
+	* @param	_dynamicsType	name of a registered dynamics module, set up with its standard settings
+	* @param	_frameSize	size of the images the object moves in (used instead of the image size of the handler)
+	* @param	_historyLength	number of states kept in the history, 0 for no limit
+	*/
+	DynamicsHost( ObjectHandler* _environmentControl, string _dynamicsType, Size _frameSize, unsigned int _historyLength=32 );
+	~DynamicsHost(void);
+
+	/** returns true if the dynamics type could be created */
+	bool valid();
+	string dynamicsType();
+
+	virtual bool addState( Ptr<SceneObject::State> _newState, RectangleRegion& _regionOfInterest, vector<Point>& _contour );
+	virtual void classProperties( string& _className, Scalar& _classColor );
+	virtual Scalar color();
+	virtual bool touchesImageBorder();
+
+private:
+	string pDynamicsType;
+	Size pFrameSize;
+	unsigned int pHistoryLength;
+};
@@ -0,0 +1,443 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SyntheticSwarm.h"
+#include <cmath>
+#include <algorithm>
+#include "opencv2/imgproc/imgproc.hpp"
+
+
+SyntheticSwarm::Settings::Settings():objectCount(100),frameSize(0,0),areaPerObject(2500),objectLength(30),objectWidth(10),speed(2),maxSpeed(8),positionNoise(0.3),angleNoise(0.03),clusterFraction(0.3),clusterSize(3),frameRate(30),background(235),foreground(60),sensorNoise(4),seed(1)
+{
+	dynamicsTypes.push_back("NonHoloKalman2D");
+}
+
+
+SyntheticSwarm::SyntheticSwarm( ObjectHandler* _environmentControl, const Settings& _settings ):pSettings(_settings),pRng(_settings.seed),pValid(true),pFrameCount(0),pTouching(0),pBlobs(0),pTouchingTotal(0),pAppearancesTotal(0)
+{
+	if( pSettings.dynamicsTypes.empty() ) pSettings.dynamicsTypes.push_back("NonHoloKalman2D");
+	if( pSettings.frameRate<=0 ) pSettings.frameRate = 30;
+	if( pSettings.clusterSize==0 ) pSettings.clusterSize = 1;
+
+	if( pSettings.frameSize.width<=0 || pSettings.frameSize.height<=0 )
+	{
+		int width = (int)sqrt( pSettings.objectCount*pSettings.areaPerObject*4.0/3.0 );
+		width = max( width, 320 );
+		width -= width%4;
+		pSettings.frameSize = Size( width, width/4*3 );
+	}
+
+	pObjectImage = Mat( 1, 1, CV_8UC1, Scalar(255) );
+
+	pHosts.reserve( pSettings.objectCount );
+	for( unsigned int i=0; i<pSettings.objectCount; i++ )
+	{
+		Ptr<DynamicsHost> host = new DynamicsHost( _environmentControl, pSettings.dynamicsTypes[ i%pSettings.dynamicsTypes.size() ], pSettings.frameSize );
+		if( !host->valid() )
+		{
+			pValid = false;
+			return;
+		}
+		pHosts.push_back( host );
+	}
+
+	spawn();
+}
+
+
+bool SyntheticSwarm::valid()
+{
+	return pValid;
+}
+
+
+SyntheticSwarm& SyntheticSwarm::operator>>( Mat& _frame )
+{
+	nextFrame( _frame );
+	return *this;
+}
+
+
+void SyntheticSwarm::nextFrame( Mat& _frame )
+{
+	if( !pValid ) return;
+
+	move();
+	findContacts();
+
+	double time = pFrameCount*framePeriod();
+	for( unsigned int i=0; i<pTruth.size(); i++ ) feed( i, pTruth[i].x, pTruth[i].y, pTruth[i].angle, time );
+
+	render( _frame );
+	pFrameCount++;
+}
+
+
+double SyntheticSwarm::time() const
+{
+	if( pFrameCount==0 ) return 0;
+	return (pFrameCount-1)*framePeriod();
+}
+
+
+unsigned int SyntheticSwarm::frameCount() const
+{
+	return pFrameCount;
+}
+
+
+Size SyntheticSwarm::frameSize() const
+{
+	return pSettings.frameSize;
+}
+
+
+unsigned int SyntheticSwarm::objectCount() const
+{
+	return pSettings.objectCount;
+}
+
+
+double SyntheticSwarm::frameRate() const
+{
+	return pSettings.frameRate;
+}
+
+
+const vector<SyntheticSwarm::TruthEntry>& SyntheticSwarm::groundTruth() const
+{
+	return pTruth;
+}
+
+
+unsigned int SyntheticSwarm::touchingObjects() const
+{
+	return pTouching;
+}
+
+
+unsigned int SyntheticSwarm::blobCount() const
+{
+	return pBlobs;
+}
+
+
+double SyntheticSwarm::mergeFrequency() const
+{
+	if( pAppearancesTotal==0 ) return 0;
+	return pTouchingTotal/pAppearancesTotal;
+}
+
+
+void SyntheticSwarm::writeGroundTruthHeader( ostream& _out, const string& _prefix )
+{
+	_out<<_prefix<<"frame,time,id,x,y,angle,touching"<<endl;
+}
+
+
+void SyntheticSwarm::writeGroundTruth( ostream& _out, const string& _prefix ) const
+{
+	for( unsigned int i=0; i<pTruth.size(); i++ )
+	{
+		const TruthEntry& entry = pTruth[i];
+		_out<<_prefix<<entry.frame<<","<<entry.time<<","<<entry.id<<","<<entry.x<<","<<entry.y<<","<<entry.angle<<","<<( entry.touching?1:0 )<<"\n";
+	}
+}
+
+
+void SyntheticSwarm::spawn()
+{
+	pTruth.resize( pSettings.objectCount );
+
+	double margin = pSettings.objectLength;
+	double width = pSettings.frameSize.width;
+	double height = pSettings.frameSize.height;
+
+	unsigned int clustered = (unsigned int)( pSettings.clusterFraction*pSettings.objectCount + 0.5 );
+	clustered = min( clustered, pSettings.objectCount );
+
+	unsigned int id = 0;
+	// clusters: objects side by side with slightly different headings and speeds, they touch in the first frames and drift apart later
+	while( id<clustered )
+	{
+		Point2f pos( (float)pRng.uniform( margin, width-margin ), (float)pRng.uniform( margin, height-margin ) );
+		double heading = pRng.uniform( 0.0, 2*CV_PI );
+		double speed = pSettings.speed*pRng.uniform( 0.5, 1.5 );
+		Point2f normal( (float)-sin(heading), (float)cos(heading) );
+
+		unsigned int members = min( pSettings.clusterSize, clustered-id );
+		for( unsigned int k=0; k<members; k++ )
+		{
+			Point2f memberPos = pos + normal*(float)( k*pSettings.objectWidth );
+			memberPos.x = min( max( memberPos.x, (float)margin ), (float)(width-margin) );
+			memberPos.y = min( max( memberPos.y, (float)margin ), (float)(height-margin) );
+			spawnObject( id++, memberPos, heading+pRng.gaussian(0.1), speed*( 1+pRng.gaussian(0.1) ) );
+		}
+	}
+
+	while( id<pSettings.objectCount )
+	{
+		Point2f pos( (float)pRng.uniform( margin, width-margin ), (float)pRng.uniform( margin, height-margin ) );
+		spawnObject( id++, pos, pRng.uniform( 0.0, 2*CV_PI ), pSettings.speed*pRng.uniform( 0.5, 1.5 ) );
+	}
+}
+
+
+void SyntheticSwarm::spawnObject( unsigned int _id, Point2f _pos, double _heading, double _speed )
+{
+	double period = framePeriod();
+	Point2f velocity( (float)( _speed*cos(_heading) ), (float)( _speed*sin(_heading) ) );
+	Point2f lastPos = _pos-velocity;
+
+	TruthEntry& entry = pTruth[_id];
+	entry.frame = 0;
+	entry.time = -period;
+	entry.id = _id;
+	entry.x = lastPos.x;
+	entry.y = lastPos.y;
+	entry.angle = (float)_heading;
+	entry.touching = false;
+
+	// two states give the modules an initial velocity estimate
+	feed( _id, lastPos.x-velocity.x, lastPos.y-velocity.y, _heading, -2*period );
+	feed( _id, lastPos.x, lastPos.y, _heading, -period );
+}
+
+
+void SyntheticSwarm::feed( unsigned int _id, double _x, double _y, double _angle, double _time )
+{
+	Mat state( 1, 3, CV_32FC1 );
+	state.at<float>(0) = (float)_x;
+	state.at<float>(1) = (float)_y;
+	state.at<float>(2) = (float)_angle;
+
+	RotatedRect box( Point2f( (float)_x, (float)_y ), Size2f( (float)pSettings.objectLength, (float)pSettings.objectWidth ), (float)( _angle*180/CV_PI ) );
+	RectangleRegion region( box );
+	vector<Point> contour;
+	region.points( contour );
+
+	// the modules expect an empty image if the state was inferred from a merged blob
+	Mat noImage;
+	Mat& invImg = pTruth[_id].touching? noImage : pObjectImage;
+
+	Ptr<SceneObject::State> newState = pHosts[_id]->newState( state, region, contour, invImg, _time );
+	pHosts[_id]->addState( newState, region, contour );
+}
+
+
+void SyntheticSwarm::move()
+{
+	double time = pFrameCount*framePeriod();
+	double margin = pSettings.objectLength/2;
+	double maxX = pSettings.frameSize.width-margin;
+	double maxY = pSettings.frameSize.height-margin;
+
+	for( unsigned int i=0; i<pTruth.size(); i++ )
+	{
+		TruthEntry& entry = pTruth[i];
+
+		double x = entry.x, y = entry.y, angle = entry.angle;
+		Mat prediction = pHosts[i]->predictState();
+		if( !prediction.empty() )
+		{
+			double predX = prediction.at<float>(0), predY = prediction.at<float>(1), predAngle = prediction.at<float>(2);
+			if( predX==predX && predY==predY && predAngle==predAngle ) // NaN check
+			{
+				x = predX;
+				y = predY;
+				angle = predAngle;
+			}
+		}
+
+		// limit the speed, some modules extrapolate noisy velocity estimates
+		double dX = x-entry.x, dY = y-entry.y;
+		double speed = sqrt( dX*dX+dY*dY );
+		if( speed>pSettings.maxSpeed )
+		{
+			dX *= pSettings.maxSpeed/speed;
+			dY *= pSettings.maxSpeed/speed;
+		}
+
+		x = entry.x + dX + pRng.gaussian( pSettings.positionNoise );
+		y = entry.y + dY + pRng.gaussian( pSettings.positionNoise );
+		angle += pRng.gaussian( pSettings.angleNoise );
+
+		// reflection at the image borders
+		bool reflected = false;
+		if( x<margin ){ x = 2*margin-x; angle = CV_PI-angle; reflected = true; }
+		else if( x>maxX ){ x = 2*maxX-x; angle = CV_PI-angle; reflected = true; }
+		if( y<margin ){ y = 2*margin-y; angle = -angle; reflected = true; }
+		else if( y>maxY ){ y = 2*maxY-y; angle = -angle; reflected = true; }
+		x = min( max( x, margin ), maxX );
+		y = min( max( y, margin ), maxY );
+
+		angle = fmod( angle, 2*CV_PI );
+		if( angle<0 ) angle += 2*CV_PI;
+
+		// the motion the module predicted failed: let it react as it does in the tracker
+		if( reflected ) pHosts[i]->resetPrediction();
+
+		entry.frame = pFrameCount;
+		entry.time = time;
+		entry.x = (float)x;
+		entry.y = (float)y;
+		entry.angle = (float)angle;
+	}
+}
+
+
+static unsigned int findRoot( vector<unsigned int>& _parent, unsigned int _i )
+{
+	while( _parent[_i]!=_i )
+	{
+		_parent[_i] = _parent[ _parent[_i] ];
+		_i = _parent[_i];
+	}
+	return _i;
+}
+
+
+void SyntheticSwarm::findContacts()
+{
+	unsigned int n = pTruth.size();
+	pFootprints.resize( n );
+	for( unsigned int i=0; i<n; i++ )
+	{
+		footprint( pTruth[i].x, pTruth[i].y, pTruth[i].angle, pSettings.objectLength, pSettings.objectWidth, pFootprints[i] );
+		pTruth[i].touching = false;
+	}
+
+	// objects whose centers are further apart than a length (plus tolerance) cannot touch: only neighbouring grid cells are checked
+	double cellSize = pSettings.objectLength+2;
+	int cols = (int)( pSettings.frameSize.width/cellSize )+1;
+	int rows = (int)( pSettings.frameSize.height/cellSize )+1;
+	vector< vector<unsigned int> > grid( cols*rows );
+	vector<int> cellX( n ), cellY( n );
+	for( unsigned int i=0; i<n; i++ )
+	{
+		cellX[i] = min( max( (int)( pTruth[i].x/cellSize ), 0 ), cols-1 );
+		cellY[i] = min( max( (int)( pTruth[i].y/cellSize ), 0 ), rows-1 );
+		grid[ cellY[i]*cols+cellX[i] ].push_back(i);
+	}
+
+	vector<unsigned int> parent( n );
+	for( unsigned int i=0; i<n; i++ ) parent[i] = i;
+
+	for( unsigned int i=0; i<n; i++ )
+	{
+		for( int cy=max( cellY[i]-1, 0 ); cy<=min( cellY[i]+1, rows-1 ); cy++ )
+		{
+			for( int cx=max( cellX[i]-1, 0 ); cx<=min( cellX[i]+1, cols-1 ); cx++ )
+			{
+				vector<unsigned int>& cell = grid[ cy*cols+cx ];
+				for( unsigned int k=0; k<cell.size(); k++ )
+				{
+					unsigned int j = cell[k];
+					if( j<=i || !touch( pFootprints[i], pFootprints[j] ) ) continue;
+
+					pTruth[i].touching = true;
+					pTruth[j].touching = true;
+					parent[ findRoot( parent, i ) ] = findRoot( parent, j );
+				}
+			}
+		}
+	}
+
+	pTouching = 0;
+	pBlobs = 0;
+	for( unsigned int i=0; i<n; i++ )
+	{
+		if( pTruth[i].touching ) pTouching++;
+		if( findRoot( parent, i )==i ) pBlobs++;
+	}
+	pTouchingTotal += pTouching;
+	pAppearancesTotal += n;
+}
+
+
+void SyntheticSwarm::render( Mat& _frame )
+{
+	_frame.create( pSettings.frameSize, CV_8UC3 );
+	_frame.setTo( Scalar::all( pSettings.background ) );
+
+	const int shift = 4; // sub-pixel accuracy of the corners
+	Point corners[4];
+	for( unsigned int i=0; i<pFootprints.size(); i++ )
+	{
+		for( int k=0; k<4; k++ ) corners[k] = Point( cvRound( pFootprints[i][k].x*(1<<shift) ), cvRound( pFootprints[i][k].y*(1<<shift) ) );
+		fillConvexPoly( _frame, corners, 4, Scalar::all( pSettings.foreground ), 8, shift );
+	}
+
+	if( pSettings.sensorNoise>0 )
+	{
+		pNoise.create( _frame.size(), CV_16SC3 );
+		pRng.fill( pNoise, RNG::NORMAL, 0, pSettings.sensorNoise );
+		add( _frame, pNoise, _frame, Mat(), CV_8U );
+	}
+}
+
+
+double SyntheticSwarm::framePeriod() const
+{
+	return 1000/pSettings.frameRate;
+}
+
+
+bool SyntheticSwarm::touch( const vector<Point2f>& _a, const vector<Point2f>& _b )
+{
+	const float tolerance = 1; // [px] blobs closer than this merge after thresholding
+
+	const vector<Point2f>* rects[2] = { &_a, &_b };
+	for( int r=0; r<2; r++ )
+	{
+		for( int k=0; k<2; k++ )
+		{
+			Point2f axis = (*rects[r])[k+1]-(*rects[r])[k];
+			float length = sqrt( axis.dot(axis) );
+			if( length==0 ) continue;
+			axis *= 1/length;
+
+			float minA = _a[0].dot(axis), maxA = minA, minB = _b[0].dot(axis), maxB = minB;
+			for( int i=1; i<4; i++ )
+			{
+				float projA = _a[i].dot(axis), projB = _b[i].dot(axis);
+				minA = min( minA, projA ); maxA = max( maxA, projA );
+				minB = min( minB, projB ); maxB = max( maxB, projB );
+			}
+			if( maxA+tolerance<minB || maxB+tolerance<minA ) return false; // separating axis found
+		}
+	}
+	return true;
+}
+
+
+void SyntheticSwarm::footprint( double _x, double _y, double _angle, double _length, double _width, vector<Point2f>& _corners )
+{
+	Point2f axis( (float)( cos(_angle)*_length/2 ), (float)( sin(_angle)*_length/2 ) );
+	Point2f normal( (float)( -sin(_angle)*_width/2 ), (float)( cos(_angle)*_width/2 ) );
+	Point2f center( (float)_x, (float)_y );
+
+	_corners.resize(4);
+	_corners[0] = center-axis-normal;
+	_corners[1] = center+axis-normal;
+	_corners[2] = center+axis+normal;
+	_corners[3] = center-axis+normal;
+}
@@ -0,0 +1,136 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "opencv2/core/core.hpp"
+#include "DynamicsHost.h"
+
+using namespace std;
+using namespace cv;
+
+/** generates frames of a synthetic swarm together with its ground truth
+*
+* Every object is driven by one of the registered dynamics modules: its true state in the next frame is the prediction of its module plus
+* process noise, after which the true state is fed back to the module the same way the tracker does. Objects are rendered as dark rotated
+* rectangles on a bright, noisy background, they are reflected at the image borders and part of them is spawned in touching clusters so
+* that merged blobs occur from the first frame on. Overlaps and contacts are reported per object in the ground truth.
+*/
+class SyntheticSwarm
+{
+public:
+	struct Settings
+	{
+		Settings();
+
+		unsigned int objectCount;
+		vector<string> dynamicsTypes; // assigned to the objects in turn
+		Size frameSize; // if empty, the size is derived from objectCount and areaPerObject (4:3)
+		double areaPerObject; // [px^2] image area per object, determines the density
+		double objectLength; // [px]
+		double objectWidth; // [px]
+		double speed; // [px/frame] mean initial speed
+		double maxSpeed; // [px/frame] upper limit of the true speed
+		double positionNoise; // [px] standard deviation of the process noise
+		double angleNoise; // [rad] standard deviation of the process noise
+		double clusterFraction; // fraction of the objects that are spawned in touching clusters
+		unsigned int clusterSize; // number of objects per cluster
+		double frameRate; // [frames/s]
+		int background; // [grey level]
+		int foreground; // [grey level]
+		double sensorNoise; // [grey level] standard deviation of the image noise
+		unsigned int seed;
+	};
+
+	/** true state of an object in a frame */
+	struct TruthEntry
+	{
+		unsigned int frame;
+		double time; // [ms]
+		unsigned int id; // 0..objectCount-1
+		float x;
+		float y;
+		float angle; // [rad]
+		bool touching; // true if the object touches or overlaps another one (and thus is part of a merged blob)
+	};
+
+	SyntheticSwarm( ObjectHandler* _environmentControl, const Settings& _settings );
+
+	/** returns false if one of the dynamics types is unknown */
+	bool valid();
+
+	/** moves the swarm one step and renders the frame */
+	SyntheticSwarm& operator>>( Mat& _frame );
+	void nextFrame( Mat& _frame );
+
+	/** time stamp of the last rendered frame [ms] */
+	double time() const;
+	/** number of frames rendered so far */
+	unsigned int frameCount() const;
+	Size frameSize() const;
+	unsigned int objectCount() const;
+	double frameRate() const;
+
+	/** ground truth of the last rendered frame */
+	const vector<TruthEntry>& groundTruth() const;
+	/** number of objects touching another object in the last frame */
+	unsigned int touchingObjects() const;
+	/** number of blobs (groups of touching objects and single objects) in the last frame */
+	unsigned int blobCount() const;
+	/** fraction of all object appearances so far in which the object was part of a merged blob */
+	double mergeFrequency() const;
+
+	/** writes the csv header and the ground truth of the last frame, _prefix is written in front of every line (e.g. a sequence name and a separator) */
+	static void writeGroundTruthHeader( ostream& _out, const string& _prefix="" );
+	void writeGroundTruth( ostream& _out, const string& _prefix="" ) const;
+
+private:
+	Settings pSettings;
+	RNG pRng;
+	vector< Ptr<DynamicsHost> > pHosts;
+	vector<TruthEntry> pTruth;
+	vector< vector<Point2f> > pFootprints; // corners of the objects in the current frame
+	Mat pObjectImage; // non-empty image passed to the dynamics modules for objects that are seen alone
+	Mat pNoise;
+	bool pValid;
+
+	unsigned int pFrameCount;
+	unsigned int pTouching;
+	unsigned int pBlobs;
+	double pTouchingTotal; // object appearances that were part of a merged blob
+	double pAppearancesTotal;
+
+	/** places the objects and primes their dynamics modules with two states */
+	void spawn();
+	void spawnObject( unsigned int _id, Point2f _pos, double _heading, double _speed );
+	/** feeds the given true state to the dynamics module of the object */
+	void feed( unsigned int _id, double _x, double _y, double _angle, double _time );
+	void move();
+	void findContacts();
+	void render( Mat& _frame );
+
+	double framePeriod() const;
+	/** returns true if the two rectangles are closer than a pixel (separating axis test) */
+	static bool touch( const vector<Point2f>& _a, const vector<Point2f>& _b );
+	static void footprint( double _x, double _y, double _angle, double _length, double _width, vector<Point2f>& _corners );
+};
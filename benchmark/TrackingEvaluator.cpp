@@ -0,0 +1,212 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "TrackingEvaluator.h"
+#include <cmath>
+#include <algorithm>
+#include <set>
+
+
+TrackingEvaluator::Metrics::Metrics():frames(0),truthCount(0),hypothesisCount(0),matches(0),misses(0),falsePositives(0),idSwitches(0),fragmentations(0),mota(0),motp(0),idTruePositives(0),idPrecision(0),idRecall(0),idf1(0)
+{
+
+}
+
+
+TrackingEvaluator::TrackingEvaluator( double _matchingDistance ):pMatchingDistance(_matchingDistance),pDistanceSum(0)
+{
+
+}
+
+
+/** candidate match between a ground truth object and a hypothesis, indices into the frame vectors */
+struct Candidate
+{
+	double distance;
+	unsigned int truth;
+	unsigned int hypothesis;
+
+	bool operator<( const Candidate& _other ) const { return distance<_other.distance; };
+};
+
+
+void TrackingEvaluator::addFrame( const vector<TrackPoint>& _truth, const vector<TrackPoint>& _hypotheses )
+{
+	pCounts.frames++;
+	pCounts.truthCount += _truth.size();
+	pCounts.hypothesisCount += _hypotheses.size();
+
+	vector<int> truthMatch( _truth.size(), -1 ); // index of the matched hypothesis
+	vector<bool> hypothesisMatched( _hypotheses.size(), false );
+
+	map<unsigned int,unsigned int> hypothesisIndex;
+	for( unsigned int j=0; j<_hypotheses.size(); j++ ) hypothesisIndex[ _hypotheses[j].id ] = j;
+
+	double maxSqDistance = pMatchingDistance*pMatchingDistance;
+
+	// keep the correspondences of the last match if they are still valid
+	for( unsigned int i=0; i<_truth.size(); i++ )
+	{
+		map<unsigned int,unsigned int>::iterator last = pLastMatch.find( _truth[i].id );
+		if( last==pLastMatch.end() ) continue;
+		map<unsigned int,unsigned int>::iterator hyp = hypothesisIndex.find( last->second );
+		if( hyp==hypothesisIndex.end() || hypothesisMatched[hyp->second] ) continue;
+
+		const TrackPoint& h = _hypotheses[hyp->second];
+		double dX = h.x-_truth[i].x, dY = h.y-_truth[i].y;
+		if( dX*dX+dY*dY>maxSqDistance ) continue;
+
+		truthMatch[i] = hyp->second;
+		hypothesisMatched[hyp->second] = true;
+	}
+
+	// candidates for the remaining objects, found over a grid with the matching distance as cell size
+	map< pair<int,int>, vector<unsigned int> > grid;
+	for( unsigned int j=0; j<_hypotheses.size(); j++ )
+	{
+		if( hypothesisMatched[j] ) continue;
+		grid[ make_pair( (int)floor( _hypotheses[j].x/pMatchingDistance ), (int)floor( _hypotheses[j].y/pMatchingDistance ) ) ].push_back(j);
+	}
+
+	vector<Candidate> candidates;
+	for( unsigned int i=0; i<_truth.size(); i++ )
+	{
+		if( truthMatch[i]>=0 ) continue;
+		int cellX = (int)floor( _truth[i].x/pMatchingDistance );
+		int cellY = (int)floor( _truth[i].y/pMatchingDistance );
+		for( int cx=cellX-1; cx<=cellX+1; cx++ )
+		{
+			for( int cy=cellY-1; cy<=cellY+1; cy++ )
+			{
+				map< pair<int,int>, vector<unsigned int> >::iterator cell = grid.find( make_pair(cx,cy) );
+				if( cell==grid.end() ) continue;
+				for( unsigned int k=0; k<cell->second.size(); k++ )
+				{
+					const TrackPoint& h = _hypotheses[ cell->second[k] ];
+					double dX = h.x-_truth[i].x, dY = h.y-_truth[i].y;
+					double sqDistance = dX*dX+dY*dY;
+					if( sqDistance>maxSqDistance ) continue;
+
+					Candidate candidate;
+					candidate.distance = sqDistance;
+					candidate.truth = i;
+					candidate.hypothesis = cell->second[k];
+					candidates.push_back( candidate );
+				}
+			}
+		}
+	}
+
+	sort( candidates.begin(), candidates.end() );
+	for( unsigned int k=0; k<candidates.size(); k++ )
+	{
+		if( truthMatch[ candidates[k].truth ]>=0 || hypothesisMatched[ candidates[k].hypothesis ] ) continue;
+		truthMatch[ candidates[k].truth ] = candidates[k].hypothesis;
+		hypothesisMatched[ candidates[k].hypothesis ] = true;
+	}
+
+	// counting
+	unsigned int frameMatches = 0;
+	for( unsigned int i=0; i<_truth.size(); i++ )
+	{
+		unsigned int truthId = _truth[i].id;
+		bool matched = ( truthMatch[i]>=0 );
+
+		map<unsigned int,bool>::iterator lastAppearance = pMatchedInLastAppearance.find( truthId );
+		if( matched )
+		{
+			const TrackPoint& h = _hypotheses[ truthMatch[i] ];
+			frameMatches++;
+			pDistanceSum += sqrt( (h.x-_truth[i].x)*(h.x-_truth[i].x) + (h.y-_truth[i].y)*(h.y-_truth[i].y) );
+
+			map<unsigned int,unsigned int>::iterator last = pLastMatch.find( truthId );
+			if( last!=pLastMatch.end() && last->second!=h.id ) pCounts.idSwitches++;
+			if( last!=pLastMatch.end() && lastAppearance!=pMatchedInLastAppearance.end() && !lastAppearance->second ) pCounts.fragmentations++;
+
+			pLastMatch[truthId] = h.id;
+			pCoOccurrences[ make_pair( truthId, h.id ) ]++;
+		}
+		pMatchedInLastAppearance[truthId] = matched;
+	}
+
+	pCounts.matches += frameMatches;
+	pCounts.misses += _truth.size()-frameMatches;
+	pCounts.falsePositives += _hypotheses.size()-frameMatches;
+}
+
+
+/** co-occurrence of a ground truth track and a hypothesis track */
+struct TrackPair
+{
+	unsigned int count;
+	unsigned int truth;
+	unsigned int hypothesis;
+
+	bool operator<( const TrackPair& _other ) const { return count>_other.count; }; // descending
+};
+
+
+TrackingEvaluator::Metrics TrackingEvaluator::metrics() const
+{
+	Metrics result = pCounts;
+
+	if( result.truthCount>0 ) result.mota = 1 - (double)( result.misses+result.falsePositives+result.idSwitches )/result.truthCount;
+	if( result.matches>0 ) result.motp = pDistanceSum/result.matches;
+
+	// identity assignment
+	vector<TrackPair> pairs;
+	pairs.reserve( pCoOccurrences.size() );
+	for( map< pair<unsigned int,unsigned int>, unsigned int >::const_iterator it=pCoOccurrences.begin(); it!=pCoOccurrences.end(); it++ )
+	{
+		TrackPair trackPair;
+		trackPair.count = it->second;
+		trackPair.truth = it->first.first;
+		trackPair.hypothesis = it->first.second;
+		pairs.push_back( trackPair );
+	}
+	sort( pairs.begin(), pairs.end() );
+
+	set<unsigned int> assignedTruth, assignedHypotheses;
+	result.idTruePositives = 0;
+	for( unsigned int k=0; k<pairs.size(); k++ )
+	{
+		if( assignedTruth.count( pairs[k].truth ) || assignedHypotheses.count( pairs[k].hypothesis ) ) continue;
+		assignedTruth.insert( pairs[k].truth );
+		assignedHypotheses.insert( pairs[k].hypothesis );
+		result.idTruePositives += pairs[k].count;
+	}
+
+	if( result.hypothesisCount>0 ) result.idPrecision = (double)result.idTruePositives/result.hypothesisCount;
+	if( result.truthCount>0 ) result.idRecall = (double)result.idTruePositives/result.truthCount;
+	if( result.truthCount+result.hypothesisCount>0 ) result.idf1 = 2.0*result.idTruePositives/( result.truthCount+result.hypothesisCount );
+
+	return result;
+}
+
+
+void TrackingEvaluator::reset()
+{
+	pCounts = Metrics();
+	pDistanceSum = 0;
+	pLastMatch.clear();
+	pMatchedInLastAppearance.clear();
+	pCoOccurrences.clear();
+}
@@ -0,0 +1,89 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+/** compares tracker output with ground truth frame by frame and calculates CLEAR MOT and identity (IDF1) metrics
+*
+* In every frame, ground truth objects and hypotheses closer than the matching distance are matched: correspondences of the previous frame
+* are kept if still valid, the remaining pairs are assigned greedily by increasing distance. Identities are assigned over the whole sequence
+* greedily as well, by decreasing number of frames a ground truth track and a hypothesis track were matched, which yields a lower bound of
+* the IDF1 of the optimal assignment.
+*/
+class TrackingEvaluator
+{
+public:
+	/** position of an object with its id, either ground truth or tracker output */
+	struct TrackPoint
+	{
+		TrackPoint():id(0),x(0),y(0){};
+		TrackPoint( unsigned int _id, float _x, float _y ):id(_id),x(_x),y(_y){};
+
+		unsigned int id;
+		float x;
+		float y;
+	};
+
+	struct Metrics
+	{
+		Metrics();
+
+		unsigned int frames;
+		unsigned long truthCount; // ground truth objects over all frames
+		unsigned long hypothesisCount; // tracker outputs over all frames
+		unsigned long matches;
+		unsigned long misses; // false negatives
+		unsigned long falsePositives;
+		unsigned long idSwitches; // a ground truth object is matched with another hypothesis than at its last match
+		unsigned long fragmentations; // a ground truth track is matched again after it was not matched
+		double mota; // 1 - (misses+falsePositives+idSwitches)/truthCount
+		double motp; // mean distance of the matches [px]
+		unsigned long idTruePositives;
+		double idPrecision;
+		double idRecall;
+		double idf1;
+	};
+
+	/** @param	_matchingDistance	maximal distance between a ground truth object and a hypothesis that are matched [px] */
+	TrackingEvaluator( double _matchingDistance=15 );
+
+	/** adds a frame: the ids of the ground truth objects and of the hypotheses have to be unique within the frame */
+	void addFrame( const vector<TrackPoint>& _truth, const vector<TrackPoint>& _hypotheses );
+
+	Metrics metrics() const;
+
+	void reset();
+
+private:
+	double pMatchingDistance;
+
+	Metrics pCounts;
+	double pDistanceSum;
+
+	map<unsigned int,unsigned int> pLastMatch; // ground truth id -> hypothesis id of its last match
+	map<unsigned int,bool> pMatchedInLastAppearance; // ground truth id -> whether it was matched the last time it appeared
+	map< pair<unsigned int,unsigned int>, unsigned int > pCoOccurrences; // (ground truth id, hypothesis id) -> number of frames matched
+};
@@ -0,0 +1,458 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "boost/filesystem.hpp"
+#include "boost/bind.hpp"
+
+#include "SceneHandler.h"
+#include "SyntheticSwarm.h"
+#include "BenchUtilities.h"
+
+
+using namespace std;
+using namespace cv;
+
+
+/** benchmark settings as given on the command line */
+struct BenchSettings
+{
+	BenchSettings():maxFrames(0),warmupFrames(10),profile(false),memory(false),pipelined(false),detectionThreads(0){};
+
+	vector<string> videos;
+	vector<unsigned int> syntheticCounts; // object counts of the synthetic swarms to run
+	vector<string> dynamics; // dynamics modules driving the synthetic swarms
+	vector<string> types; // if empty, the helix types are used for videos and no types for synthetic swarms
+	string project; // project file to load instead of the default setup
+	string workingDirectory; // directory containing the "generic classes" folder
+	string csvFile; // if set, results are appended as csv lines
+	string groundTruthFile; // if set, the ground truth of the synthetic swarms is written to it
+	string traceDirectory; // if set, a timeline of each run is written to it
+	unsigned int maxFrames; // 0: no limit
+	unsigned int warmupFrames; // frames that are processed but not included in the statistics
+	bool profile; // print the per-stage timings of the SceneHandler profiler
+	bool memory; // print the memory report of the SceneHandler at the end of each run
+	bool pipelined; // run the SceneHandler in pipelined mode
+	unsigned int detectionThreads; // threads the detection runs on in pipelined mode, 0: as set in the options
+};
+
+/** results of a single benchmark run */
+struct BenchResult
+{
+	BenchResult():frames(0),totalMs(0),warmupFrames(0),rssStart(0),rssPeak(0),objects(0),mergeFrequency(0),blobs(0){};
+
+	string video;
+	unsigned int frames;
+	double totalMs; // wall time spent in pushFrame for all measured frames (and in the final flush if pipelined)
+	vector<double> latencies; // per measured frame [ms]: time spent in pushFrame, or from pushFrame to the end of the tracking if pipelined
+	unsigned int warmupFrames; // frames whose latency isn't recorded
+	size_t rssStart; // resident set size before the SceneHandler was created [bytes]
+	size_t rssPeak; // largest resident set size sampled during the run [bytes]
+
+	/** samples the resident set size, the peak of the process can't be used since it includes the earlier runs */
+	void sampleRSS(){ rssPeak = max( rssPeak, currentRSS() ); };
+	/** frame listener of the SceneHandler for pipelined runs, called on its tracking thread */
+	void frameFinished( unsigned int _frame, double _latency ){ if( _frame>=warmupFrames ) latencies.push_back( _latency ); };
+
+	// synthetic swarms only
+	unsigned int objects;
+	Size frameSize;
+	double mergeFrequency; // fraction of object appearances in merged blobs
+	double blobs; // mean number of blobs per frame
+};
+
+
+static void printUsage()
+{
+	cout<<endl<<"usage: molar_bench [options] [video files...]"<<endl;
+	cout<<endl<<"Replays each video through SceneHandler::pushFrame without any display and reports the throughput, the per-frame latency and the peak memory usage of each run. If neither a video nor a synthetic swarm is given, the helix example video is used."<<endl;
+	cout<<endl<<"options:";
+	cout<<endl<<"  --frames <n>        process at most n frames per video (default: all, 300 for synthetic swarms)";
+	cout<<endl<<"  --warmup <n>        number of frames excluded from the statistics (default: 10)";
+	cout<<endl<<"  --types <a,b,...>   object types that are considered to be in the scene (default: ThickHelix_KF,ThinHelix_KF,Unknown Type for videos, none for synthetic swarms)";
+	cout<<endl<<"  --synthetic <n,...> run synthetic swarms with n objects each instead of (or in addition to) the given videos";
+	cout<<endl<<"  --dynamics <a,...>  dynamics modules driving the swarm objects, assigned in turn (default: NonHoloKalman2D)";
+	cout<<endl<<"  --ground-truth <file> write the ground truth tracks of the synthetic swarms to a csv file";
+	cout<<endl<<"  --project <file>    load the scene setup from a project file instead of using the default setup";
+	cout<<endl<<"  --workdir <dir>     directory containing the \"generic classes\" folder (default: examples/headless)";
+	cout<<endl<<"  --csv <file>        append the results to a csv file";
+	cout<<endl<<"  --profile           print the time spent in each processing stage";
+	cout<<endl<<"  --pipelined         run preprocessing, detection and tracking on separate threads (SceneHandler::setPipelined)";
+	cout<<endl<<"  --detection-threads <n> run the detection of the following frames on n threads in parallel, implies --pipelined";
+	cout<<endl<<"  --trace <dir>       write a timeline of each run to <dir>/<run name>.json (Chrome trace event format)";
+	cout<<endl<<"  --memory            print the memory used by the buffers, objects and classifiers at the end of each run";
+	cout<<endl<<"  --help              show this message"<<endl<<endl;
+}
+
+/** reads the settings from the command line, returns false if the program should exit */
+static bool parseArguments( int argc, char ** argv, BenchSettings& _settings )
+{
+	for( int i=1; i<argc; i++ )
+	{
+		string arg = argv[i];
+		bool hasValue = (i+1<argc);
+
+		if( arg=="--help" || arg=="-h" )
+		{
+			printUsage();
+			return false;
+		}
+		else if( arg=="--frames" && hasValue ) _settings.maxFrames = atoi( argv[++i] );
+		else if( arg=="--warmup" && hasValue ) _settings.warmupFrames = atoi( argv[++i] );
+		else if( arg=="--types" && hasValue ) _settings.types = splitList( argv[++i] );
+		else if( arg=="--project" && hasValue ) _settings.project = argv[++i];
+		else if( arg=="--workdir" && hasValue ) _settings.workingDirectory = argv[++i];
+		else if( arg=="--csv" && hasValue ) _settings.csvFile = argv[++i];
+		else if( arg=="--synthetic" && hasValue )
+		{
+			vector<string> counts = splitList( argv[++i] );
+			for( unsigned int j=0; j<counts.size(); j++ ) _settings.syntheticCounts.push_back( atoi( counts[j].c_str() ) );
+		}
+		else if( arg=="--dynamics" && hasValue ) _settings.dynamics = splitList( argv[++i] );
+		else if( arg=="--ground-truth" && hasValue ) _settings.groundTruthFile = argv[++i];
+		else if( arg=="--profile" ) _settings.profile = true;
+		else if( arg=="--memory" ) _settings.memory = true;
+		else if( arg=="--pipelined" ) _settings.pipelined = true;
+		else if( arg=="--detection-threads" && hasValue )
+		{
+			_settings.detectionThreads = atoi( argv[++i] );
+			_settings.pipelined = true;
+		}
+		else if( arg=="--trace" && hasValue ) _settings.traceDirectory = argv[++i];
+		else if( arg.size()>1 && arg[0]=='-' )
+		{
+			cerr<<endl<<"molar_bench:: Unknown or incomplete option "<<arg<<endl;
+			printUsage();
+			return false;
+		}
+		else _settings.videos.push_back( arg );
+	}
+
+	if( _settings.videos.empty() && _settings.syntheticCounts.empty() ) _settings.videos.push_back( string(MOLAR_ROOT_DIR)+"/examples/video_files/twoHelixTypes_original.avi" );
+	if( _settings.workingDirectory.empty() ) _settings.workingDirectory = string(MOLAR_ROOT_DIR)+"/examples/headless";
+	if( _settings.dynamics.empty() ) _settings.dynamics.push_back("NonHoloKalman2D");
+
+	// paths given relative to the calling directory must stay valid after changing into the working directory
+	for( unsigned int i=0; i<_settings.videos.size(); i++ ) _settings.videos[i] = boost::filesystem::absolute( _settings.videos[i] ).string();
+	if( !_settings.project.empty() ) _settings.project = boost::filesystem::absolute( _settings.project ).string();
+	if( !_settings.csvFile.empty() ) _settings.csvFile = boost::filesystem::absolute( _settings.csvFile ).string();
+	if( !_settings.groundTruthFile.empty() ) _settings.groundTruthFile = boost::filesystem::absolute( _settings.groundTruthFile ).string();
+	if( !_settings.traceDirectory.empty() ) _settings.traceDirectory = boost::filesystem::absolute( _settings.traceDirectory ).string();
+
+	return true;
+}
+
+/** waits for the frames still in the pipeline, the time spent waiting is added to the measurement */
+/** in pipelined mode pushFrame() only queues the frame: the latencies are then taken from pushFrame() to the end of the tracking of each frame */
+static void watchPipeline( const BenchSettings& _settings, SceneHandler& _scene, BenchResult& _result )
+{
+	if( !_scene.pipelined() ) return;
+	_result.warmupFrames = _settings.warmupFrames;
+	_scene.setFrameListener( boost::bind( &BenchResult::frameFinished, &_result, _1, _2 ) );
+}
+
+static void flushPipeline( SceneHandler& _scene, BenchResult& _result )
+{
+	if( _scene.pipelined() )
+	{
+		double start = wallTime();
+		_scene.flush();
+		_result.totalMs += wallTime()-start;
+		_scene.setFrameListener( boost::function<void( unsigned int, double )>() );
+	}
+	_result.sampleRSS();
+}
+
+/** prints the memory report of the SceneHandler and, if frames were compressed or recorded to the hard disk, the counters of the compressed tier and the disk writer */
+static void printMemory( SceneHandler& _scene )
+{
+	_scene.memoryReport().print( cout );
+	VideoBuffer::CompressionStatistics compression = _scene.compressionStatistics();
+	if( compression.queued!=0 || compression.dropped!=0 ) cout<<endl<<"Compressed tier: "<<compression.compressed<<" of "<<compression.queued<<" frames compressed, "<<compression.dropped<<" dropped"<<endl;
+	SpillWriter::Statistics spill = _scene.spillStatistics();
+	if( spill.queued==0 && spill.dropped==0 ) return;
+	cout<<endl<<"Disk spill: "<<spill.written<<" of "<<spill.queued<<" frames written, "<<spill.dropped<<" dropped, waited "<<spill.waits<<" times ("<<spill.waitTime<<"ms), max queue length "<<spill.maxQueueLength<<endl;
+}
+
+/** starts the tracer of the SceneHandler if a trace directory was given, the trace is named after the run */
+static void startTrace( const BenchSettings& _settings, SceneHandler& _scene, const string& _runName )
+{
+	if( _settings.traceDirectory.empty() ) return;
+
+	boost::filesystem::create_directories( _settings.traceDirectory );
+	string file = ( boost::filesystem::path( _settings.traceDirectory ) / ( boost::filesystem::path( _runName ).stem().string()+".json" ) ).string();
+	if( _scene.tracer().start( file ) ) _scene.tracer().setThreadName( "molar_bench" );
+}
+
+/** sets up a SceneHandler the same way the headless example does (or loads the given project) and replays the video through it */
+static bool runBenchmark( const BenchSettings& _settings, string _video, BenchResult& _result )
+{
+	VideoCapture video(_video);
+	if( !video.isOpened() )
+	{
+		cerr<<endl<<"molar_bench:: Could not open video "<<_video<<endl;
+		return false;
+	}
+
+	_result.rssStart = currentRSS();
+	_result.rssPeak = _result.rssStart;
+	SceneHandler scene(false);
+	scene.setFrameRate(video);
+
+	if( !_settings.project.empty() )
+	{
+		if( !scene.loadFromFile( _settings.project ) )
+		{
+			cerr<<endl<<"molar_bench:: Could not load project "<<_settings.project<<endl;
+			return false;
+		}
+	}
+	else
+	{
+		GenericMultiLevelMap<string> filterOptions;
+		filterOptions["contrast_factor"].as<double>()=2.7;
+		filterOptions["brightness_offset"].as<double>()=20;
+		scene.addInternPreProcessingAlgorithm("contrast brightness adjustment",filterOptions);
+
+		vector<string> types = _settings.types;
+		if( types.empty() )
+		{
+			types.push_back("ThickHelix_KF");
+			types.push_back("ThinHelix_KF");
+			types.push_back("Unknown Type");
+		}
+		scene.typesInScene( types );
+	}
+
+	_result.video = _video;
+	scene.profile().setActive( _settings.profile );
+	startTrace( _settings, scene, _video );
+	if( _settings.detectionThreads>0 ) scene.setDetectionThreads( _settings.detectionThreads );
+	scene.setPipelined( _settings.pipelined );
+	watchPipeline( _settings, scene, _result );
+
+	Mat frame;
+	unsigned int frameCount = 0;
+	while( _settings.maxFrames==0 || frameCount<_settings.maxFrames+_settings.warmupFrames )
+	{
+		// decoding is not part of the measurement
+		double frameTime = video.get(CV_CAP_PROP_POS_MSEC);
+		if( !video.read(frame) ) break;
+
+		double start = wallTime();
+		scene.pushFrame( frame, frameTime );
+		double duration = wallTime()-start;
+		_result.sampleRSS();
+
+		if( frameCount>=_settings.warmupFrames )
+		{
+			if( !scene.pipelined() ) _result.latencies.push_back( duration );
+			_result.totalMs += duration;
+			_result.frames++;
+		}
+		frameCount++;
+		if( frameCount==_settings.warmupFrames ) scene.profile().reset();
+	}
+	flushPipeline( scene, _result );
+
+	if( _settings.profile ) scene.profile().report( cout );
+	if( _settings.memory ) printMemory( scene );
+	return true;
+}
+
+/** runs a synthetic swarm with the given number of objects through a SceneHandler, generating the frames is not part of the measurement */
+static bool runSyntheticBenchmark( const BenchSettings& _settings, unsigned int _objectCount, ofstream& _groundTruth, BenchResult& _result )
+{
+	_result.rssStart = currentRSS();
+	_result.rssPeak = _result.rssStart;
+	SceneHandler scene(false);
+
+	if( !_settings.project.empty() && !scene.loadFromFile( _settings.project ) )
+	{
+		cerr<<endl<<"molar_bench:: Could not load project "<<_settings.project<<endl;
+		return false;
+	}
+	else if( _settings.project.empty() )
+	{
+		vector<string> types = _settings.types;
+		scene.typesInScene( types );
+	}
+
+	SyntheticSwarm::Settings swarmSettings;
+	swarmSettings.objectCount = _objectCount;
+	swarmSettings.dynamicsTypes = _settings.dynamics;
+
+	SyntheticSwarm swarm( &scene.objects(), swarmSettings );
+	if( !swarm.valid() )
+	{
+		cerr<<endl<<"molar_bench:: Could not create the synthetic swarm, check the dynamics types"<<endl;
+		return false;
+	}
+	double frameRate = swarm.frameRate();
+	scene.setFrameRate( frameRate );
+
+	stringstream name;
+	name<<"synthetic_"<<_objectCount;
+	for( unsigned int i=0; i<_settings.dynamics.size(); i++ ) name<<"_"<<_settings.dynamics[i];
+	_result.video = name.str();
+	_result.objects = _objectCount;
+	_result.frameSize = swarm.frameSize();
+	scene.profile().setActive( _settings.profile );
+	startTrace( _settings, scene, _result.video );
+	if( _settings.detectionThreads>0 ) scene.setDetectionThreads( _settings.detectionThreads );
+	scene.setPipelined( _settings.pipelined );
+	watchPipeline( _settings, scene, _result );
+
+	unsigned int maxFrames = ( _settings.maxFrames==0 )? 300 : _settings.maxFrames;
+	double blobSum = 0;
+
+	Mat frame;
+	for( unsigned int frameCount=0; frameCount<maxFrames+_settings.warmupFrames; frameCount++ )
+	{
+		swarm>>frame;
+		if( _groundTruth.is_open() ) swarm.writeGroundTruth( _groundTruth, _result.video+"," );
+
+		double start = wallTime();
+		scene.pushFrame( frame, swarm.time() );
+		double duration = wallTime()-start;
+		_result.sampleRSS();
+
+		if( frameCount>=_settings.warmupFrames )
+		{
+			if( !scene.pipelined() ) _result.latencies.push_back( duration );
+			_result.totalMs += duration;
+			_result.frames++;
+			blobSum += swarm.blobCount();
+		}
+		if( frameCount+1==_settings.warmupFrames ) scene.profile().reset();
+	}
+	flushPipeline( scene, _result );
+
+	_result.mergeFrequency = swarm.mergeFrequency();
+	_result.blobs = ( _result.frames>0 )? blobSum/_result.frames : 0;
+
+	if( _settings.profile ) scene.profile().report( cout );
+	if( _settings.memory ) printMemory( scene );
+	return true;
+}
+
+static void report( const BenchSettings& _settings, BenchResult& _result )
+{
+	vector<double> sorted = _result.latencies;
+	sort( sorted.begin(), sorted.end() );
+
+	double fps = ( _result.totalMs>0 )? 1000*_result.frames/_result.totalMs : 0;
+	double frameCost = ( _result.frames>0 )? _result.totalMs/_result.frames : 0; // equals the mean latency unless pipelined
+	double latencySum = 0;
+	for( size_t i=0; i<sorted.size(); i++ ) latencySum += sorted[i];
+	double mean = ( sorted.size()>0 )? latencySum/sorted.size() : 0;
+	double rssMB = _result.rssPeak/(1024.0*1024.0);
+	double rssGrowthMB = ( (double)_result.rssPeak-(double)_result.rssStart )/(1024.0*1024.0);
+
+	cout<<endl<<_result.video<<endl;
+	cout<<fixed<<setprecision(2);
+	cout<<"  frames:         "<<_result.frames<<" (after "<<_settings.warmupFrames<<" warmup frames)"<<endl;
+	cout<<"  throughput:     "<<fps<<" frames/s"<<endl;
+	cout<<"  latency [ms]:   mean "<<mean<<"  p50 "<<percentile(sorted,50)<<"  p90 "<<percentile(sorted,90)<<"  p95 "<<percentile(sorted,95)<<"  p99 "<<percentile(sorted,99)<<"  max "<<( sorted.empty()?0:sorted.back() )<<endl;
+	if( _result.objects>0 )
+	{
+		cout<<"  objects:        "<<_result.objects<<" in "<<_result.frameSize.width<<"x"<<_result.frameSize.height<<" px, "<<_result.blobs<<" blobs per frame, "<<100*_result.mergeFrequency<<"% of the objects in merged blobs"<<endl;
+		cout<<"  per object:     "<<1000*frameCost/_result.objects<<" us"<<endl;
+	}
+	cout<<"  peak RSS:       "<<rssMB<<" MB (+"<<rssGrowthMB<<" MB over the start of the run)"<<endl;
+
+	if( !_settings.csvFile.empty() )
+	{
+		bool newFile = !boost::filesystem::exists( _settings.csvFile );
+		ofstream csv( _settings.csvFile.c_str(), ios::app );
+		if( !csv.is_open() )
+		{
+			cerr<<endl<<"molar_bench:: Could not open "<<_settings.csvFile<<" for writing"<<endl;
+			return;
+		}
+		if( newFile ) csv<<"video,frames,fps,mean_ms,p50_ms,p90_ms,p95_ms,p99_ms,max_ms,peak_rss_mb,rss_growth_mb,objects,merge_frequency"<<endl;
+		csv<<fixed<<setprecision(3);
+		csv<<_result.video<<","<<_result.frames<<","<<fps<<","<<mean<<","<<percentile(sorted,50)<<","<<percentile(sorted,90)<<","<<percentile(sorted,95)<<","<<percentile(sorted,99)<<","<<( sorted.empty()?0:sorted.back() )<<","<<rssMB<<","<<rssGrowthMB<<","<<_result.objects<<","<<_result.mergeFrequency<<endl;
+	}
+}
+
+
+int main( int argc, char ** argv )
+{
+	BenchSettings settings;
+	if( !parseArguments( argc, argv, settings ) ) return 0;
+
+	// the generic classes folder is searched in the current directory
+	boost::system::error_code error;
+	boost::filesystem::current_path( settings.workingDirectory, error );
+	if( error )
+	{
+		cerr<<endl<<"molar_bench:: Could not change into working directory "<<settings.workingDirectory<<endl;
+		return 1;
+	}
+
+	int returnValue = 0;
+	for( unsigned int i=0; i<settings.videos.size(); i++ )
+	{
+		BenchResult result;
+		if( !runBenchmark( settings, settings.videos[i], result ) )
+		{
+			returnValue = 1;
+			continue;
+		}
+		report( settings, result );
+	}
+
+	ofstream groundTruth;
+	if( !settings.groundTruthFile.empty() && !settings.syntheticCounts.empty() )
+	{
+		groundTruth.open( settings.groundTruthFile.c_str(), ios::trunc );
+		if( !groundTruth.is_open() ) cerr<<endl<<"molar_bench:: Could not open "<<settings.groundTruthFile<<" for writing"<<endl;
+		else SyntheticSwarm::writeGroundTruthHeader( groundTruth, "sequence," );
+	}
+
+	for( unsigned int i=0; i<settings.syntheticCounts.size(); i++ )
+	{
+		BenchResult result;
+		if( !runSyntheticBenchmark( settings, settings.syntheticCounts[i], groundTruth, result ) )
+		{
+			returnValue = 1;
+			continue;
+		}
+		report( settings, result );
+	}
+	cout<<endl;
+
+	return returnValue;
+}
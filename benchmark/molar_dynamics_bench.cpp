@@ -0,0 +1,346 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <new>
+
+#include <opencv2/core/core.hpp>
+
+#include "boost/chrono.hpp"
+#include "boost/filesystem.hpp"
+
+#include "SceneHandler.h"
+#include "DynamicsHost.h"
+#include "BenchUtilities.h"
+
+
+using namespace std;
+using namespace cv;
+
+
+// ALLOCATION COUNTING /////////////////////////////////////////////////////////////////////
+// The buffers of cv::Mat are allocated with cv::fastMalloc, which uses malloc directly: where possible malloc itself is replaced,
+// otherwise only the allocations through operator new are counted.
+
+static unsigned long allocationCount = 0;
+
+#if defined(__GLIBC__)
+
+extern "C" void* __libc_malloc( size_t _size );
+extern "C" void* __libc_calloc( size_t _nr, size_t _size );
+extern "C" void* __libc_realloc( void* _ptr, size_t _size );
+
+extern "C" void* malloc( size_t _size )
+{
+	allocationCount++;
+	return __libc_malloc( _size );
+}
+
+extern "C" void* calloc( size_t _nr, size_t _size )
+{
+	allocationCount++;
+	return __libc_calloc( _nr, _size );
+}
+
+extern "C" void* realloc( void* _ptr, size_t _size )
+{
+	allocationCount++;
+	return __libc_realloc( _ptr, _size );
+}
+
+static const char* allocationSource = "malloc";
+
+#else
+
+void* operator new( size_t _size )
+{
+	allocationCount++;
+	void* memory = malloc( _size>0 ? _size : 1 );
+	if( memory==NULL ) throw bad_alloc();
+	return memory;
+}
+
+void* operator new[]( size_t _size )
+{
+	allocationCount++;
+	void* memory = malloc( _size>0 ? _size : 1 );
+	if( memory==NULL ) throw bad_alloc();
+	return memory;
+}
+
+void operator delete( void* _memory ) throw()
+{
+	free( _memory );
+}
+
+void operator delete[]( void* _memory ) throw()
+{
+	free( _memory );
+}
+
+static const char* allocationSource = "operator new";
+
+#endif
+
+
+/** the measured interface functions of the dynamics modules, in the order the tracker calls them */
+enum Operation
+{
+	PREDICT_STATE = 0,
+	PREDICT_ROI,
+	NEW_STATE,
+	ADD_STATE,
+	NR_OF_OPERATIONS
+};
+
+static const char* operationNames[NR_OF_OPERATIONS] = { "predictState", "predictROI", "newState", "addState" };
+
+
+struct DynamicsBenchSettings
+{
+	DynamicsBenchSettings():iterations(100000),warmupIterations(100){};
+
+	vector<string> modules; // if empty, all registered modules are measured
+	string workingDirectory;
+	string csvFile;
+	unsigned int iterations;
+	unsigned int warmupIterations; // states added before the measurement starts
+};
+
+/** accumulated cost of an operation */
+struct OperationCost
+{
+	OperationCost():calls(0),ns(0),allocations(0){};
+
+	unsigned long calls;
+	double ns;
+	unsigned long allocations;
+};
+
+
+static inline double nanoTime()
+{
+	return boost::chrono::duration<double,boost::nano>( boost::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+/** mean cost of reading the clock twice [ns], subtracted from the measurements */
+static double timerOverhead()
+{
+	const unsigned int samples = 100000;
+	double sum = 0;
+	for( unsigned int i=0; i<samples; i++ )
+	{
+		double start = nanoTime();
+		sum += nanoTime()-start;
+	}
+	return sum/samples;
+}
+
+static void printUsage()
+{
+	cout<<endl<<"usage: molar_dynamics_bench [options]"<<endl;
+	cout<<endl<<"Drives every registered dynamics module along a circular trajectory and reports the time [ns] and the number of heap allocations per call of predictState, predictROI, newState and addState."<<endl;
+	cout<<endl<<"options:";
+	cout<<endl<<"  --iterations <n>    number of measured states per module (default: 100000)";
+	cout<<endl<<"  --warmup <n>        number of states added before the measurement starts (default: 100)";
+	cout<<endl<<"  --modules <a,b,...> dynamics modules to measure (default: all registered modules)";
+	cout<<endl<<"  --workdir <dir>     directory containing the \"generic classes\" folder (default: examples/headless)";
+	cout<<endl<<"  --csv <file>        append the results to a csv file";
+	cout<<endl<<"  --help              show this message"<<endl<<endl;
+}
+
+static bool parseArguments( int argc, char ** argv, DynamicsBenchSettings& _settings )
+{
+	for( int i=1; i<argc; i++ )
+	{
+		string arg = argv[i];
+		bool hasValue = (i+1<argc);
+
+		if( arg=="--help" || arg=="-h" )
+		{
+			printUsage();
+			return false;
+		}
+		else if( arg=="--iterations" && hasValue ) _settings.iterations = atoi( argv[++i] );
+		else if( arg=="--warmup" && hasValue ) _settings.warmupIterations = atoi( argv[++i] );
+		else if( arg=="--modules" && hasValue ) _settings.modules = splitList( argv[++i] );
+		else if( arg=="--workdir" && hasValue ) _settings.workingDirectory = argv[++i];
+		else if( arg=="--csv" && hasValue ) _settings.csvFile = argv[++i];
+		else
+		{
+			cerr<<endl<<"molar_dynamics_bench:: Unknown or incomplete option "<<arg<<endl;
+			printUsage();
+			return false;
+		}
+	}
+
+	if( _settings.workingDirectory.empty() ) _settings.workingDirectory = string(MOLAR_ROOT_DIR)+"/examples/headless";
+	if( !_settings.csvFile.empty() ) _settings.csvFile = boost::filesystem::absolute( _settings.csvFile ).string();
+	return true;
+}
+
+
+/** feeds the module a state on a circle (radius 150px, 0.02rad per step) per iteration and measures each interface call as the tracker uses it */
+static bool measureModule( const DynamicsBenchSettings& _settings, ObjectHandler* _environment, string _module, vector<OperationCost>& _costs, double _timerOverhead )
+{
+	Ptr<DynamicsHost> host = new DynamicsHost( _environment, _module, Size(640,480), 0 ); // unlimited history, like the tracker with trace_states
+	if( !host->valid() ) return false;
+
+	_costs.assign( NR_OF_OPERATIONS, OperationCost() );
+
+	Mat objectImage( 1, 1, CV_8UC1, Scalar(255) );
+
+	for( unsigned int k=0; k<_settings.warmupIterations+_settings.iterations; k++ )
+	{
+		bool measure = ( k>=_settings.warmupIterations );
+
+		double phi = 0.02*k;
+		float x = (float)( 320+150*cos(phi) );
+		float y = (float)( 240+150*sin(phi) );
+		double heading = fmod( phi+CV_PI/2, 2*CV_PI );
+		double time = k*1000.0/30;
+
+		Mat state( 1, 3, CV_32FC1 );
+		state.at<float>(0) = x;
+		state.at<float>(1) = y;
+		state.at<float>(2) = (float)heading;
+		RotatedRect box( Point2f(x,y), Size2f(30,10), (float)( heading*180/CV_PI ) );
+		RectangleRegion region( box );
+		vector<Point> contour;
+		region.points( contour );
+
+		double start, duration;
+		unsigned long allocations;
+
+		if( k>0 ) // the modules expect at least one state
+		{
+			allocations = allocationCount;
+			start = nanoTime();
+			Mat prediction = host->predictState();
+			duration = nanoTime()-start;
+			if( measure )
+			{
+				_costs[PREDICT_STATE].ns += duration-_timerOverhead;
+				_costs[PREDICT_STATE].allocations += allocationCount-allocations;
+				_costs[PREDICT_STATE].calls++;
+			}
+
+			vector<Point> roi;
+			allocations = allocationCount;
+			start = nanoTime();
+			host->predictROI( roi );
+			duration = nanoTime()-start;
+			if( measure )
+			{
+				_costs[PREDICT_ROI].ns += duration-_timerOverhead;
+				_costs[PREDICT_ROI].allocations += allocationCount-allocations;
+				_costs[PREDICT_ROI].calls++;
+			}
+		}
+
+		allocations = allocationCount;
+		start = nanoTime();
+		Ptr<SceneObject::State> newState = host->newState( state, region, contour, objectImage, time );
+		duration = nanoTime()-start;
+		if( measure )
+		{
+			_costs[NEW_STATE].ns += duration-_timerOverhead;
+			_costs[NEW_STATE].allocations += allocationCount-allocations;
+			_costs[NEW_STATE].calls++;
+		}
+
+		allocations = allocationCount;
+		start = nanoTime();
+		host->addState( newState, region, contour );
+		duration = nanoTime()-start;
+		if( measure )
+		{
+			_costs[ADD_STATE].ns += duration-_timerOverhead;
+			_costs[ADD_STATE].allocations += allocationCount-allocations;
+			_costs[ADD_STATE].calls++;
+		}
+	}
+	return true;
+}
+
+
+int main( int argc, char ** argv )
+{
+	DynamicsBenchSettings settings;
+	if( !parseArguments( argc, argv, settings ) ) return 0;
+
+	boost::system::error_code error;
+	boost::filesystem::current_path( settings.workingDirectory, error );
+	if( error )
+	{
+		cerr<<endl<<"molar_dynamics_bench:: Could not change into working directory "<<settings.workingDirectory<<endl;
+		return 1;
+	}
+
+	vector<string> modules = settings.modules;
+	if( modules.empty() ) GenericObject::Dynamics::availableDynamics( modules );
+
+	SceneHandler scene(false); // provides the ObjectHandler the modules take their options from
+	double overhead = timerOverhead();
+
+	ofstream csv;
+	if( !settings.csvFile.empty() )
+	{
+		bool newFile = !boost::filesystem::exists( settings.csvFile );
+		csv.open( settings.csvFile.c_str(), ios::app );
+		if( !csv.is_open() ) cerr<<endl<<"molar_dynamics_bench:: Could not open "<<settings.csvFile<<" for writing"<<endl;
+		else if( newFile ) csv<<"module,operation,calls,ns_per_op,allocs_per_op"<<endl;
+	}
+
+	cout<<endl<<settings.iterations<<" iterations per module, timer overhead of "<<fixed<<setprecision(1)<<overhead<<"ns subtracted, allocations counted through "<<allocationSource<<endl;
+	cout<<endl<<left<<setw(24)<<"module"<<setw(16)<<"operation"<<right<<setw(12)<<"ns/op"<<setw(14)<<"allocs/op";
+
+	int returnValue = 0;
+	for( unsigned int i=0; i<modules.size(); i++ )
+	{
+		vector<OperationCost> costs;
+		if( !measureModule( settings, &scene.objects(), modules[i], costs, overhead ) )
+		{
+			cerr<<endl<<"molar_dynamics_bench:: Unknown dynamics module "<<modules[i]<<endl;
+			returnValue = 1;
+			continue;
+		}
+
+		for( int op=0; op<NR_OF_OPERATIONS; op++ )
+		{
+			double nsPerOp = ( costs[op].calls>0 )? costs[op].ns/costs[op].calls : 0;
+			double allocsPerOp = ( costs[op].calls>0 )? (double)costs[op].allocations/costs[op].calls : 0;
+
+			cout<<endl<<left<<setw(24)<<modules[i]<<setw(16)<<operationNames[op]<<right<<setprecision(1)<<setw(12)<<nsPerOp<<setprecision(2)<<setw(14)<<allocsPerOp;
+			if( csv.is_open() ) csv<<modules[i]<<","<<operationNames[op]<<","<<costs[op].calls<<","<<setprecision(1)<<nsPerOp<<","<<setprecision(3)<<allocsPerOp<<endl;
+		}
+	}
+	cout<<endl<<endl;
+
+	return returnValue;
+}
@@ -0,0 +1,471 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "boost/filesystem.hpp"
+
+#include "SceneHandler.h"
+#include "Dynamics.h"
+#include "SyntheticSwarm.h"
+#include "TrackingEvaluator.h"
+#include "BenchUtilities.h"
+
+
+using namespace std;
+using namespace cv;
+
+typedef TrackingEvaluator::TrackPoint TrackPoint;
+
+
+/** a set of option changes that is evaluated against the unchanged setup */
+struct EvalConfiguration
+{
+	string name;
+	vector< pair<string,string> > options; // option path (e.g. object_detection/static_threshold) and value
+	string dynamics; // if set, all generic object classes use this dynamics module with its standard settings
+};
+
+struct EvalSettings
+{
+	EvalSettings():syntheticCount(0),maxFrames(0),warmupFrames(10),matchingDistance(15){};
+
+	string video;
+	string groundTruthFile; // ground truth for the video
+	unsigned int syntheticCount; // if >0, a synthetic swarm with this number of objects is evaluated instead of a video
+	vector<string> swarmDynamics;
+	vector<string> types;
+	string workingDirectory;
+	string csvFile;
+	unsigned int maxFrames; // 0: all frames of the video, 300 for synthetic swarms
+	unsigned int warmupFrames; // frames excluded from the timing statistics (tracking metrics use all frames)
+	double matchingDistance; // [px]
+	vector<EvalConfiguration> configurations;
+};
+
+struct EvalResult
+{
+	EvalResult():frames(0),totalMs(0){};
+
+	unsigned int frames;
+	double totalMs;
+	vector<double> latencies;
+	TrackingEvaluator::Metrics metrics;
+};
+
+
+static void printUsage()
+{
+	cout<<endl<<"usage: molar_eval [options]"<<endl;
+	cout<<endl<<"Runs a sequence with ground truth through SceneHandler::pushFrame under several configurations and reports the tracking quality (MOTA, MOTP, IDF1, id switches, fragmentations) next to the throughput and the per-frame latency. The unchanged setup is always evaluated first as \"default\"."<<endl;
+	cout<<endl<<"options:";
+	cout<<endl<<"  --video <file>            video to evaluate, requires --ground-truth";
+	cout<<endl<<"  --ground-truth <file>     csv file with the columns frame,id,x,y (further columns are ignored, see molar_bench --ground-truth)";
+	cout<<endl<<"  --synthetic <n>           evaluate a synthetic swarm with n objects instead of a video";
+	cout<<endl<<"  --dynamics <a,...>        dynamics modules driving the synthetic swarm (default: NonHoloKalman2D)";
+	cout<<endl<<"  --config <name:k=v,...>   adds a configuration, k is an option path as object_detection/static_threshold or \"dynamics\" to change the dynamics module of all object classes";
+	cout<<endl<<"  --frames <n>              evaluate at most n frames (default: all, 300 for synthetic swarms)";
+	cout<<endl<<"  --warmup <n>              number of frames excluded from the timing statistics (default: 10)";
+	cout<<endl<<"  --distance <px>           maximal distance of a match between ground truth and tracker output (default: 15)";
+	cout<<endl<<"  --types <a,b,...>         object types that are considered to be in the scene (default: helix types for videos, none for synthetic swarms)";
+	cout<<endl<<"  --workdir <dir>           directory containing the \"generic classes\" folder (default: examples/headless)";
+	cout<<endl<<"  --csv <file>              append the results to a csv file";
+	cout<<endl<<"  --help                    show this message"<<endl<<endl;
+}
+
+/** parses "name:key=value,key=value" */
+static bool parseConfiguration( string _description, EvalConfiguration& _configuration )
+{
+	size_t nameEnd = _description.find(':');
+	_configuration.name = _description.substr( 0, nameEnd );
+	if( _configuration.name.empty() ) return false;
+	if( nameEnd==string::npos ) return true;
+
+	vector<string> entries = splitList( _description.substr( nameEnd+1 ) );
+	for( unsigned int i=0; i<entries.size(); i++ )
+	{
+		size_t separator = entries[i].find('=');
+		if( separator==string::npos || separator==0 ) return false;
+
+		string key = entries[i].substr( 0, separator );
+		string value = entries[i].substr( separator+1 );
+		if( key=="dynamics" ) _configuration.dynamics = value;
+		else _configuration.options.push_back( make_pair( key, value ) );
+	}
+	return true;
+}
+
+static bool parseArguments( int argc, char ** argv, EvalSettings& _settings )
+{
+	EvalConfiguration unchanged;
+	unchanged.name = "default";
+	_settings.configurations.push_back( unchanged );
+
+	for( int i=1; i<argc; i++ )
+	{
+		string arg = argv[i];
+		bool hasValue = (i+1<argc);
+
+		if( arg=="--help" || arg=="-h" )
+		{
+			printUsage();
+			return false;
+		}
+		else if( arg=="--video" && hasValue ) _settings.video = argv[++i];
+		else if( arg=="--ground-truth" && hasValue ) _settings.groundTruthFile = argv[++i];
+		else if( arg=="--synthetic" && hasValue ) _settings.syntheticCount = atoi( argv[++i] );
+		else if( arg=="--dynamics" && hasValue ) _settings.swarmDynamics = splitList( argv[++i] );
+		else if( arg=="--frames" && hasValue ) _settings.maxFrames = atoi( argv[++i] );
+		else if( arg=="--warmup" && hasValue ) _settings.warmupFrames = atoi( argv[++i] );
+		else if( arg=="--distance" && hasValue ) _settings.matchingDistance = atof( argv[++i] );
+		else if( arg=="--types" && hasValue ) _settings.types = splitList( argv[++i] );
+		else if( arg=="--workdir" && hasValue ) _settings.workingDirectory = argv[++i];
+		else if( arg=="--csv" && hasValue ) _settings.csvFile = argv[++i];
+		else if( arg=="--config" && hasValue )
+		{
+			EvalConfiguration configuration;
+			if( !parseConfiguration( argv[++i], configuration ) )
+			{
+				cerr<<endl<<"molar_eval:: Invalid configuration "<<argv[i]<<endl;
+				return false;
+			}
+			_settings.configurations.push_back( configuration );
+		}
+		else
+		{
+			cerr<<endl<<"molar_eval:: Unknown or incomplete option "<<arg<<endl;
+			printUsage();
+			return false;
+		}
+	}
+
+	if( _settings.syntheticCount==0 && ( _settings.video.empty() || _settings.groundTruthFile.empty() ) )
+	{
+		cerr<<endl<<"molar_eval:: Either a synthetic swarm or a video with ground truth is needed"<<endl;
+		printUsage();
+		return false;
+	}
+	if( _settings.workingDirectory.empty() ) _settings.workingDirectory = string(MOLAR_ROOT_DIR)+"/examples/headless";
+	if( _settings.swarmDynamics.empty() ) _settings.swarmDynamics.push_back("NonHoloKalman2D");
+
+	if( !_settings.video.empty() ) _settings.video = boost::filesystem::absolute( _settings.video ).string();
+	if( !_settings.groundTruthFile.empty() ) _settings.groundTruthFile = boost::filesystem::absolute( _settings.groundTruthFile ).string();
+	if( !_settings.csvFile.empty() ) _settings.csvFile = boost::filesystem::absolute( _settings.csvFile ).string();
+	return true;
+}
+
+
+/** reads the columns frame, id, x and y of a csv ground truth file, if it has a sequence column only the first sequence is read */
+static bool loadGroundTruth( string _file, map< unsigned int, vector<TrackPoint> >& _truth )
+{
+	ifstream in( _file.c_str() );
+	if( !in.is_open() ) return false;
+
+	string line;
+	if( !getline( in, line ) ) return false;
+
+	vector<string> header = splitList( line );
+	int frameCol=-1, idCol=-1, xCol=-1, yCol=-1, sequenceCol=-1;
+	for( unsigned int i=0; i<header.size(); i++ )
+	{
+		if( header[i]=="frame" ) frameCol = i;
+		else if( header[i]=="id" ) idCol = i;
+		else if( header[i]=="x" ) xCol = i;
+		else if( header[i]=="y" ) yCol = i;
+		else if( header[i]=="sequence" ) sequenceCol = i;
+	}
+	if( frameCol<0 || idCol<0 || xCol<0 || yCol<0 ) return false;
+	int maxCol = max( max( frameCol, idCol ), max( xCol, yCol ) );
+
+	string sequence;
+	while( getline( in, line ) )
+	{
+		vector<string> columns = splitList( line );
+		if( (int)columns.size()<=maxCol ) continue;
+		if( sequenceCol>=0 && sequenceCol<(int)columns.size() )
+		{
+			if( sequence.empty() ) sequence = columns[sequenceCol];
+			else if( columns[sequenceCol]!=sequence ) continue;
+		}
+		_truth[ atoi( columns[frameCol].c_str() ) ].push_back( TrackPoint( atoi( columns[idCol].c_str() ), (float)atof( columns[xCol].c_str() ), (float)atof( columns[yCol].c_str() ) ) );
+	}
+	return true;
+}
+
+
+/** sets an option given by its path to the value, converted to the type the option already has */
+static bool setOption( string _path, string _value )
+{
+	GenericMultiLevelMap<string>* level = Options::General;
+
+	size_t start = 0;
+	while( start<=_path.size() )
+	{
+		size_t end = _path.find( '/', start );
+		if( end==string::npos ) end = _path.size();
+		string key = _path.substr( start, end-start );
+		if( !level->hasKey(key) ) return false;
+		level = &(*level)[key];
+		start = end+1;
+	}
+
+	if( level->is<double>() ) level->as<double>() = atof( _value.c_str() );
+	else if( level->is<int>() ) level->as<int>() = atoi( _value.c_str() );
+	else if( level->is<unsigned int>() ) level->as<unsigned int>() = (unsigned int)strtoul( _value.c_str(), NULL, 10 );
+	else if( level->is<bool>() ) level->as<bool>() = ( _value=="true" || _value=="1" );
+	else if( level->is<string>() ) level->as<string>() = _value;
+	else return false;
+
+	return true;
+}
+
+
+/** sets the dynamics module of all generic object classes, the previous settings are stored in _previous */
+static bool setClassDynamics( string _dynamics, vector< pair< string, GenericMultiLevelMap<string> > >& _previous )
+{
+	vector<string> available;
+	GenericObject::Dynamics::availableDynamics( available );
+	if( find( available.begin(), available.end(), _dynamics )==available.end() ) return false;
+
+	_previous.clear();
+	for( unsigned int i=0; i<GenericObject::genericObjectClasses.size(); i++ )
+	{
+		Ptr<GenericObject::GOData> objectClass = GenericObject::genericObjectClasses[i];
+		_previous.push_back( make_pair( objectClass->dynamicsType, objectClass->dynamicsOptions ) );
+
+		objectClass->dynamicsType = _dynamics;
+		objectClass->dynamicsOptions = GenericMultiLevelMap<string>();
+		GenericObject::Dynamics::setStandardSettings( _dynamics, objectClass->dynamicsOptions );
+	}
+	return true;
+}
+
+static void restoreClassDynamics( vector< pair< string, GenericMultiLevelMap<string> > >& _previous )
+{
+	for( unsigned int i=0; i<_previous.size() && i<GenericObject::genericObjectClasses.size(); i++ )
+	{
+		GenericObject::genericObjectClasses[i]->dynamicsType = _previous[i].first;
+		GenericObject::genericObjectClasses[i]->dynamicsOptions = _previous[i].second;
+	}
+	_previous.clear();
+}
+
+
+/** runs the sequence through a new SceneHandler with the configuration applied (the options of the setup are restored afterwards) */
+static bool evaluate( const EvalSettings& _settings, const EvalConfiguration& _configuration, const map< unsigned int, vector<TrackPoint> >& _truth, EvalResult& _result )
+{
+	GenericMultiLevelMap<string> unchangedOptions = *Options::General;
+	for( unsigned int i=0; i<_configuration.options.size(); i++ )
+	{
+		if( !setOption( _configuration.options[i].first, _configuration.options[i].second ) )
+		{
+			cerr<<endl<<"molar_eval:: Unknown option or unsupported type: "<<_configuration.options[i].first<<endl;
+			*Options::General = unchangedOptions;
+			return false;
+		}
+	}
+
+	bool success = true;
+	{
+		// the option values are read when the SceneHandler and its members are constructed
+		SceneHandler scene(false);
+		bool synthetic = ( _settings.syntheticCount>0 );
+
+		vector<string> types = _settings.types;
+		if( types.empty() && !synthetic )
+		{
+			types.push_back("ThickHelix_KF");
+			types.push_back("ThinHelix_KF");
+			types.push_back("Unknown Type");
+		}
+		scene.typesInScene( types );
+
+		vector< pair< string, GenericMultiLevelMap<string> > > previousDynamics;
+		if( !_configuration.dynamics.empty() && !setClassDynamics( _configuration.dynamics, previousDynamics ) )
+		{
+			cerr<<endl<<"molar_eval:: Unknown dynamics module "<<_configuration.dynamics<<endl;
+			*Options::General = unchangedOptions;
+			return false;
+		}
+
+		VideoCapture video;
+		Ptr<SyntheticSwarm> swarm;
+		if( synthetic )
+		{
+			SyntheticSwarm::Settings swarmSettings;
+			swarmSettings.objectCount = _settings.syntheticCount;
+			swarmSettings.dynamicsTypes = _settings.swarmDynamics;
+			swarm = new SyntheticSwarm( &scene.objects(), swarmSettings );
+			success = swarm->valid();
+			double frameRate = swarm->frameRate();
+			scene.setFrameRate( frameRate );
+		}
+		else
+		{
+			success = video.open( _settings.video );
+			if( success ) scene.setFrameRate( video );
+
+			GenericMultiLevelMap<string> filterOptions;
+			filterOptions["contrast_factor"].as<double>()=2.7;
+			filterOptions["brightness_offset"].as<double>()=20;
+			scene.addInternPreProcessingAlgorithm("contrast brightness adjustment",filterOptions);
+		}
+		if( !success ) cerr<<endl<<"molar_eval:: Could not open the sequence"<<endl;
+
+		TrackingEvaluator evaluator( _settings.matchingDistance );
+		unsigned int maxFrames = _settings.maxFrames;
+		if( maxFrames==0 && synthetic ) maxFrames = 300;
+
+		Mat frame;
+		vector<TrackPoint> truth, hypotheses;
+		vector< Ptr<SceneObject> > objects;
+		for( unsigned int frameCount=0; success && ( maxFrames==0 || frameCount<maxFrames ); frameCount++ )
+		{
+			double frameTime;
+			truth.clear();
+			if( synthetic )
+			{
+				(*swarm)>>frame;
+				frameTime = swarm->time();
+				const vector<SyntheticSwarm::TruthEntry>& swarmTruth = swarm->groundTruth();
+				for( unsigned int i=0; i<swarmTruth.size(); i++ ) truth.push_back( TrackPoint( swarmTruth[i].id, swarmTruth[i].x, swarmTruth[i].y ) );
+			}
+			else
+			{
+				frameTime = video.get(CV_CAP_PROP_POS_MSEC);
+				if( !video.read(frame) ) break;
+				map< unsigned int, vector<TrackPoint> >::const_iterator frameTruth = _truth.find( frameCount );
+				if( frameTruth!=_truth.end() ) truth = frameTruth->second;
+			}
+
+			double start = wallTime();
+			scene.pushFrame( frame, frameTime );
+			double duration = wallTime()-start;
+
+			if( frameCount>=_settings.warmupFrames )
+			{
+				_result.latencies.push_back( duration );
+				_result.totalMs += duration;
+				_result.frames++;
+			}
+
+			hypotheses.clear();
+			scene.objects().activeObjects( objects );
+			for( unsigned int i=0; i<objects.size(); i++ )
+			{
+				Ptr<SceneObject::State> state = objects[i]->state();
+				if( !state.empty() ) hypotheses.push_back( TrackPoint( objects[i]->id(), (float)state->x, (float)state->y ) );
+			}
+			evaluator.addFrame( truth, hypotheses );
+		}
+		_result.metrics = evaluator.metrics();
+
+		restoreClassDynamics( previousDynamics );
+	}
+
+	*Options::General = unchangedOptions;
+	return success;
+}
+
+
+static void report( const string& _sequence, const EvalConfiguration& _configuration, EvalResult& _result, ofstream& _csv )
+{
+	vector<double> sorted = _result.latencies;
+	sort( sorted.begin(), sorted.end() );
+
+	double fps = ( _result.totalMs>0 )? 1000*_result.frames/_result.totalMs : 0;
+	double mean = ( _result.frames>0 )? _result.totalMs/_result.frames : 0;
+	const TrackingEvaluator::Metrics& m = _result.metrics;
+
+	cout<<endl<<left<<setw(20)<<_configuration.name<<right<<fixed<<setprecision(1)<<setw(9)<<fps<<setprecision(2)<<setw(9)<<mean<<setw(9)<<percentile(sorted,95)
+		<<setprecision(3)<<setw(8)<<m.mota<<setprecision(2)<<setw(8)<<m.motp<<setprecision(3)<<setw(8)<<m.idf1<<setw(8)<<m.idSwitches<<setw(8)<<m.fragmentations<<setw(9)<<m.falsePositives<<setw(9)<<m.misses;
+
+	if( _csv.is_open() )
+	{
+		_csv<<_sequence<<","<<_configuration.name<<","<<m.frames<<","<<fixed<<setprecision(3)<<fps<<","<<mean<<","<<percentile(sorted,95)<<","<<m.mota<<","<<m.motp<<","<<m.idf1<<","<<m.idPrecision<<","<<m.idRecall<<","<<m.idSwitches<<","<<m.fragmentations<<","<<m.falsePositives<<","<<m.misses<<endl;
+	}
+}
+
+
+int main( int argc, char ** argv )
+{
+	EvalSettings settings;
+	if( !parseArguments( argc, argv, settings ) ) return 0;
+
+	map< unsigned int, vector<TrackPoint> > truth;
+	if( settings.syntheticCount==0 && !loadGroundTruth( settings.groundTruthFile, truth ) )
+	{
+		cerr<<endl<<"molar_eval:: Could not read ground truth from "<<settings.groundTruthFile<<endl;
+		return 1;
+	}
+
+	boost::system::error_code error;
+	boost::filesystem::current_path( settings.workingDirectory, error );
+	if( error )
+	{
+		cerr<<endl<<"molar_eval:: Could not change into working directory "<<settings.workingDirectory<<endl;
+		return 1;
+	}
+	Options::load_options();
+
+	stringstream sequence;
+	if( settings.syntheticCount>0 ) sequence<<"synthetic_"<<settings.syntheticCount;
+	else sequence<<settings.video;
+
+	ofstream csv;
+	if( !settings.csvFile.empty() )
+	{
+		bool newFile = !boost::filesystem::exists( settings.csvFile );
+		csv.open( settings.csvFile.c_str(), ios::app );
+		if( !csv.is_open() ) cerr<<endl<<"molar_eval:: Could not open "<<settings.csvFile<<" for writing"<<endl;
+		else if( newFile ) csv<<"sequence,configuration,frames,fps,mean_ms,p95_ms,mota,motp,idf1,id_precision,id_recall,id_switches,fragmentations,false_positives,misses"<<endl;
+	}
+
+	cout<<endl<<sequence.str()<<", matching distance "<<settings.matchingDistance<<"px"<<endl;
+	cout<<endl<<left<<setw(20)<<"configuration"<<right<<setw(9)<<"fps"<<setw(9)<<"mean ms"<<setw(9)<<"p95 ms"<<setw(8)<<"MOTA"<<setw(8)<<"MOTP"<<setw(8)<<"IDF1"<<setw(8)<<"IDSW"<<setw(8)<<"Frag"<<setw(9)<<"FP"<<setw(9)<<"FN";
+
+	int returnValue = 0;
+	for( unsigned int i=0; i<settings.configurations.size(); i++ )
+	{
+		EvalResult result;
+		if( !evaluate( settings, settings.configurations[i], truth, result ) )
+		{
+			returnValue = 1;
+			continue;
+		}
+		report( sequence.str(), settings.configurations[i], result, csv );
+	}
+	cout<<endl<<endl;
+
+	return returnValue;
+}
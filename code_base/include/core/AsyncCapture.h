@@ -0,0 +1,127 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <deque>
+#include <string>
+#include "opencv2/core/core.hpp"
+#include "opencv2/highgui/highgui.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "FrameScheduler.h"
+
+using namespace std;
+using namespace cv;
+
+/** reads frames from a video source on a thread of its own into a small ring buffer
+*
+* Reading from a camera inside the processing thread lets frames pile up in the driver queue as soon as processing a frame takes longer than
+* one frame period, and every frame is then processed later and later. With the drop policy NEWEST the capture thread keeps grabbing and
+* overwrites the oldest buffered frame when the buffer is full, so read() always returns the newest frames. With NO_DROP (meant for video files)
+* the capture thread waits for room in the buffer instead, decoding then just runs in parallel to the processing.
+* Each frame carries the time it was grabbed, which is used as its arrival time for the frame deadline (see SceneHandler::operator<<).
+*/
+class AsyncCapture
+{
+public:
+	enum DropPolicy
+	{
+		NEWEST = 0, // drop the oldest buffered frame if the buffer is full
+		NO_DROP, // wait until there is room in the buffer
+		AUTOMATIC // NEWEST for devices, NO_DROP for files
+	};
+
+	/** a captured frame */
+	struct CapturedFrame
+	{
+		CapturedFrame():time(0),captureTime(0),index(0){};
+
+		Mat image;
+		double time; // time stamp of the frame in the stream [ms]: the position reported by the source or, if it doesn't report one, the time since the first frame
+		double captureTime; // time the frame was grabbed [ms, FrameScheduler::now() time base]
+		unsigned long index; // number of the frame in the stream, counting dropped frames too
+	};
+
+	/** frame counters since the source was opened */
+	struct Statistics
+	{
+		Statistics():captured(0),delivered(0),dropped(0){};
+
+		unsigned long captured; // frames grabbed from the source
+		unsigned long delivered; // frames returned by read()
+		unsigned long dropped; // frames overwritten before they were read
+	};
+
+	/** buffer size and drop policy are taken from runtime/capture if not given */
+	AsyncCapture();
+	AsyncCapture( unsigned int _bufferSize, DropPolicy _policy );
+	~AsyncCapture();
+
+	/** opens a video file and starts capturing */
+	bool open( const string& _file );
+	/** opens a camera and starts capturing */
+	bool open( int _device );
+	/** stops capturing and closes the source */
+	void close();
+	bool isOpened() const;
+
+	/** waits for the next buffered frame, returns false if the source has ended (or was closed) and no more frames are buffered */
+	bool read( CapturedFrame& _frame );
+	AsyncCapture& operator>>( Mat& _frame );
+
+	/** frame rate reported by the source (0 if unknown) */
+	double frameRate() const;
+	/** size of the frames reported by the source */
+	Size frameSize() const;
+
+	Statistics statistics() const;
+	/** the drop policy in use (AUTOMATIC is resolved when the source is opened) */
+	DropPolicy dropPolicy() const;
+
+	static void setupOptions();
+private:
+	VideoCapture pSource;
+	bool pIsFile;
+	unsigned int pBufferSize;
+	DropPolicy pRequestedPolicy;
+	DropPolicy pPolicy;
+	double pFrameRate;
+	Size pFrameSize;
+
+	deque<CapturedFrame> pBuffer;
+	Statistics pStatistics;
+	bool pRunning; // false once the source ended or close() was called
+	double pFirstCaptureTime;
+
+	mutable boost::mutex pMutex; // protects the buffer, the statistics and pRunning
+	boost::condition_variable pFrameAvailable;
+	boost::condition_variable pRoomAvailable;
+	boost::thread pWorker;
+
+	/** starts the capture thread on the opened source */
+	bool start();
+	void captureThread();
+
+	//temporary option variables
+	static unsigned int capture_buffer_size;
+	static string capture_drop_policy;
+};
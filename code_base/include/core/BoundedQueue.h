@@ -0,0 +1,110 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <deque>
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+using namespace std;
+
+/** first-in first-out queue with a maximal length that is used to pass work between threads
+*
+* push() blocks while the queue is full and pop() while it is empty. After close() no new elements are accepted and pop() returns false as
+* soon as the queue has run empty, which is used to shut down the consuming thread.
+*/
+template<class T>
+class BoundedQueue
+{
+public:
+	BoundedQueue( unsigned int _capacity=2 ):pCapacity( _capacity==0? 1 : _capacity ),pClosed(false){};
+
+	/** appends an element, waits while the queue is full. Returns false (without adding the element) if the queue is closed */
+	bool push( const T& _element )
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		while( !pClosed && pQueue.size()>=pCapacity ) pNotFull.wait( lock );
+		if( pClosed ) return false;
+
+		pQueue.push_back( _element );
+		pNotEmpty.notify_one();
+		return true;
+	};
+
+	/** removes the oldest element, waits while the queue is empty. Returns false if the queue is closed and empty */
+	bool pop( T& _element )
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		while( !pClosed && pQueue.empty() ) pNotEmpty.wait( lock );
+		if( pQueue.empty() ) return false;
+
+		_element = pQueue.front();
+		pQueue.pop_front();
+		pNotFull.notify_one();
+		return true;
+	};
+
+	/** stops accepting elements and wakes up all waiting threads, the elements still in the queue can be popped */
+	void close()
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		pClosed = true;
+		pNotFull.notify_all();
+		pNotEmpty.notify_all();
+	};
+
+	/** empties the queue and makes it accept elements again */
+	void reopen()
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		pQueue.clear();
+		pClosed = false;
+	};
+
+	/** sets the maximal length, elements beyond it that are already in the queue are kept */
+	void setCapacity( unsigned int _capacity )
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		pCapacity = ( _capacity==0 )? 1 : _capacity;
+		pNotFull.notify_all();
+	};
+
+	unsigned int capacity() const
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		return pCapacity;
+	};
+
+	unsigned int size() const
+	{
+		boost::mutex::scoped_lock lock( pMutex );
+		return pQueue.size();
+	};
+
+private:
+	deque<T> pQueue;
+	unsigned int pCapacity;
+	bool pClosed;
+
+	mutable boost::mutex pMutex;
+	boost::condition_variable pNotFull;
+	boost::condition_variable pNotEmpty;
+};
@@ -26,6 +26,7 @@
 using namespace cv;
 
 
+/** a frame whose original and edited versions are kept encoded in memory (format as set in runtime/compression) */
 class CompressedFrame
 {
 	friend class VideoBuffer;
@@ -53,18 +54,37 @@ public:
 
 	double time() const;
 
+	/** encodes both versions of the frame, an edited version that shares the data of the original isn't encoded a second time
+	*/
+	void encode( Frame& _uncompressed );
+
+	/** decodes both versions into a new frame
+	*/
+	Frame decode() const;
+
 	/** returns the used memory in bytes
 	*/
 	int memUsage() const;
 
+	// option setup
+	static void setupOptions();
+
 private:
     vector<uchar> pOriginal; //compressed original image
     vector<uchar> pEdited; //compressed edited image
+	bool pEditedIsOriginal; // the edited version is the unchanged original, pEdited is empty then
+	bool pComplete; // false while the frame is still being encoded on a compression thread of the VideoBuffer
+	bool pDropped; // placeholder of a frame the VideoBuffer couldn't compress in time: keeps the numbering of the compressed tier, holds no images
 	double pTime; //ms
 
 	/** encodes the image and saves it in the target memory using the standard settings
 	*/
     bool encodeImage( vector<uchar>* _targetMemory, Mat& _image );
 	Mat decodeImage( vector<uchar>* _targetMemory ) const;
+
+	//option variables
+	static string compression_format;
+	static int png_compression_level;
+	static int jpeg_quality;
 };
 
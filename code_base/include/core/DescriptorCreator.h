@@ -67,6 +67,9 @@ public:
 	/** returns the number of descriptors the set contains */
     unsigned int dataEntrySize();
 
+	/** returns the memory used by the recorded descriptors and the snapshot [bytes] */
+	size_t memUsage() const;
+
 private:
 	bool pRecord; // indicates if descriptor is recording or not
 
@@ -89,10 +89,10 @@ public:
 	virtual double predictArea() =0;
 
 	// DRAWING
-	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color );
-	virtual void drawPath( Mat& _img, Scalar _color );
-	virtual void drawDirection( Mat& _img, Scalar _color );
-	virtual void drawName( Mat& _img );
+	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawPath( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawName( Mat& _img, FrameOverlay* _overlay=NULL );
 
 	
 	// UTILITY FUNCTIONS ///////////////////////////////////////////////////////////
@@ -109,6 +109,7 @@ public:
 	// INTERFACE TO GENERIC OBJECT (AND SCENE OBJECT) PRIVATES FOR CHILD CLASSES (SINCE THOSE ARE NO GO CLASS MEMBERS ANYMORE)
 protected:
 	deque< Ptr<SceneObject::State> >& pHistory();
+	void label( string& _text, Scalar& _color ); // text and colour of the label drawn by drawName()
 	bool& trace_states();
 	Point* pROI();
 	vector<Point>& pLastContour();
@@ -0,0 +1,62 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <list>
+#include <vector>
+#include "IPAlgorithm.h"
+
+using namespace std;
+using namespace cv;
+
+/** applies a stack of IPAlgorithms, consecutive point-wise ones (see IPAlgorithm::pointWise()) as a single combined look up table
+*
+* Every point-wise algorithm used to make a LUT() pass over the whole image of its own. A run of consecutive point-wise algorithms is now
+* composed into one table (the table of the second one looked up with the table of the first one, and so on) which is applied in a single
+* pass. The combined tables are cached and only composed again when the table of one of their algorithms changed (an option was set or a
+* histogram recalculated). A point-wise algorithm that needs to look at the image in the current frame starts a new run, it thus still sees
+* the image as processed by all algorithms before it. Only 8 bit images are processed this way, others go through apply() one by one.
+*/
+class FilterChain
+{
+public:
+	FilterChain();
+
+	/** applies the active algorithms of the stack to the image, returns false if one of them failed (the ones after it aren't applied) */
+	bool apply( list< Ptr<IPAlgorithm> >& _stack, Mat& _image );
+
+	/** number of passes over the image made by the last apply() */
+	unsigned int passes() const;
+
+private:
+	/** combined table of a run of point-wise algorithms, together with the table versions it was composed of */
+	struct Run
+	{
+		vector<const IPAlgorithm*> algorithms;
+		vector<unsigned long> versions;
+		Mat table;
+	};
+	vector<Run> pRuns; // in the order of the runs in the stack
+	unsigned int pPasses;
+
+	/** applies the combined table of the given run to the image, the cached table is composed anew if it is out of date */
+	void applyRun( unsigned int _run, const vector<const IPAlgorithm*>& _algorithms, Mat& _image );
+};
@@ -51,6 +51,8 @@ class FilteredDynamics::State: public SceneObject::State
 		State( double _x, double _y, double time, double _angle=0, double _area=0 );
 		State( Point _pos, double time, double _angle=0, double _area=0 );
 
+		virtual size_t memUsage() const;
+
 		double raw_x;
 		double raw_y;
 		double raw_angle;
@@ -0,0 +1,144 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "frame.h"
+#include "boost/cstdint.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
+#include "boost/scoped_ptr.hpp"
+#include "boost/thread/mutex.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** append-only archive of raw frames with an index, read through a memory mapping
+*
+* An archive consists of two files: <path>.mfa contains a fixed header followed by the pixel data of the frames, <path>.mfi the same header
+* followed by one fixed size IndexEntry per frame (position in the data file, time stamp, size, codec and format of the images). A frame is
+* found by its number in constant time and by its time stamp through a binary search over the index, reading it then only touches the pages
+* of its own data, which are usually still in the page cache. The data of a frame is written before its index entry, an archive that wasn't
+* closed properly thus only loses the frame that was being written.
+* A frame that carries a FrameOverlay is stored without its edited version: the overlay follows the original instead and the edited
+* version is rendered from the two when the frame is loaded (without the central path image, see OverlayRenderer).
+* Appending and reading may take place on different threads.
+*/
+class FrameArchive
+{
+public:
+	static const boost::uint32_t formatVersion = 2;
+
+	enum Codec
+	{
+		RAW = 0 // the pixel data as is, row by row
+	};
+
+	/** header at the beginning of both files */
+	struct Header
+	{
+		char magic[8]; // "MOLARFA" followed by 'd' (data file) or 'i' (index file)
+		boost::uint32_t version;
+		boost::uint32_t headerSize;
+		boost::uint32_t entrySize; // size of an IndexEntry
+		boost::uint32_t reserved[11];
+	};
+
+	/** index entry of a frame */
+	struct IndexEntry
+	{
+		boost::uint64_t offset; // position of the frame data in the data file
+		double time; // time stamp of the frame [ms]
+		boost::uint64_t size; // bytes of frame data: the original version followed by the edited one or the overlay
+		boost::uint32_t codec;
+		boost::int32_t originalRows, originalCols, originalType;
+		boost::int32_t editedRows, editedCols, editedType; // editedType is -1 if the edited version is the unchanged original (it is not stored then), -2 if it is rendered from the overlay
+		boost::uint32_t overlaySize; // bytes of the serialized overlay at the end of the frame data
+	};
+
+	FrameArchive();
+	~FrameArchive();
+
+	/** creates a new archive, existing files are overwritten */
+	bool create( const string& _path );
+	/** opens an existing archive, further frames are appended if _append is true */
+	bool open( const string& _path, bool _append=false );
+	void close();
+	bool isOpen() const;
+
+	/** appends a frame, returns false if it couldn't be written */
+	bool append( Frame& _frame );
+
+	/** number of frames in the archive */
+	unsigned long size() const;
+	/** reads frame i (i=0: the first frame appended), returns false if there is no such frame */
+	bool load( unsigned long _i, Frame& _frame ) const;
+	/** reads the original version of frame i and its overlay (an empty pointer if the frame was stored with its edited version) */
+	bool loadOriginal( unsigned long _i, Mat& _original, Ptr<FrameOverlay>& _overlay, double& _time ) const;
+	/** returns the number of the last frame whose time stamp isn't later than _time, -1 if there is none */
+	long find( double _time ) const;
+	/** index entry of frame i */
+	IndexEntry entry( unsigned long _i ) const;
+
+	/** size of both files in bytes */
+	size_t bytes() const;
+	/** paths of the data and the index file */
+	string dataFile() const;
+	string indexFile() const;
+
+private:
+	string pPath;
+	bool pWritable;
+	ofstream pData;
+	ofstream pIndexOut;
+	vector<IndexEntry> pIndex;
+	boost::uint64_t pDataSize;
+
+	// read access
+	mutable boost::scoped_ptr<boost::interprocess::file_mapping> pMapping;
+	/** a mapped part of the data file, it starts and ends at frame boundaries */
+	struct MappedRange
+	{
+		boost::uint64_t offset;
+		Ptr<boost::interprocess::mapped_region> region;
+		boost::uint64_t end() const;
+	};
+	mutable vector<MappedRange> pRegions; // cover the data file as far as it was written when it was last mapped, ordered by their offset (their sizes decrease)
+
+	mutable boost::mutex pMutex; // protects the index, the data size and the mapping
+
+	static Header header( char _type );
+	static bool validHeader( const Header& _header, char _type );
+	/** writes the image data, returns the number of bytes written */
+	boost::uint64_t writeImage( const Mat& _image );
+	/** reads the original version of frame i and its overlay, or the whole frame into _frame (if given) if it was stored with its edited version */
+	bool read( unsigned long _i, Mat& _original, Ptr<FrameOverlay>& _overlay, Frame* _frame, double& _time ) const;
+	/** maps the part of the data file that was appended since it was last mapped if _end lies beyond the mapped ranges
+	*
+	* Smaller ranges before it are merged into the new one: every byte is thus mapped again only a logarithmic number of times while the
+	* archive grows, and the number of mappings stays logarithmic in the size of the file.
+	*/
+	bool mapData( boost::uint64_t _end ) const;
+	/** address of the data at _offset, NULL if it isn't mapped */
+	uchar* mappedData( boost::uint64_t _offset ) const;
+};
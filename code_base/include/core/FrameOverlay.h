@@ -0,0 +1,97 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <string>
+#include <vector>
+#include "opencv2/core/core.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** the annotations drawn into a frame, recorded as a list of primitives (lines, polylines, rectangles, labels) instead of pixels
+*
+* Recording the original frames together with their overlay takes about half the disk space of recording the original and the edited
+* version, the edited version is rendered from the overlay when it is needed. The primitives are drawn layer by layer, just like
+* ObjectHandler::draw() lets the objects draw their layers, and in the order they were recorded inside a layer.
+* Path steps are the exception: they belong into the central path image of the path_length modes -1 and -2, which accumulates over
+* the frames and is thus only rebuilt by an OverlayRenderer that renders the frames in order.
+*/
+class FrameOverlay
+{
+public:
+	enum PrimitiveType
+	{
+		LINE = 0,
+		POLYLINE,
+		RECTANGLE,
+		LABEL, // text with a backing rectangle and a circle at its anchor, as drawn by SceneObject::drawName()
+		PATH_STEP // line drawn into the central path image
+	};
+
+	struct Primitive
+	{
+		unsigned char type;
+		unsigned char layer;
+		unsigned char thickness;
+		Vec3b color;
+		vector<Point> points; // in coordinates of the whole frame
+		string text;
+	};
+
+	FrameOverlay();
+
+	/** sets the position of the image that is drawn into relative to the whole frame, it is added to the points recorded afterwards */
+	void setOrigin( Point _origin );
+
+	void line( unsigned int _layer, Point _start, Point _end, Scalar _color, int _thickness=1 );
+	void polyline( unsigned int _layer, const vector<Point>& _points, Scalar _color, int _thickness=1 );
+	void rectangle( unsigned int _layer, Rect _rectangle, Scalar _color, int _thickness=1 );
+	void label( unsigned int _layer, Point _position, const string& _text, Scalar _color );
+	void pathStep( Point _start, Point _end, Scalar _color );
+
+	const vector<Primitive>& primitives() const;
+	bool empty() const;
+	void clear();
+
+	/** renders the overlay into a colour copy of _original (_annotated shares the data of _original if there is nothing to draw into a
+	* colour frame). Path steps are drawn into _pathImage, which is subtracted from the frame after the first layer, they are left out if
+	* it is NULL. */
+	void render( const Mat& _original, Mat& _annotated, Mat* _pathImage=NULL ) const;
+
+	/** appends the compact binary form of the overlay to _data */
+	void serialize( vector<uchar>& _data ) const;
+	/** reads an overlay written by serialize(), returns false if the data is incomplete */
+	bool deserialize( const uchar* _data, size_t _size );
+
+	/** returns the used memory in bytes */
+	size_t memUsage() const;
+
+	/** draws _text with a light backing rectangle next to _position (kept inside the image) and marks _position with a circle */
+	static void drawLabel( Mat& _img, Point _position, const string& _text, Scalar _color );
+
+private:
+	vector<Primitive> pPrimitives;
+	Point pOrigin;
+
+	Primitive& add( unsigned char _type, unsigned int _layer, Scalar _color, int _thickness );
+	static void draw( Mat& _img, const Primitive& _primitive );
+};
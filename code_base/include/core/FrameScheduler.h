@@ -0,0 +1,105 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include "boost/chrono.hpp"
+
+using namespace std;
+
+/** keeps track of the deadline of the frame currently processed
+*
+* Times are taken from a monotonic wall clock: unlike clock() this is not affected by other threads of the process or by the process sleeping.
+* The deadline of a frame is its arrival time plus one frame period. Optional stages (classification, drawing, buffer spilling) ask the
+* scheduler whether they still fit into the frame before they run. Each of them can additionally be limited to a budget of its own:
+*	budget <0: the stage is not controlled by the scheduler and always runs
+*	budget =0: the stage may use whatever is left of the frame period
+*	budget >0: the stage may use at most budget [ms] per frame, and not more than what is left of the frame period
+* The costs reported for a stage during a frame are charged against its budget.
+*/
+class FrameScheduler
+{
+public:
+	/** stages that may be skipped or postponed if the frame deadline is near */
+	enum OptionalStage
+	{
+		CLASSIFICATION = 0,
+		DRAWING,
+		BUFFER_SPILL,
+		NR_OF_OPTIONAL_STAGES
+	};
+
+	FrameScheduler( double _frameRate=30 );
+
+	/** current time of the monotonic clock [ms] (the origin is arbitrary, use differences only) */
+	static inline double now(){ return boost::chrono::duration<double,boost::milli>( boost::chrono::steady_clock::now().time_since_epoch() ).count(); };
+
+	void setFrameRate( double _frameRate );
+	/** time available per frame [ms] */
+	double framePeriod() const;
+
+	/** marks the arrival of a new frame now, the stage budgets are renewed */
+	void frameArrived();
+	/** marks the arrival of a new frame at the given time (e.g. the capture time stamp if known) [ms, now() time base] */
+	void frameArrived( double _arrivalTime );
+
+	/** arrival time of the current frame [ms, now() time base] */
+	double arrivalTime() const;
+	/** time at which the processing of the current frame should be finished [ms, now() time base] */
+	double deadline() const;
+	/** time passed since the arrival of the current frame [ms] */
+	double elapsed() const;
+	/** time left until the deadline of the current frame, negative if it has already passed [ms] */
+	double remaining() const;
+
+	/** time the stage may still use in the current frame [ms] (its budget minus the costs reported for it since the frame arrived), a negative budget setting yields the time left until the deadline */
+	double budget( OptionalStage _stage ) const;
+	/** returns true if a stage with the given estimated cost [ms] should run */
+	bool allows( OptionalStage _stage, double _estimatedCost ) const;
+	/** returns true if the stage should run, based on the costs reported for it so far */
+	bool allows( OptionalStage _stage ) const;
+
+	/** reports the time [ms] an optional stage took, used to estimate its cost and charged against its budget in the current frame */
+	void reportCost( OptionalStage _stage, double _cost );
+	/** smoothed estimate of the cost of an optional stage [ms] */
+	double estimatedCost( OptionalStage _stage ) const;
+	/** costs reported for an optional stage since the arrival of the current frame [ms] */
+	double consumed( OptionalStage _stage ) const;
+
+	/** sets the budget of a stage [ms], see the class description */
+	void setStageBudget( OptionalStage _stage, double _budget );
+	double stageBudget( OptionalStage _stage ) const;
+
+	static void setupOptions();
+private:
+	double pFramePeriod;
+	double pArrivalTime;
+	vector<double> pStageBudget;
+	vector<double> pEstimatedCost;
+	vector<double> pConsumed; // reported costs per stage in the current frame
+
+	static const double costSmoothing; // weight of a new cost report in the estimate
+
+	//temporary option variables
+	static double classification_budget;
+	static double drawing_budget;
+	static double buffer_spill_budget;
+};
@@ -22,6 +22,7 @@
 #include "sceneobject.h"
 #include "boost/filesystem.hpp"
 
+class StreamContext;
 
 
 /** class providing means for flexibly building generic classes with the entities wished and newly trained classifiers */
@@ -94,10 +95,10 @@ public:
 	virtual double predictArea();
 
 	// DRAWING
-	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color );
+	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay=NULL );
 
 	// CLASSIFICATION
-	static double isType( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId );
+	static double isType( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId, ObjectHandler* _environment );
 	
 	/** extracts the descriptor set in the area _boundingRect (extended by 5px in all directions -> _boundingRect is altered!) in the image _img
 	*	and stores it in _descriptors.
@@ -114,6 +115,9 @@ public:
 	*/
 	virtual Ptr<SceneObject> recalculateClass( Ptr<SceneObject> _oldPointer ); // added here because if the object class changes, generic objects need to unregister themselves
 
+	/** sets the dynamics options of the objects of the generic class _genId instantiated in _stream */
+	static void setDynamicsOptions( StreamContext& _stream, unsigned int _genId, GenericMultiLevelMap<string>& _options );
+
 	/** finds the object _old in the object registration list and erases the entry */
 	static void unregisterObject( Ptr<SceneObject> _old );
 
@@ -124,6 +128,9 @@ public:
 	static bool isGeneric( Ptr<SceneObject> _obj );
 	static bool isGenericType( int _classId );
 
+	/** returns the memory used by the given classifiers [bytes], instances used for several classes are counted once */
+	static size_t classifierMemUsage( const vector<Ptr<CvBoost> >& _classifiers );
+
 
 	// UTILITY FUNCTIONS
 	static string timeString(); // returns the actual time in ms - used for unique name creation
@@ -146,7 +153,6 @@ protected:
 	static bool setupClass();
 
 	// classifier objects
-    static vector<Ptr<CvBoost> > classifier; // index equivalent to generic class id
 	static FastFeatureDetector detector;
 	static BRISK extractor;
 
@@ -184,7 +190,6 @@ public:
 	static Ptr<FeatureData> getFeatureInfo( string _featureId );
 
 	static vector<int> genericToOverallClassIds; // registers overall class ids for each generic class: genericToOverallClassIds[overallId]=genId (this more complicated version than its inverse is chosen because this conversion needs to be done more often)
-    static vector<list<Ptr<GenericObject> > > genericObjectLists; // lists of the objects that are currently instantiated for each generic object class
     static vector<vector<double> > classTypeLikelihoodFunctions; // describes for each class how likely it is for an object to be of the class type if a certain percentage of descriptors were classified as class descriptors
 
 
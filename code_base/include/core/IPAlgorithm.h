@@ -24,6 +24,7 @@
 #include <map>
 #include <iostream>
 #include "genericmultilevelmap.hpp"
+#include "boost/thread/mutex.hpp"
 
 using namespace std;
 using namespace cv;
@@ -37,7 +38,7 @@ class IPAlgorithm
 {
 public:
 	IPAlgorithm(void);
-	~IPAlgorithm(void);
+	virtual ~IPAlgorithm(void); // virtual: the algorithms are deleted through Ptr<IPAlgorithm>
 
 	/** sets whether the filter is active or not */
 	bool active;
@@ -96,13 +97,49 @@ public:
 	/** load standard settings */
 	virtual void resetSetting()=0;
 
+
+	// POINT-WISE ALGORITHMS: consecutive ones are applied as one combined look up table (see FilterChain)
+
+	/** returns true if the algorithm maps every pixel value of an 8 bit image to a new value independently of the other pixels and thus can
+	* be applied as the look up table returned by lookUpTable()
+	*/
+	virtual bool pointWise() const;
+
+	/** returns true if the next call of updateLookUpTable() is going to look at the image (e.g. to recalculate a histogram): the image then
+	* has to have been processed by all algorithms before this one
+	*/
+	virtual bool needsImage() const;
+
+	/** called once per image instead of apply() if the algorithm is applied through its look up table: advances the state process() would
+	* advance and updates the table
+	*/
+	virtual void updateLookUpTable( const Mat& _image );
+
+	/** returns the current look up table (1x256, CV_8U), empty if there is none (apply() is used then) */
+	Mat lookUpTable() const;
+
+	/** returns the current look up table together with its version, a number that changes whenever the table changes (unique over all algorithms) */
+	Mat lookUpTable( unsigned long& _version ) const;
+
 protected:
 	/** applies the algorithm to the image
 	*/
 	virtual bool process( Mat& _image )=0;
 
+	/** publishes a new look up table of a point-wise algorithm (may be called from any thread) */
+	void setLookUpTable( const Mat& _table );
+
 private:
 	static map<string,Ptr<IPAlgorithm>(*)()>* registeredAlgorithms;
 
+	Mat pLookUpTable;
+	unsigned long pLookUpTableVersion;
+	mutable boost::mutex pLookUpTableMutex; // table and version are read and replaced together
+
+	/** returns a new look up table version */
+	static unsigned long newLookUpTableVersion();
+	static unsigned long lookUpTableVersions;
+	static boost::mutex lookUpTableVersionsMutex; // the algorithms of several streams (and their worker threads) draw versions concurrently
+
 };
 
@@ -0,0 +1,65 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <set>
+#include <ostream>
+#include "opencv2/core/core.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** memory used by the data the SceneHandler accumulates at runtime, in bytes per category
+*
+* The numbers are counted from the actual containers: image buffers shared between several Mat headers (e.g. a frame and its edited version
+* if no preprocessing took place) are counted once. Small bookkeeping allocations of the standard containers are not included.
+*/
+struct MemoryReport
+{
+	MemoryReport();
+
+	size_t frameBuffer; // uncompressed frames in the VideoBuffer (original, edited and greyscale images)
+	unsigned int bufferedFrames;
+	size_t compressedBuffer; // compressed frames kept in memory
+	unsigned int compressedFrames;
+	size_t diskSpill; // temporary video files written to the hard disk (not part of total())
+	unsigned int spillFiles;
+
+	size_t histories; // state histories of the active (categorized, uncategorized and missing) objects
+	unsigned long states;
+	unsigned int activeObjects;
+	size_t pathImages; // path images of the objects and of the ObjectHandler
+	size_t lostObjects; // histories and path images of objects that left the scene
+	unsigned int lostCount;
+	size_t descriptorSets; // descriptors and snapshots recorded by DescriptorCreators
+	size_t classifiers; // loaded classifier models
+
+	/** memory in RAM, that is all categories but diskSpill */
+	size_t total() const;
+
+	/** writes a table with all categories */
+	void print( ostream& _out ) const;
+	/** writes all categories as a csv line (with the header line if _header is true), preceded by the given frame number and time */
+	void writeCsv( ostream& _out, unsigned int _frame, double _time, bool _header=false ) const;
+
+	/** returns the size of the buffer the Mat refers to if it hasn't been counted yet (its start address is then added to _counted), 0 otherwise */
+	static size_t matMemUsage( const Mat& _mat, set<const uchar*>& _counted );
+};
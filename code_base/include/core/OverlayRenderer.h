@@ -0,0 +1,61 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <string>
+#include <climits>
+#include "FrameOverlay.h"
+#include "FrameArchive.h"
+#include "opencv2/highgui/highgui.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** rebuilds the annotated video from recorded original frames and their FrameOverlays
+*
+* A single overlay renders everything but the central path image (path_length -1 and -2), which ObjectHandler accumulates and fades over the
+* frames: the renderer keeps its own path image for this and thus has to be fed the frames in order, starting with the first one recorded.
+* The paths of path_length -1 (drawn per object) are rebuilt as if they had been drawn into the central image, they thus don't vanish
+* together with their object.
+*/
+class OverlayRenderer
+{
+public:
+	OverlayRenderer();
+
+	/** forgets the accumulated paths (to start rendering at another frame) */
+	void reset();
+
+	/** renders the next frame: draws _overlay into a colour copy of _original */
+	void render( const Mat& _original, const FrameOverlay& _overlay, Mat& _annotated );
+
+	/** renders the frames _first to _last of _archive (frames recorded with their edited version are taken as they are) and writes them into
+	* the video file _file, returns the number of frames written */
+	unsigned long exportVideo( const FrameArchive& _archive, const string& _file, double _frameRate, int _fourcc=CV_FOURCC('H','F','Y','U'), unsigned long _first=0, unsigned long _last=ULONG_MAX );
+
+	static void setupOptions();
+
+private:
+	Mat pPathImage;
+	int pFramesSinceLastFade;
+
+	static int path_fadeout_speed;
+};
@@ -0,0 +1,169 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <ostream>
+#include "FrameScheduler.h"
+#include "Tracer.h"
+#include "boost/thread/mutex.hpp"
+
+using namespace std;
+
+/** measures the time spent in the different stages of the frame processing pipeline
+*
+* For every stage a rolling window of the last measurements is kept from which percentiles are calculated on demand. If the profiler is switched off
+* (the default, see runtime/profiling/activated), sections cost no more than a flag check.
+* Measurements may be recorded from several threads at once (see the pipelined mode of SceneHandler). The stage times of single frames and thus the
+* frames over budget are only collected between beginFrame() and endFrame(), which the SceneHandler only calls if frames are processed one at a time.
+* If a tracer is set and active, every section is additionally written to the trace as a span named after its stage.
+*/
+class Profiler
+{
+public:
+	/** the profiled stages, in the order they occur in the pipeline */
+	enum Stage
+	{
+		INITIAL_PROCESSING = 0,
+		PRE_PROCESS,
+		BUFFERING,
+		PRE_PROCESS_INTERN,
+		THRESHOLD,
+		OBJ_REGIONS,
+		ROI_PROPERTIES,
+		PREDICT_PROPERTIES,
+		MATCH_OBJECTS,
+		FIND_POTENTIAL_AREA_MATCHES,
+		LOCATE_MISSING_OBJECTS,
+		UPDATE_OBJECTS,
+		DRAW,
+		UPDATE_CLASSIFICATIONS,
+		FRAME_TOTAL, // the complete SceneHandler::pushFrame() call
+		NR_OF_STAGES
+	};
+
+	/** statistics over the current window of a stage [ms] */
+	struct StageStatistics
+	{
+		StageStatistics():count(0),mean(0),p50(0),p95(0),p99(0),max(0),allTimeMax(0){};
+
+		unsigned int count; // number of measurements in the window
+		double mean;
+		double p50;
+		double p95;
+		double p99;
+		double max; // maximum in the window
+		double allTimeMax; // maximum since the last reset
+	};
+
+	/** stage times of a frame whose total processing time exceeded the frame budget [ms] */
+	struct SlowFrame
+	{
+		double time; // time stamp of the frame as passed to SceneHandler::pushFrame() [ms]
+		double budget; // frame budget at the time of processing [ms]
+		vector<double> stageTimes; // indexed by Stage
+		Stage dominantStage; // the stage that took the longest (FRAME_TOTAL excluded)
+	};
+
+	/** measures the time between its construction and destruction (or stop()) and records it for the given stage */
+	class Section
+	{
+	public:
+		Section( Profiler& _profiler, Stage _stage );
+		~Section();
+
+		/** adds an argument to the span written to the trace (ignored if not tracing) */
+		void addArgument( const string& _name, double _value );
+		/** stops the measurement before the section goes out of scope */
+		void stop();
+	private:
+		Profiler* pProfiler;
+		Stage pStage;
+		double pStart;
+		vector< pair<string,double> > pArguments;
+	};
+
+	Profiler();
+
+	/** switches profiling on or off at runtime, measurements are kept */
+	void setActive( bool _active );
+	bool active() const;
+
+	/** sets the tracer the sections are additionally written to (NULL: no tracing) */
+	void setTracer( Tracer* _tracer );
+	/** returns true if a tracer is set and active */
+	bool tracing() const;
+
+	/** sets the number of measurements per stage from which statistics are calculated, resets the profiler */
+	void setWindowSize( unsigned int _size );
+
+	/** called at the beginning of each frame */
+	void beginFrame( double _frameTime );
+	/** called at the end of each frame with the time available per frame, records frames that exceeded it */
+	void endFrame( double _budget );
+
+	/** records a measurement [ms] for a stage */
+	void record( Stage _stage, double _duration );
+
+	/** statistics of the given stage */
+	StageStatistics statistics( Stage _stage ) const;
+
+	/** number of frames that exceeded their budget since the last reset */
+	unsigned int slowFrameCount() const;
+	/** copy of the last frames that exceeded their budget, the newest first */
+	deque<SlowFrame> slowFrames() const;
+
+	/** writes a table with the statistics of all stages */
+	void report( ostream& _out ) const;
+
+	/** deletes all measurements */
+	void reset();
+
+	static string stageName( Stage _stage );
+
+	/** current time of the monotonic clock [ms] */
+	static inline double now(){ return FrameScheduler::now(); };
+
+	static void setupOptions();
+private:
+	bool pActive;
+	unsigned int pWindowSize;
+	Tracer* pTracer;
+	mutable boost::mutex pMutex; // protects the measurements
+
+	vector< vector<double> > pSamples; // ring buffer with the last pWindowSize measurements per stage
+	vector<unsigned int> pNextSample; // next index to write to in the ring buffers
+	vector<unsigned int> pSampleCount; // number of valid entries in the ring buffers
+	vector<double> pAllTimeMax;
+
+	vector<double> pCurrentFrame; // stage times of the frame currently processed
+	double pCurrentFrameTime;
+	unsigned int pSlowFrameCount;
+	deque<SlowFrame> pSlowFrames;
+
+	static const unsigned int maxSlowFrames = 30; // number of slow frames kept
+
+	//temporary option variables
+	static bool profiling_activated;
+	static unsigned int profiling_window_size;
+};
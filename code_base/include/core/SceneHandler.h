@@ -21,14 +21,26 @@
 */
 #include "frame.h"
 #include <list>
+#include <deque>
 #include <cmath>
 
 #include "opencv2/highgui/highgui.hpp"
 #include "VideoBuffer.h"
+#include "AsyncCapture.h"
 #include "IPAlgorithm.h"
+#include "FilterChain.h"
 
 #include "average.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "FrameScheduler.h"
+#include "StreamContext.h"
 #include "objecthandler.h"
+#include "BoundedQueue.h"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/function.hpp"
 
 using namespace std;
 
@@ -60,17 +72,128 @@ class SceneHandler
 	// ***************************************************************************************************************
 	public:
 		bool operator<<( VideoCapture& _vc); //copies frame from video capture object to SceneHandler
+		bool operator<<( AsyncCapture& _capture ); // takes the next frame from the capture buffer, the deadline of the frame counts from the time it was grabbed
 		void pushFrame( Mat _frame, double _time ); // pushes frame into buffer, starts processing it
+		/** pushes a frame that arrived at _arrivalTime [ms, FrameScheduler::now() time base], e.g. the time it was grabbed from the camera: the frame deadline counts from then */
+		void pushFrame( Mat _frame, double _time, double _arrivalTime );
 
 		Mat last(); //returns last edited frame mat
 		Mat grey(); //return last edited grey mat
 		Mat resized( double _factor ); // returns a resized version of the image - very time consuming, no fit for real time applications
 		Mat operator>>( Mat& _frame); //copies last edited frame Mat to output Mat
 		double timeLeft(); // returns for real time applications how much time that is left [ms]
-        static inline double msTime(){ return 1000*((double)clock())/CLOCKS_PER_SEC; }; // calculates the actual time in ms
+        static inline double msTime(){ return FrameScheduler::now(); }; // calculates the actual (monotonic wall clock) time in ms
+
+		/** gives access to the deadline of the current frame and the budgets of the optional stages */
+		FrameScheduler& scheduler();
+
+		/** gives access to the per-stage timings of the processing pipeline (profiling is switched on through runtime/profiling/activated or profile().setActive()) */
+		Profiler& profile();
+
+		/** gives access to the timeline export of the frame processing (tracing is switched on through runtime/tracing/activated or tracer().start()) */
+		Tracer& tracer();
+
+		/** gives access to the state that belongs to the stream this scene processes (object ids, instantiated generic objects, classifiers) */
+		StreamContext& stream();
+
+		/** counts the memory currently used by the video buffer, the objects and the classifiers (periodic reports are switched on through runtime/memory/report_interval) */
+		MemoryReport memoryReport();
+		/** returns the counters of the disk writer that records the frames that don't fit into the video buffer (see runtime/buffer/record_input) */
+		SpillWriter::Statistics spillStatistics() const;
+		/** returns the counters of the compressed tier of the video buffer (see runtime/memory/max_compressed_ram_usage) */
+		VideoBuffer::CompressionStatistics compressionStatistics() const;
+
+		/** switches the pipelined processing on or off (see runtime/pipeline/activated)
+		*
+		* In pipelined mode pushFrame() only hands a copy of the frame over to the pipeline and returns as soon as there is room for it, the caller may
+		* thus reuse its buffer for the next frame right away. The preprocessing stacks,
+		* the detection (threshold, contours and moments) and the tracking (association, dynamics update, drawing and classification) then run on
+		* separate threads, connected by queues of runtime/pipeline/queue_length frames. The throughput thus approaches the cost of the slowest stage
+		* instead of the sum of all stages, while the frames are still tracked strictly in the order they were pushed.
+		* The results (last(), grey(), objects() etc.) lag behind the pushed frames: call flush() before accessing the objects or changing settings.
+		* The profiler's frame total then is the latency from pushFrame() to the end of the tracking, and the deadlines of the optional stages refer
+		* to the tracking stage alone. Switching the mode waits for all frames in the pipeline to be processed.
+		*/
+		void setPipelined( bool _pipelined );
+		bool pipelined() const;
+		/** sets the number of threads the detection runs on in pipelined mode (see runtime/pipeline/detection_threads)
+		*
+		* With more than one thread the detection of the following frames runs ahead in parallel, which lets the offline processing of recorded
+		* videos scale with the number of cores. The tracking still consumes the detections strictly in frame order. A running pipeline is restarted.
+		*/
+		void setDetectionThreads( unsigned int _threads );
+		unsigned int detectionThreads() const;
+		/** waits until all frames pushed so far have been processed completely, returns immediately if not pipelined */
+		void flush();
+		/** sets a function that is called with the number of each frame and its latency from pushFrame() to the end of the tracking [ms]
+		*
+		* In pipelined mode it is called on the tracking thread, before the frame counts as processed: all calls for the frames pushed so far
+		* have thus returned when flush() returns. Set it only while no frames are processed, an empty function removes it.
+		*/
+		void setFrameListener( boost::function<void( unsigned int _frame, double _latency )> _listener );
 
 	private:
 		double pTime; // last time a frame was loaded
+		StreamContext pStream;
+		Tracer pTracer;
+		Profiler pProfiler;
+		FrameScheduler pScheduler;
+
+		/** creates a memory report every memory_report_interval frames and prints it or appends it to memory_report_file */
+		void periodicMemoryReport( double _time );
+		static unsigned int memory_report_interval;
+		static string memory_report_file;
+
+		/** a frame on its way through the processing stages */
+		struct FrameJob
+		{
+			FrameJob( Mat _original, double _time, unsigned int _number );
+
+			Mat original;
+			double time; // time stamp as passed to pushFrame()
+			unsigned int number;
+			double arrival; // time the frame was pushed [ms, FrameScheduler::now() time base]
+			bool failed; // set if a stage failed, the remaining stages skip the frame
+
+			Frame frame; // original, edited and greyscale version
+			Rect calculationArea; // observation area at the time the frame was pushed, empty if the whole frame is used
+			Mat forCalculations; // preprocessed greyscale image the objects are detected in
+			ObjectHandler::Detection detection;
+		};
+
+		/** preprocessing stage: initial processing, preprocessing stack, greyscale conversion, observation area and intern preprocessing stack, marks the job as failed if the frame cannot be ingested */
+		void prepareFrame( FrameJob& _job );
+		/** last stage: buffering and tracking */
+		void finishFrame( FrameJob& _job );
+		/** returns an empty frame whose spare buffers are those of a frame that isn't current anymore (only used if buffering is deactivated) */
+		Frame recycledFrame();
+
+		void startPipeline();
+		/** waits for all frames in the pipeline to be processed and joins the stage threads */
+		void stopPipeline();
+		void preProcessThread();
+		/** detection stage, runs on pDetectionThreads threads: the frames may leave it out of order */
+		void detectionThread();
+		/** last stage, restores the frame order */
+		void trackingThread();
+
+		bool pPipelined;
+		unsigned int pSubmittedFrames; // frames pushed into the pipeline
+		unsigned int pFrameCount; // number of frames completely processed so far
+		BoundedQueue< Ptr<FrameJob> > pPreProcessQueue;
+		BoundedQueue< Ptr<FrameJob> > pDetectionQueue;
+		BoundedQueue< Ptr<FrameJob> > pTrackingQueue;
+		boost::thread pPreProcessWorker;
+		Ptr<boost::thread_group> pDetectionWorkers; // a group of its own per pipeline start: join_all() doesn't remove the finished threads
+		unsigned int pDetectionThreads;
+		boost::thread pTrackingWorker;
+		boost::mutex pProgressMutex; // protects pFrameCount
+		boost::function<void( unsigned int, double )> pFrameListener;
+		boost::condition_variable pFrameFinished;
+		mutable boost::mutex pResultMutex; // protects the video buffer, the working frame and the filter images against concurrent access by the tracking thread
+		static bool pipeline_activated;
+		static unsigned int pipeline_queue_length;
+		static unsigned int pipeline_detection_threads;
 
 
 	// general video settings etc
@@ -79,6 +202,7 @@ class SceneHandler
 		double getFrameRate() const;
 		void setFrameRate( double& _newRate );
 		void setFrameRate( VideoCapture& _vc ); //sets the SceneHandler frame rate to the same frame rate as _vc has
+		void setFrameRate( const AsyncCapture& _capture );
 
 
 	// [BUFFER] video frame saving and loading to and from buffer functions and variables
@@ -96,14 +220,26 @@ class SceneHandler
 		VideoBuffer pVideo;// video data
 		double pFrameRate; // frames per second
 		static bool buffering_activated;
-		Mat pWorkingFrame; // only used if buffering is deactivated
+		Frame pWorkingFrame; // the current frame, only used if buffering is deactivated: no frame history is kept then and the memory used for frames stays constant
+		deque<Frame> pFreeFrames; // frames that were current before, their buffers are recycled for the following frames (see recycledFrame())
 
 
 	// [GENERAL IMAGE CONVERSION]
 	// ***************************************************************************************************************
-	/* currently not used: would affect original and edited version */
+	/* affects original and edited version */
 	private:
+		/** reduces the image to a single channel if monochrome ingest is set and maps images with more than 8 bits per channel to 8 bits (window/level, see runtime/ingest)
+		*	@return false if the image couldn't be reduced to 8 bits (empty ingest window): the frame has to be skipped
+		*/
 		bool initialProcessing( Mat& _image );
+		bool pIngestFailureReported; // an empty ingest window is only reported once until frames are ingested again
+
+		/** the white point of an image of the given depth */
+		static double depthMaximum( int _depth );
+
+		static bool monochrome_ingest;
+		static double ingest_window_low;
+		static double ingest_window_high;
 
 
 	// [PREPROCESSING] video frame preprocessing functions and variables
@@ -114,6 +250,9 @@ class SceneHandler
 
 		/** applies all activated algorithms to the image in their order */
 		bool preProcessIntern( Mat& _image );
+
+		/** returns true if at least one algorithm of the stack is activated */
+		static bool stackActive( const list< Ptr<IPAlgorithm> >& _stack );
 	public:
 		/** returns deque with the names of the algorithms currently activated on the preprocessing stack */
 		list<string> preProcessStackInfo();
@@ -155,13 +294,15 @@ class SceneHandler
 		void moveInternPreProcessAlgorithmDown( int _idx );
 
 
-		/** returns the preProcessImage */
-		const Mat& preProcessImage();
-		/** returns the preThresholdImage */
-		const Mat& preThresholdImage();
+		/** returns the preProcessImage (a handle to the image of the last preprocessed frame, it is not written to anymore) */
+		Mat preProcessImage();
+		/** returns the preThresholdImage (a handle to the image of the last preprocessed frame, it is not written to anymore) */
+		Mat preThresholdImage();
 	private:
 		list< Ptr<IPAlgorithm> > pPreProcessStack;
 		list< Ptr<IPAlgorithm> > pInternPreProcessStack;
+		FilterChain pPreProcessChain; // applies pPreProcessStack, with the combined look up tables of its point-wise filters
+		FilterChain pInternPreProcessChain;
 		// image output buffers (for information purposes only) - they're set only if set so in options
 		Mat pPreProcessImage, pPreThresholdImage;
 		//temporary for preprocess image buffering options
@@ -183,7 +324,12 @@ class SceneHandler
 		void typesNotInScene( string _name1, string _name2="", string _name3="", string _name4="", string _name5="", string _name6="", string _name7="", string _name8="" );
 		
 
-		/** set the area inside the video frames in which objects shall be detected */
+		/** set the area inside the video frames in which objects shall be detected
+		*
+		* With runtime/observation_area/crop_early the frames are cropped to the area right after the initial processing: the preprocessing stacks,
+		* the greyscale extraction, the buffer and the output then only cover the area, so the cost scales with the observed area instead of the
+		* sensor size. The buffered original keeps the whole frame if runtime/observation_area/buffer_full_frame is set.
+		*/
 		void setObservationArea( int _upperLeftX, int _upperLeftY, int _width, int _height );
 
 		const Rect& getObservationArea();
@@ -198,6 +344,11 @@ class SceneHandler
 		ObjectHandler pObjectSet;
 
 		Rect pObservationArea; // area in the image in which objects shall be detected - if not set, then the whole area is being searched
+
+		/** the observation area limited to a frame of the given size, empty if none is set or if it lies outside the frame */
+		Rect clippedObservationArea( Size _frameSize ) const;
+		static bool observation_area_crop_early;
+		static bool observation_area_buffer_full_frame;
 		
 		// temporary
 		static bool draw_observation_area;
@@ -0,0 +1,106 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include <deque>
+#include <string>
+#include "opencv2/core/core.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "SceneHandler.h"
+
+using namespace std;
+using namespace cv;
+
+/** processes several video streams (e.g. one per camera), each with a SceneHandler of its own, on one shared set of worker threads
+*
+* The frames of a stream are processed in the order they were pushed and never by two workers at the same time, while different streams run
+* in parallel. The number of workers thus is independent of the number of streams, instead of every stream running a pipeline of its own.
+* Everything a stream changes is kept in its SceneHandler and its StreamContext; the class definitions and the trained classifiers are loaded
+* once and shared read-only. Streams that are configured alike (same types in the scene) use the very same classifier instances.
+* Configure the scenes (types in scene, preprocessing, observation area) through scene() before frames are pushed, or after flush(): settings
+* that affect the object classes (e.g. their dynamics options) apply to the objects of all streams.
+*/
+class SceneHandlerPool
+{
+public:
+	/** starts the workers, _workers=0: as set in runtime/pool/workers */
+	SceneHandlerPool( unsigned int _workers=0 );
+	/** processes the frames that are still waiting and stops the workers */
+	~SceneHandlerPool();
+
+	/** adds a stream with a SceneHandler of its own, returns the index of the stream. Add the streams before frames are pushed: setting up the
+	* SceneHandler reloads options the workers read */
+	unsigned int addStream( const string& _name, double _frameRate=SceneHandler::standardFrameRate );
+	unsigned int streamCount() const;
+
+	/** the SceneHandler of a stream: only access it while the stream is flushed */
+	SceneHandler& scene( unsigned int _stream );
+
+	/** hands a copy of a frame of a stream over to the workers, waits while runtime/pool/queue_length frames of the stream are waiting already */
+	void pushFrame( unsigned int _stream, Mat _frame, double _time );
+
+	/** waits until all frames pushed to the stream so far have been processed */
+	void flush( unsigned int _stream );
+	/** waits until all frames pushed so far have been processed */
+	void flush();
+
+	unsigned int workerCount() const;
+
+	static void setupOptions();
+private:
+	/** a frame waiting to be processed */
+	struct PendingFrame
+	{
+		Mat image;
+		double time; // time stamp as passed to pushFrame()
+		double arrival; // time the frame was pushed [ms, FrameScheduler::now() time base]
+	};
+
+	struct Stream
+	{
+		Stream():busy(false),pushed(0),processed(0){};
+
+		Ptr<SceneHandler> scene;
+		deque<PendingFrame> frames; // frames waiting to be processed
+		bool busy; // a worker is processing a frame of the stream
+		unsigned long pushed;
+		unsigned long processed;
+	};
+
+	vector< Ptr<Stream> > pStreams;
+	deque<unsigned int> pReady; // streams with waiting frames that no worker is busy with
+	bool pStopping;
+
+	mutable boost::mutex pMutex; // protects everything but the scenes
+	boost::condition_variable pWorkAvailable;
+	boost::condition_variable pProgress; // a frame was taken or finished
+	boost::thread_group pWorkers;
+	unsigned int pWorkerCount;
+
+	void workerThread();
+
+	//temporary option variables
+	static unsigned int pool_workers;
+	static unsigned int pool_queue_length;
+};
@@ -0,0 +1,114 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+#include "frame.h"
+#include "FrameArchive.h"
+#include "ThumbnailArchive.h"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** writes the frames the VideoBuffer can't keep in memory to a FrameArchive on the hard disk on a thread of its own
+*
+* Writing the frames took several hundred milliseconds per dump when it was done in the processing thread. The frames are now queued and
+* written by the writer thread, pushing a frame only copies its headers. If the queue is full, push() either waits for the writer (no frame
+* is lost, the processing thread is slowed down to the speed of the disk) or drops the frame, as set in runtime/buffer/spill_drop.
+* All frames that were handed over can be read back through load(), whether they are still queued or already in the archive.
+* In object-centric mode the frames go into a ThumbnailArchive instead, the archived frames are then reassembled from their thumbnails.
+*/
+class SpillWriter
+{
+public:
+	/** counters since the writer was created */
+	struct Statistics
+	{
+		Statistics():queued(0),written(0),dropped(0),waits(0),waitTime(0),maxQueueLength(0),bytes(0),files(0){};
+
+		unsigned long queued; // frames accepted by push()
+		unsigned long written; // frames written to the archive
+		unsigned long dropped; // frames dropped because the queue was full or the archive couldn't be written
+		unsigned long waits; // number of times push() had to wait for room in the queue
+		double waitTime; // total time push() waited [ms]
+		unsigned int maxQueueLength;
+		size_t bytes; // size of the archive files
+		unsigned int files;
+	};
+
+	/** the archive is written to _folder/_baseName(.mfa and .mfi, and .mti for a ThumbnailArchive if _objectCentric is set), queue length
+	* and drop policy are taken from runtime/buffer */
+	SpillWriter( const string& _folder, const string& _baseName, bool _objectCentric=false );
+	/** writes the queued frames and closes the archive */
+	~SpillWriter();
+
+	/** queues a frame for writing, returns false if it was dropped */
+	bool push( const Frame& _frame );
+	/** stops the writer thread, the queued frames are written first if _writeQueued is true and discarded otherwise */
+	void close( bool _writeQueued=true );
+
+	/** number of frames that can be loaded */
+	unsigned long size() const;
+	/** loads frame i, i=0: the frame pushed last. Returns false if there is no such frame */
+	bool load( unsigned long _i, Frame& _frame ) const;
+	/** returns the number (as used by load()) of the newest frame whose time stamp isn't later than _time, -1 if there is none */
+	long find( double _time ) const;
+
+	Statistics statistics() const;
+	/** the thumbnail archive the frames are written to in object-centric mode (for per-object clips), NULL otherwise */
+	const ThumbnailArchive* thumbnails() const;
+	/** paths of all files written so far */
+	vector<string> files() const;
+	/** adds the memory of the queued frames whose buffers haven't been counted yet */
+	size_t queuedMemUsage( set<const uchar*>& _counted ) const;
+
+	static void setupOptions();
+private:
+	string pFolder;
+	string pBaseName;
+	unsigned int pQueueLength;
+	bool pDropping;
+	bool pObjectCentric;
+
+	deque<Frame> pQueue; // newest frame at the back
+	deque<Frame> pWriting; // the frame the writer thread is writing at the moment, if any
+	Statistics pStatistics;
+	bool pRunning;
+	FrameArchive pArchive;
+	ThumbnailArchive pThumbnails; // used instead of pArchive in object-centric mode
+
+	mutable boost::mutex pMutex; // protects the queues, the statistics and pRunning
+	boost::condition_variable pFrameAvailable;
+	boost::condition_variable pRoomAvailable;
+	boost::thread pWorker;
+
+	void writerThread();
+
+	//temporary option variables
+	static unsigned int spill_queue_length;
+	static bool spill_drop;
+};
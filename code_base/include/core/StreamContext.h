@@ -0,0 +1,81 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <list>
+#include <vector>
+#include <string>
+#include "opencv2/core/core.hpp"
+#include "opencv2/ml/ml.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/function.hpp"
+
+using namespace cv;
+using namespace std;
+
+class GenericObject;
+
+/** state that belongs to a single video stream
+*
+* Several SceneHandlers may process different streams within one process at the same time (see SceneHandlerPool). Everything the processing
+* of a stream changes is kept either in its SceneHandler or here: the object ids, the objects instantiated per generic class and the classifiers
+* chosen for the types in the scene. The class definitions, the options and the trained classifiers themselves are shared by all streams and
+* are only read while frames are processed (streams with the same types in the scene share the same classifier instances).
+*/
+class StreamContext
+{
+public:
+	StreamContext( const string& _name="" );
+	~StreamContext();
+
+	const string& name() const;
+	void setName( const string& _name );
+
+	/** returns a new object id, unique within the stream */
+	unsigned int nextObjectId();
+	/** number of object ids handed out so far */
+	unsigned int objectCount() const;
+	void resetObjectCount();
+
+	/** the objects of the stream that are currently instantiated for the generic class, only use the list while genericObjectsMutex() is locked */
+	list< Ptr<GenericObject> >& genericObjects( unsigned int _genericClassId );
+	/** guards the generic object lists of the stream: they are changed by the tracking thread of the stream while class wide changes iterate them from other threads */
+	boost::mutex& genericObjectsMutex();
+	/** the classifier used for the generic class in this stream (NULL if the class isn't initialized) */
+	Ptr<CvBoost>& classifier( unsigned int _genericClassId );
+	const vector< Ptr<CvBoost> >& classifiers() const;
+
+	/** calls _visit for every stream that currently exists, used to apply class wide changes (e.g. the dynamics options of a class) to the objects
+	* of every stream. The streams can't be destroyed meanwhile: _visit mustn't create or destroy streams itself */
+	static void forEachStream( boost::function<void(StreamContext&)> _visit );
+private:
+	StreamContext( const StreamContext& );
+	StreamContext& operator=( const StreamContext& );
+
+	string pName;
+	unsigned int pObjectCount;
+	vector< list< Ptr<GenericObject> > > pGenericObjects; // index equivalent to generic class id
+	boost::mutex pGenericObjectsMutex;
+	vector< Ptr<CvBoost> > pClassifiers; // index equivalent to generic class id
+
+	static list<StreamContext*> pStreams;
+	static boost::mutex pStreamsMutex;
+};
@@ -0,0 +1,138 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include "frame.h"
+#include "FrameArchive.h"
+#include "boost/cstdint.hpp"
+#include "boost/thread/mutex.hpp"
+
+using namespace std;
+using namespace cv;
+
+/** object-centric archive: records per frame only the thumbnails of the tracked objects and now and then the whole frame as background
+*
+* For each frame the area of every tracked object (Frame::objectRegions(), extended by thumbnail_margin) is cut out of the original and
+* stored with the track id of the object and the time stamp of the frame, every keyframe_interval-th frame the whole original is stored as
+* background keyframe as well. If the objects only cover a small part of the frames, this takes a fraction of the space full frames take.
+* The images are kept in a FrameArchive (<path>.mfa and .mfi), <path>.mti indexes them: one entry per frame followed by one entry per
+* thumbnail of the frame. load() reassembles an approximate frame (the last keyframe with the thumbnails of the frame pasted in), clip()
+* returns all thumbnails of one object without touching any other image.
+* Appending and reading may take place on different threads.
+*/
+class ThumbnailArchive
+{
+public:
+	static const boost::uint32_t formatVersion = 1;
+	static const boost::uint64_t noImage = (boost::uint64_t)-1;
+
+	enum Kind
+	{
+		FRAME = 0, // a recorded frame, with the background keyframe as image if one was stored
+		OBJECT // thumbnail of an object in the frame before
+	};
+
+	/** index entry of a frame or a thumbnail */
+	struct IndexEntry
+	{
+		boost::uint64_t frame; // number of the frame, 0: the first one appended
+		boost::uint64_t image; // number of the image in the FrameArchive, noImage if there is none
+		double time; // time stamp of the frame [ms]
+		boost::int32_t objectId; // track id of the object, -1 for frames
+		boost::uint32_t kind;
+		boost::int32_t x, y, width, height; // area of the image in the frame, the whole frame for frames
+		boost::int32_t type; // type of the frame
+		boost::uint32_t reserved;
+	};
+
+	/** thumbnail of an object */
+	struct Thumbnail
+	{
+		Mat image;
+		Rect area; // area in the frame
+		double time;
+		unsigned long frame;
+	};
+
+	ThumbnailArchive();
+	~ThumbnailArchive();
+
+	/** creates a new archive, existing files are overwritten */
+	bool create( const string& _path );
+	/** opens an existing archive, further frames are appended if _append is true */
+	bool open( const string& _path, bool _append=false );
+	void close();
+
+	/** records the thumbnails of the objects in the frame, and the background if a keyframe is due. Returns false if it couldn't be written */
+	bool append( Frame& _frame );
+
+	/** number of frames in the archive */
+	unsigned long size() const;
+	/** reassembles frame i (i=0: the first frame appended): the last keyframe up to it with its thumbnails pasted in (the areas of the objects
+	* are attached as object regions), black where no keyframe exists. Returns false if there is no such frame */
+	bool load( unsigned long _i, Frame& _frame ) const;
+	/** returns the number of the last frame whose time stamp isn't later than _time, -1 if there is none */
+	long find( double _time ) const;
+
+	/** track ids of the objects that have thumbnails in the archive */
+	vector<int> objects() const;
+	/** loads all thumbnails of the object, oldest first, returns false if the object has none */
+	bool clip( int _objectId, vector<Thumbnail>& _clip ) const;
+
+	/** size of all files in bytes */
+	size_t bytes() const;
+	/** paths of all files of the archive */
+	vector<string> files() const;
+	string indexFile() const;
+
+	static void setupOptions();
+
+private:
+	string pPath;
+	FrameArchive pImages;
+	ofstream pIndexOut;
+	bool pWritable;
+	vector<IndexEntry> pIndex;
+	vector<unsigned long> pFrames; // index entry of each frame
+	vector<unsigned long> pKeyframes; // index entries of the frames that have a keyframe
+	map< int, vector<unsigned long> > pObjects; // index entries of the thumbnails of each object
+
+	// writer state
+	Size pKeyframeSize;
+	int pKeyframeType;
+	unsigned int pFramesSinceKeyframe;
+
+	mutable boost::mutex pMutex; // protects the index and the lookup tables
+
+	/** adds an entry to the index and the lookup tables */
+	void addToIndex( const IndexEntry& _entry );
+	static FrameArchive::Header header();
+	/** loads the image of an entry */
+	bool loadImage( const IndexEntry& _entry, Mat& _image ) const;
+
+	//temporary option variables
+	static int thumbnail_margin;
+	static unsigned int keyframe_interval;
+};
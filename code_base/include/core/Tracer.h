@@ -0,0 +1,106 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+#include "FrameScheduler.h"
+
+using namespace std;
+
+/** writes a timeline of the frame processing to a file in the Chrome trace event format (JSON array), which can be loaded into chrome://tracing or the Perfetto UI
+*
+* Spans ("complete" events) are nested by the viewer according to their start time and duration, counters are displayed as graphs. Events of
+* different threads are shown in separate rows, the threads can be given readable names with setThreadName(). The file is written while tracing
+* is running and the closing bracket is only added by stop(): both viewers load files of runs that were aborted nonetheless.
+* The tracer may be used from several threads at the same time. If it is not active (see runtime/tracing/activated), spans cost no more than a flag check.
+*/
+class Tracer
+{
+public:
+	/** traces the time between its construction and destruction (or stop()) as a span with the given name */
+	class Span
+	{
+	public:
+		Span( Tracer& _tracer, const string& _name );
+		Span( Tracer& _tracer, const string& _name, const string& _argName, double _argValue );
+		~Span();
+
+		/** adds an argument that is shown with the span in the viewer */
+		void addArgument( const string& _name, double _value );
+		/** ends the span before it goes out of scope */
+		void stop();
+	private:
+		Tracer* pTracer;
+		string pName;
+		double pStart;
+		vector< pair<string,double> > pArguments;
+	};
+
+	Tracer();
+	~Tracer();
+
+	/** starts writing a new trace to the given file, returns false if the file couldn't be opened */
+	bool start( const string& _file );
+	/** finishes the trace file */
+	void stop();
+	bool active() const;
+
+	/** writes a span that started at _start [ms, FrameScheduler::now() time base] and lasted _duration [ms] */
+	void complete( const string& _name, double _start, double _duration, const vector< pair<string,double> >& _arguments=vector< pair<string,double> >() );
+	/** writes a span that doesn't belong to a single thread, like a frame passing through the stages of a pipeline: such spans are shown in a row
+	* of their own and may overlap if their ids differ */
+	void asyncSpan( const string& _name, unsigned int _id, double _start, double _duration, const vector< pair<string,double> >& _arguments=vector< pair<string,double> >() );
+	/** writes the values of a counter, each argument is shown as a separate series of the counter's graph */
+	void counter( const string& _name, const vector< pair<string,double> >& _values );
+	void counter( const string& _name, double _value );
+	/** writes a single point in time */
+	void instant( const string& _name );
+
+	/** sets the name under which the calling thread is shown */
+	void setThreadName( const string& _name );
+
+	static void setupOptions();
+private:
+	ofstream pFile;
+	bool pActive;
+	bool pFirstEvent;
+	double pOrigin; // time of the start of the trace [ms, FrameScheduler::now() time base]
+
+	boost::mutex pMutex; // protects the file and the thread ids
+	map<boost::thread::id,int> pThreadIds; // small consecutive ids for the threads, the viewer sorts them in this order
+
+	/** returns the id of the calling thread, pMutex has to be locked */
+	int threadId();
+	/** writes the beginning of an event up to the arguments, pMutex has to be locked */
+	void beginEvent( const string& _name, char _phase, double _time );
+	void writeArguments( const vector< pair<string,double> >& _arguments );
+
+	static string escape( const string& _text );
+
+	//temporary option variables
+	static bool tracing_activated;
+	static string tracing_file;
+};
@@ -22,13 +22,40 @@
 
 
 #include "CompressedFrame.h"
+#include "FrameScheduler.h"
+#include "MemoryReport.h"
+#include "SpillWriter.h"
+#include "BoundedQueue.h"
 #include "opencv2/core/core.hpp"
 #include <deque>
+#include <vector>
 #include "Options.h"
 #include "boost/filesystem.hpp"
 #include <ctime>
 #include <stack>
-
+#include <list>
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+/** keeps the last frames in memory and hands the older ones to a SpillWriter, which writes them to a FrameArchive on the hard disk, if record_input is set
+*
+* The frames are held in a ring of frame slots whose number is given by max_video_ram_usage and the size of the frames. An incoming frame is
+* copied into the slot of the oldest one, whose buffers are reused: once the ring has been filled, buffering doesn't allocate memory anymore.
+* A slot whose images are still referenced elsewhere (e.g. an image returned by load() that is still displayed) gets new buffers instead of
+* being overwritten.
+*
+* If max_compressed_ram_usage is set (and record_input isn't), the frames that leave the ring are compressed by a pool of compression threads
+* into a second, compressed tier with a budget of its own, which can hold a much longer history. load() decodes them transparently: the
+* numbering continues from the ring into the compressed tier. If the compression threads can't keep up, the frames leaving the ring are
+* dropped instead of slowing down the processing: they keep their place in the numbering, but can't be loaded (see compressionStatistics()).
+*
+* Recorded frames stay accessible through load() as well, the numbering then continues from the ring into the frames handed to the SpillWriter
+* and its archive (a random access read of the memory mapped archive file, not a video decode). With record_overlay only the original frames
+* are recorded together with the FrameOverlay of the annotations, the archived frames then get their edited version rendered when loaded.
+* With record_thumbnails only the areas of the tracked objects and a background keyframe now and then are recorded (see ThumbnailArchive),
+* the archived frames are then reassembled approximately.
+*/
 class VideoBuffer
 {
 public:
@@ -49,10 +76,11 @@ public:
 	bool operator>>( Mat& _image );
 	/** loads greyscale image */
 	Mat& grey();
-	/** load oldest frame from buffer (and extract it) - currently only from buffer, not the temporary files */
+	/** load oldest frame from buffer (and extract it) - currently only from the uncompressed buffer, not from the compressed tier or the archive */
 	Frame loadOldest();
 	/** load frame i from buffer, i=0: newest, i=1: second newest
-	* @return	the frame, throws an exception if the number was invalid or the frame not accessible in the buffer
+	* @return	the frame, throws an exception if the number was invalid or the frame not accessible in the buffer. A frame from the
+	*			compressed tier or the archive is decoded into a frame that is kept until the next such frame is loaded
 	*/
 	Frame& load( unsigned int _i=0 );
 	/** variant of load */
@@ -66,29 +94,96 @@ public:
 
 	/** returns the number of buffered frames */
 	unsigned int buffSize() const;
+	/** returns the number (as used by load()) of the newest frame whose time stamp isn't later than _time, -1 if there is none */
+	long find( double _time ) const;
+
+	/** sets the scheduler that is asked whether dumping frames to the hard disk still fits into the current frame (NULL: always dump immediately) */
+	void setScheduler( FrameScheduler* _scheduler );
+
+	/** adds the memory used by the buffered frames and the frames waiting to be written and the size of the temporary files to the report */
+	void memoryReport( MemoryReport& _report ) const;
+	/** returns the counters of the disk writer (all zero if nothing was written yet) */
+	SpillWriter::Statistics spillStatistics() const;
+
+	/** counters of the compressed tier */
+	struct CompressionStatistics
+	{
+		CompressionStatistics():queued(0),compressed(0),dropped(0){};
+
+		unsigned long queued; // frames handed to the compression threads
+		unsigned long compressed; // frames whose compression is complete
+		unsigned long dropped; // frames that left the ring while all compression threads were busy
+	};
+	/** returns the counters of the compressed tier (all zero if it isn't active) */
+	CompressionStatistics compressionStatistics() const;
+
+	/** the archive of the recorded object thumbnails (see record_thumbnails) for per-object review, NULL if there is none (yet) */
+	const ThumbnailArchive* thumbnails() const;
+
+	/** true if the frames are recorded as original plus FrameOverlay: the annotations drawn into the frames are to be recorded into one then */
+	static bool recordsOverlay();
+	/** true if only the object thumbnails are recorded: the frames need their object regions attached then */
+	static bool recordsThumbnails();
 
 	// option setup
 	static bool setupOptions();
 
 private:
-	std::deque<Frame> pUBuffer; //uncompressed frames
-	std::stack<std::string> tmpFilesO;
-	std::stack<std::string> tmpFilesE;
+	std::vector<Frame> pUBuffer; //uncompressed frames: ring of frame slots
+	unsigned int pNewest; // slot of the newest frame
+	unsigned int pUBufferCount; // nr of frames in the ring
 
 	unsigned int pFrameCnt;
-	std::list<CompressedFrame> pCBuffer; //compressed frames
+	// compressed tier
+	struct CompressionJob
+	{
+		Frame frame;
+		Ptr<CompressedFrame> target;
+	};
+	std::list< Ptr<CompressedFrame> > pCBuffer; //compressed frames, newest first (an entry exists as soon as its frame left the ring, see CompressedFrame::pComplete)
+	size_t pCBufferBytes; // memory used by the complete entries of pCBuffer
+	BoundedQueue<CompressionJob> pCompressionQueue;
+	boost::thread_group pCompressionWorkers;
+	std::list<Frame> pSpareFrames; // frames the compression threads are done with, their buffers are reused for the ring slots
+	CompressionStatistics pCompressionStatistics;
+	mutable Frame pDecoded; // the frame loaded last from the compressed tier or the archive
+	mutable boost::mutex pCompressionMutex; // protects the compressed tier, the spare frames and pDecoded
+	mutable boost::condition_variable pCompressionDone;
 	std::string pMemoryBufferPath; //temp filename and path in which additional frames are stored on hard disk
 
-	unsigned int buffCnt;
 	std::string tempVideoFileName;
 	std::string tempVideoFileFolder; //protection against a possible temp folder change in the options during runtime
 
+	FrameScheduler* pScheduler;
+	SpillWriter* pSpillWriter; // created when the first frames are dumped
+
+	/** returns the slot of frame i, i=0: newest */
+	Frame& slot( unsigned int _i );
+	const Frame& slot( unsigned int _i ) const;
+	/** resizes the ring if frames of the given size need another number of slots, the newest frames are kept */
+	void fitCapacity( unsigned int _frameSize );
+	/** hands the oldest frames to the disk writer until the buffer uses no more than 3/4 of max_video_ram_usage */
+	void spill( unsigned int _frameSize );
+	/** true if frames leaving the ring go into the compressed tier */
+	bool compressedTierActive() const;
+	/** queues the frame of the slot for compression and gives the slot the buffers of a spare frame instead */
+	void compress( Frame& _slot );
+	void compressionThread();
+	/** loads frame i behind the ring (counting the compressed tier first, then the recorded frames) into pDecoded, waits if it is still
+	* being compressed. Returns false if there is no such frame or it was dropped */
+	bool loadStored( unsigned int _i ) const;
+
 	std::string tempFileName(); //creates and/or returns new tempFileName
 	std::string tempFileFolder(); // returns temp file folder
 
 	//option variables
 	static unsigned int max_video_ram_usage;
+	static size_t max_compressed_ram_usage;
+	static unsigned int compression_threads;
 	static bool record_input;
+	static bool record_overlay;
+	static bool record_thumbnails;
+	static bool keep_archive;
 	static std::string temporary_folder_path;
 };
 
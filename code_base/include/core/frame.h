@@ -23,16 +23,27 @@
 #pragma once
 
 #include <list>
+#include <set>
+#include <vector>
 #include "opencv2/core/core.hpp"
+#include "FrameOverlay.h"
 
 using namespace cv;
 
 class Frame
 {
 public:
+	/** area a tracked object covers in the frame */
+	struct ObjectRegion
+	{
+		int id;
+		Rect area;
+	};
+
 	Frame(void);
+	/** the edited version shares the data of the original until editableEdited() is called */
 	Frame(Mat _original, double _time);
-	//assumes that _edited is already an independent version
+	/** _edited may share its data with _original (if it wasn't edited), editableEdited() then makes it independent before it is written to */
 	Frame(Mat _original, Mat _edited, double _time);
 
 	~Frame(void);
@@ -41,17 +52,71 @@ public:
 	Mat& edited();
 	Mat& grey();
 	double time() const;
+
+	/** returns the edited version after making sure it doesn't share its data with the original or the greyscale version (copy on write) */
+	Mat& editableEdited();
+	/** returns the edited version ready to be drawn into in colour: a single channel version is converted to BGR (the greyscale version keeps the single channel data), otherwise the same as editableEdited() */
+	Mat& annotatableEdited();
+	/** returns the greyscale version after making sure it doesn't share its data with the original or the edited version (copy on write) */
+	Mat& editableGrey();
 	
 
+	/** copies the images and the time stamp of _frame into this frame. The buffers of this frame are written into instead of allocating new
+	* ones as long as their size and type fit and no other Mat refers to them anymore (a frame slot that is recycled this way thus doesn't
+	* allocate any memory). Data that is shared between the versions of _frame stays shared in the copy.
+	*/
+	void assign( const Frame& _frame );
+
+	/** empties the frame but keeps the buffers it allocated itself (greyscale version, copies of the edited version) as spares: the greyscale
+	* extraction of set(), spareCopy() and the copies on write use them instead of allocating new ones as long as their size and type fit and
+	* no other Mat refers to them anymore. Recycling the frames of a stream thus keeps it from allocating memory per frame.
+	*/
+	void recycle();
+	/** sets the contents of the frame like the constructor does */
+	void set( Mat _original, Mat _edited, double _time );
+	/** returns a copy of _image in one of the spare buffers of the frame (see recycle()), in a new buffer if none fits */
+	Mat spareCopy( const Mat& _image );
+
+	/** attaches the annotations drawn into the edited version as a list of primitives (shared, not changed anymore once attached): a frame
+	* with an overlay is recorded without its edited version, which is rendered from the original and the overlay when it is loaded again
+	*/
+	void setOverlay( Ptr<FrameOverlay> _overlay );
+	/** returns the overlay, an empty pointer if none was attached */
+	Ptr<FrameOverlay> overlay() const;
+
+	/** attaches the areas of the objects tracked in the frame (in coordinates of the original version), they are needed to record only the
+	* object thumbnails of the frame (see ThumbnailArchive) */
+	void setObjectRegions( const std::vector<ObjectRegion>& _regions );
+	const std::vector<ObjectRegion>& objectRegions() const;
+
 	/** returns the used memory in bytes
 	*/
 	int memUsage() const;
 
+	/** returns the memory used by the image buffers in bytes, buffers whose address is already in _counted are skipped (and the counted ones are added)
+	*/
+	size_t memUsage( std::set<const uchar*>& _counted ) const;
+
 private:
 	Mat pOriginal;
 	Mat pEdited;
-	Mat pGreyscale;
+	Mat pGreyscale; // first channel of the edited version, a view of it if the edited version has a single channel
+
+	std::vector<Mat> pSpares; // buffers of earlier contents of the frame that take new copies, see recycle()
+	static const unsigned int maxSpares = 4;
+
+	/** extracts the first channel of the edited version */
+	void extractGrey();
+
+	/** returns one of the _spares that is of the given size and type and isn't referenced anywhere else (it is removed from _spares then), a new buffer otherwise */
+	static Mat takeSpare( Size _size, int _type, std::vector<Mat>& _spares );
+	/** copies _source into one of the _spares (see takeSpare()) */
+	static Mat copyToSpare( const Mat& _source, std::vector<Mat>& _spares );
+	/** if _view lies in the buffer of _base, _copy is set to the corresponding area of _baseCopy and true is returned */
+	static bool sharedView( const Mat& _view, const Mat& _base, const Mat& _baseCopy, Mat& _copy );
 
 	double pTime; //ms
+	Ptr<FrameOverlay> pOverlay;
+	std::vector<ObjectRegion> pObjectRegions;
 };
 
@@ -26,6 +26,7 @@
 
 class SceneHandler;
 class GenericObject;
+class StreamContext;
 
 class ObjectHandler
 {
@@ -43,6 +44,21 @@ public:
 	/** loads settings as created with 'saveSettings' from GMLM */
 	void loadFromMap( GenericMultiLevelMap<string>& _map );
 
+	/** result of the detection stage for one frame */
+	struct Detection
+	{
+		Mat grey; // image the detection ran on
+		vector<Mat> pyramid; // grey at level 0 and successively halved versions of it, built once per frame. Thresholding and contour search run on the coarsest level, the missing object search on level missing_search_pyramid_level
+		Mat invGrey; // if the pyramid has more than one level, only the areas covered by roiRegions are calculated
+		Mat thresholdImage; // binary image with the contours drawn in, only created if create_threshold_detection_image is set
+		vector< vector<Point> > contours;
+		vector<RectangleRegion> regions;
+		vector<Rect> roiRegions; // upright rectangles around the regions
+		vector<RectangleRegion> transformedRegions; // regions relative to their roi
+		vector<Mat> invROIs; // headers into invGrey
+		Mat objectStates; // weighted states of the regions ( centroid.x | centroid.y | direction angle )
+	};
+
 private:
 	/** creates a vector with iterators to all currently active objects (categorized, uncategorized and missing) */
     void buildObjList( vector< list<Ptr<SceneObject> >::iterator >& _objList );
@@ -55,6 +71,17 @@ private:
 	*/
 	void pushFrame( Mat& _img, Mat& _outputImage, double _time );
 
+	/** first half of pushFrame(): thresholds the image and calculates the regions and states of the objects found in it. Reads nothing but the
+	* options and the threshold, it thus may run for a frame while the previous ones are still being tracked. */
+	void detect( Mat& _img, Detection& _detection );
+
+	/** second half of pushFrame(): matches the detected regions with the known objects, updates them, draws into the output image and updates the
+	* classifications. Must be called in frame order. If _overlay is given, the figures drawn are recorded into it as well. */
+	void track( Detection& _detection, Mat& _outputImage, double _time, FrameOverlay* _overlay=NULL );
+
+	/** returns the areas of the active objects in the image tracked last: the bounding rectangles of their last regions of interest */
+	void objectRegions( vector<Frame::ObjectRegion>& _regions );
+
 	/** types indicated in the vector are considered to be in scene (names have to match the type names), all those types not mentioned are considered not to be in the scene 
 	*	The function also initializes the classes.
 	*/
@@ -81,6 +108,8 @@ public:
 
 	/** creates a list with the ids of all currently considered active objects in the scene (the vector _idList is cleared if it isn't empty yet)*/
 	void activeIdList( vector<unsigned int>& _idList );
+	/** creates a list with all objects that were detected in the last frame (categorized and uncategorized), missing objects are added as well if _includeMissing is true (the vector _objList is cleared if it isn't empty yet) */
+	void activeObjects( vector< Ptr<SceneObject> >& _objList, bool _includeMissing=false );
 	/** returns the id of the currently considered active object with the lowest id */
 	unsigned int lowestActiveId();
 	/** returns the id of the currently considered active object with the highest id */
@@ -89,9 +118,16 @@ public:
 	/** returns a pointer to the object indicated by _objId */
 	Ptr<SceneObject> getObj( unsigned int _objId );
 
+	/** the per stream state (object ids, instantiated generic objects, classifiers) of the scene the handler belongs to */
+	StreamContext& stream();
+
+	/** adds the memory used by the objects, the path images and the descriptor creators to the report */
+	void memoryReport( MemoryReport& _report );
+
 private:
-	/** searches an image frame for objects and returns their contours and bounding rectangles */
-	void objRegions( Mat& _binaryImg, vector< vector<Point> >& _contours, vector<RectangleRegion>& _regions );
+	/** searches an image frame for objects and returns their contours and bounding rectangles. If the binary image is a downscaled version, _scale
+	* is the factor by which it was reduced: the contours are scaled back to full resolution before they are filtered and returned */
+	void objRegions( Mat& _binaryImg, vector< vector<Point> >& _contours, vector<RectangleRegion>& _regions, int _scale=1 );
 
 	/** calculates upright rectangles around the (possible rotated) RectangleRegions */
 	void calculateROIs( vector<RectangleRegion>& _regions, vector<Rect>& _uprightRegions );
@@ -162,8 +198,13 @@ private:
     void findMissingObjects( Mat& _predictedStates, Mat& _outputImage, vector< list<Ptr<SceneObject> >::iterator >& _objList, vector<RectangleRegion>& _regions, vector< vector<Point> >& _contours, vector<int>& _objectMapping, vector<bool>& _foundObjects, vector<vector<int> >& _objectGroups );
 
 
-	/** attempts to locate the missing objects that have been predicted to lie inside a found region in the image and calculates states for them which are added to the _objectStates object, together with the correct matching to the new state in _objectMapping */
-    void locateMissingObjects( Mat& _invGreyImg, Mat& _outputImage, Mat& _objectStates, vector< list<Ptr<SceneObject> >::iterator >& _objList, vector<vector<int> >& _objectGroups, vector<int>& _objectMapping, vector<bool>& _foundObjects, vector<vector<Point> >& _contours, vector<RectangleRegion>& _regions, vector<Rect>& _roiRegions, vector<Mat>& _invROIs );
+	/** attempts to locate the missing objects that have been predicted to lie inside a found region in the image and calculates states for them which are added to the _objectStates object, together with the correct matching to the new state in _objectMapping
+	*
+	* The corner search runs on the pyramid of the grey image the detection ran on (after the intern preprocessing stack, within the observation area),
+	* at level missing_search_pyramid_level, not on the grey version of the buffered frame: the regions are in its coordinates, and the search works
+	* the same whether frames are buffered or not.
+	*/
+    void locateMissingObjects( vector<Mat>& _pyramid, Mat& _outputImage, Mat& _objectStates, vector< list<Ptr<SceneObject> >::iterator >& _objList, vector<vector<int> >& _objectGroups, vector<int>& _objectMapping, vector<bool>& _foundObjects, vector<vector<Point> >& _contours, vector<RectangleRegion>& _regions, vector<Rect>& _roiRegions, vector<Mat>& _invROIs );
 
 	
 	/** update the object lists, based on object states and their mappings */
@@ -214,12 +255,12 @@ private:
 	*/
 	void calcLocalMaxima( Mat& _inputImage, Mat& _pointSet, unsigned int _range, double _minValue );
 
-	/** calculates if the point is located close to the border (inside a range specified in the options as window_border_range)
+	/** calculates if the point is located close to the border (inside a range specified in the options as window_border_range) of the image the detection ran on
 	*/
 	bool closeToWindowBorder( Point _point );
 
-	/** draws results of calculations into the image, as set by user */
-	void draw( Mat& _image );
+	/** draws results of calculations into the image, as set by user, and records the figures into _overlay if it is given */
+	void draw( Mat& _image, FrameOverlay* _overlay=NULL );
 
 
 	/** sets up the information vector about which object types might occur in the scene, _initValue: true - all types might occur, false - none of the types known occur */
@@ -312,6 +353,9 @@ private:
 	static int missing_state_bridging; // indicates if "artificial" states shall be added to objects at instants in time when they are missing, possible values are 0:no bridging (leads to 'holes' in state list of objects whenever it was missing), 1: successively keep predicting next state, based on previous prediction and use these to fill the void , 2: use the last known (old) state for bridging {affects: ObjectHandler}
 	static bool time_awareness; // If true, then the classification functions keeps track of the remaining time postpones further classifications if the estimated classification time exceeds the actually available time. If in a feature point creation procedure all descriptors of all states during a recording time span are to be recorded, this should be deactivated. {affects:ObjectHandler}
 	static double time_overhead; // [ms] How much time should be left after the classification processes for further processing
+	static unsigned int pyramid_levels; // number of times the image is halved before thresholding and contour search, the object states are still calculated at full resolution {affects: ObjectHandler}
+	static double pyramid_region_growth; // [blocks] contours found on a pyramid level are grown by this many blocks (less one pixel) to the full object extent before they are filtered and their regions are calculated {affects: ObjectHandler}
+	static unsigned int missing_search_pyramid_level; // pyramid level the corner search for merged objects runs on (limited to the levels built for the detection) {affects: ObjectHandler}
 	static bool create_threshold_detection_image; // if true then the output of the last threshold operation with contours of detected objects is created and can be accessed through thresholdImage() in ObjectHandler {affects: ObjectHandler}
 	static bool draw_predicted_regions; // if true then the predicted region rectangles are drawn into the threshold detection image (if the latter is created, that is) {affects: ObjectHandler}
 };
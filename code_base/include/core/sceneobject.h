@@ -28,6 +28,7 @@
 #include "average.h"
 #include "Options.h"
 #include "RectangleRegion.h"
+#include "FrameOverlay.h"
 
 using namespace cv;
 using namespace std;
@@ -51,6 +52,9 @@ public:
 	/** returns the id of the object */
 	unsigned int id();
 
+	/** returns the object handler of the stream the object belongs to, NULL for class prototypes */
+	ObjectHandler* environment();
+
 	/** returns the class name and color */
 	virtual void classProperties( string& _className, Scalar& _classColor );
 	virtual Scalar color();
@@ -95,6 +99,14 @@ public:
 	*/
 	virtual Mat history();
 
+	/** returns the memory used by the state history in bytes
+	*/
+	size_t historyMemUsage() const;
+
+	/** returns the image the path of the object is drawn into, an empty pointer if none was created (the image may be shared with copies of the object)
+	*/
+	Ptr<Mat> pathImage() const;
+
 	/** returns Mat of last state */
 	virtual Mat currentState();
 
@@ -183,12 +195,13 @@ public:
 	*/
 	virtual void draw( Mat& _img, Scalar _color );
 	/** draws the object informations into the image that correspond to the given layer. This function is called in a way that it is guaranteed that a figure belonging to a higher level of one object is always drawn over a figure belonging to a lower level of another object. Figures belonging to the same level may be drawn over each other, depending on the time when the draw function of the corresponding object is called.
+	* If an overlay is passed, every figure drawn is recorded into it as well (with path_length -1 or -2 the last step of the path is recorded as a path step).
 	*	@return		bool		true if the drawn layer level is the highest the object has (or higher)
 	*/
-	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color );
-	virtual void drawPath( Mat& _img, Scalar _color );
-	virtual void drawDirection( Mat& _img, Scalar _color );
-	virtual void drawName( Mat& _img );
+	virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawPath( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
+	virtual void drawName( Mat& _img, FrameOverlay* _overlay=NULL );
 
 	// CLASSIFICATION ////////////////////////////////////////////////////////////////
 	/** classification function
@@ -235,12 +248,13 @@ public:
 	*
 	*	@return		class identifier
 	*/
-	static int registerObject( std::string _name, Ptr<SceneObject> (* _factoryFunction)( SceneObject* ), double (*_classTest)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors , int _id, int _classId ), bool (*_initializerFunction)( int _classId, ObjectHandler* _environment ), void (*_setOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ), void (*_getOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ) );
+	static int registerObject( std::string _name, Ptr<SceneObject> (* _factoryFunction)( SceneObject* ), double (*_classTest)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors , int _id, int _classId, ObjectHandler* _environment ), bool (*_initializerFunction)( int _classId, ObjectHandler* _environment ), void (*_setOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ), void (*_getOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ) );
 
 	/** creates the static class objects */
 	static bool createClassVectors();
 
 	// OPTIONS SETUP
+	/** loads the object options, called by ObjectHandler::setupOptions() (not per object) */
 	static bool setupOptions();
 
 
@@ -252,7 +266,9 @@ public:
 	*/
 	static vector<double> direction( double _angle );
 
-	static void resetObjectCount();
+	/** returns the points of the path that is drawn for a path_length >1: every path_step_length-th state of the last _pathLength ones, the
+	* first and the newest state included */
+	static void pathPoints( const deque< Ptr<State> >& _history, int _pathLength, vector<Point>& _path );
 
 protected:
 	ObjectHandler* pEnvironmentControl;
@@ -262,12 +278,15 @@ protected:
 	vector<Point> pLastContour; // contour in last frame
 
 	unsigned int pObjectId; // unique id of the object
-	static unsigned int objectCount;
+	static unsigned int objectCount; // ids of objects without environment (class prototypes), the other ones are counted per stream
 	int pType; // -1 if unknown type , -2 if not classified yet
 	
 	vector< Average<double> > pClassLikelihood;
 	void ensureClassLikelihoodSize();
 
+	/** returns the text of the label drawn by drawName() and the colour it is drawn in */
+	void label( string& _text, Scalar& _color );
+
 	int pTimeSincePredictionReset; // -1: reset the prediction and treat the next added state as the very first, -2: if no reset occured or it is that far in the past that it has no effect anymore
 
 	vector<double> pAccEMA_S_old; // exponential moving average filter for acceleration prediction: S_(t-1)
@@ -292,7 +311,7 @@ protected:
 	// object list
 public:
 	static vector< std::string >* objectList; // object class name set - class id corresponds to position of its entities in information vectors
-	static vector< double (*)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId ) >* classifierList; // object class classifier function set
+	static vector< double (*)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId, ObjectHandler* _environment ) >* classifierList; // object class classifier function set
 	static vector< Ptr<SceneObject> (*)( SceneObject* _proto ) >* factoryList; // object class factory function set
 	static vector< bool (*)(int _classId, ObjectHandler* _environment)>* initializerList; // initializer functions for all registered functions: returns true if the class was successfully initialized and thus is ready to be used - are called only when the class is actually expected to occur in the scenery - thus functions registered here can be used to initialize anything that isn't needed and only uses memory for classes
 	static vector< void (*)( GenericMultiLevelMap<string>& _options, int _classId )>* setOptionsFunctionList; // list with functions to set class properties
@@ -317,5 +336,8 @@ class SceneObject::State
 		
 		virtual Point2f pos();
 
+		/** returns the memory used by the state in bytes */
+		virtual size_t memUsage() const;
+
 		int type;
 };
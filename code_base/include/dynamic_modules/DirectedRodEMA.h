@@ -49,7 +49,7 @@ public:
 	
 	// DRAW FUNCTION ///////////////////////
 	//virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color );
-	virtual void drawDirection( Mat& _img, Scalar _color );
+	virtual void drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
 
 protected:
 	//double pPosAlpha, pAngAlpha, pVelAlpha, pVelAngAlpha, pAccAlpha, pAccAngAlpha;
@@ -79,6 +79,8 @@ class DirectedRodEMA::State: public FreeMovingAverage::State
 		State( double _x, double _y, double time, double _angle=0, double _area=0, int _type=-1 );
 		State( Point _pos, double time, double _angle=0, double _area=0, int _type=-1 );
 
+		virtual size_t memUsage() const;
+
 		double halfLengthOffset; // instead of an estimation of the angle perpendicular to the view plane, use only the visible length offset (zero when the abf is oriented perfectly perpendicular). This assumption will be very bad if the abf's direction lies inside the view plane, but quite accurate for the perpendicular case, which is more important since this aims at predicting direction switches
 		double raw_halfLengthOffset;
 		double vel_hlo, acc_hlo;
@@ -90,6 +90,8 @@ class FreeMovingAverage::State: public SceneObject::State
 		State( double _x, double _y, double time, double _angle=0, double _area=0, int _type=-1 );
 		State( Point _pos, double time, double _angle=0, double _area=0, int _type=-1 );
 
+		virtual size_t memUsage() const;
+
 		double raw_x;
 		double raw_y;
 		double raw_angle;
@@ -70,6 +70,8 @@ class NonHoloEMA3d::State: public FilteredDynamics::State
 		State( double _x, double _y, double time, double _angle=0, double _area=0 );
 		State( Point _pos, double time, double _angle=0, double _area=0 );
 
+		virtual size_t memUsage() const;
+
 		double thetaEstimated; // estimated angle in "z-plane"
 		double thetaEstimated_raw;
 };
@@ -73,7 +73,7 @@ public:
 	virtual double predictArea(); // not implemented!
 
 	//virtual bool drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color );
-	virtual void drawDirection( Mat& _img, Scalar _color );
+	virtual void drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay=NULL );
 
 
 protected:
@@ -85,5 +85,7 @@ class NonHoloKalman3D::State: public FilteredDynamics::State
 		State( double _x, double _y, double time, double _angle=0, double _area=0 );
 		State( Point _pos, double time, double _angle=0, double _area=0 );
 
+		virtual size_t memUsage() const;
+
 		double length; // length measurement
 };
@@ -24,12 +24,21 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include <deque>
 #include "Options.h"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
 
 using namespace std;
 
 /** linear algorithm that extends the color range of the input RGB image to the full spectrum 
 *	Seldomly occuring colors in the very dark and very bright spectrum are deleted
 *	and the room gained is used to expand the color range of the rest of the image
+*
+*	The histograms may be calculated on a grid of every histogram_sampling_step-th pixel only. With asynchronous_analysis the peak analysis
+*	that determines the expansion runs on a thread of the algorithm's own: the frame only pays for the (sampled) histograms and the LUT()
+*	pass, the look up table is replaced as a whole once the analysis is done and applied from the next frame on. The analysis works on a
+*	copy of the parameters taken when the histograms were handed over, the expansion ends and the table are published together under
+*	pAnalysisMutex, which also guards every access of the options.
 */
 
 #define	COLORRANGEEXPANSION_ALGORITHM_NAME	"color range expansion"
@@ -38,6 +47,7 @@ class ColorRangeExpansion:public IPAlgorithm
 {
 public:
 	ColorRangeExpansion(void);
+	/** stops the analysis thread */
 	~ColorRangeExpansion(void);
 
 	static Ptr<IPAlgorithm> createInstance();
@@ -69,6 +79,8 @@ public:
 	* small_peak_neglection_bandwidth: (int) Defines a bandwidth over the smallest histogram peak in which all peaks are neglected: when calculating the set of peaks which are used to determine which is the brightest color that still contains actual information. every peak with value<=minPeakValue+pSmallPeakNeglectionBandwidth*minPeakValue is disregarded. Thus, for pSmallPeakNeglectionBandwidth<0 no peaks are disregarded. default: -1
 	* peak_exclusiveness_width: (int) specifies the color range over which the calculated peaks need to be a local maxima. default is 20
 	* dark_peak_relevance_threshold: (float) defines how often a dark color must occur in order not to be neglected when calculating the darkest occuring color
+	* histogram_sampling_step: (int) the histograms only count every histogram_sampling_step-th pixel of every histogram_sampling_step-th row (8 bit images), the counts are scaled to the whole image. 1: all pixels
+	* asynchronous_analysis: (bool) if true then the peak analysis runs on a thread of its own and the new look up table is used as soon as it is done, the frames apply the latest table meanwhile
 	*
 	*/
 	bool setOptions( GenericMultiLevelMap<string>& _options );
@@ -78,38 +90,63 @@ public:
 
 	//option setup
 	void resetSetting();
+
+	/** the expansion is point-wise: it is applied through its look up table, the histograms are recalculated from the image when due */
+	bool pointWise() const;
+	bool needsImage() const;
+	void updateLookUpTable( const Mat& _image );
+
+	/** calculates the histogram for every channel of the image (on the grid of every _samplingStep-th pixel, the counts are scaled to the whole image)
+	*	@ return: true if new histograms have been calculated
+	*/
+	static bool calculateHistograms( const Mat& _image, vector<Mat>& _histograms, int _samplingStep );
 private:
 
 	/** applies the algorithm to the image
 	*/
 	bool process( Mat& _image );
 
-	vector<Mat> pHistograms;
-	Vector<unsigned int> pBrightestPeak; //empty if no peak was found otherwhise: [color, nr of occurances in image]
+	/** the parameters the peak analysis depends on, copied when the histograms are handed over */
+	struct AnalysisParameters
+	{
+		int peakExclusivenessWidth;
+		int smallPeakNeglectionBandwidth;
+		float darkPeakRelevanceThreshold;
+	};
+
 	unsigned int pStepsToRecalculation;
+	bool pHistogramsCalculated; // true once histograms have been calculated for the first time
+
+	// asynchronous analysis
+	vector<Mat> pPendingHistograms; // newest histograms that wait for the analysis thread, older ones are replaced
+	AnalysisParameters pPendingParameters;
+	bool pAnalysisRunning;
+	boost::thread pAnalysisWorker;
+	mutable boost::mutex pAnalysisMutex; // protects the pending histograms, pAnalysisRunning, the options and the expansion ends
+	boost::condition_variable pHistogramsAvailable;
+
+	/** calculates the brightest and the darkest occuring color from the histograms and publishes them together with the new look up table */
+	void analyseHistograms( const vector<Mat>& _histograms, const AnalysisParameters& _parameters );
+	/** hands the histograms to the analysis thread, which is started if it isn't running yet */
+	void startAnalysis( vector<Mat>& _histograms, const AnalysisParameters& _parameters );
+	void stopAnalysis();
+	void analysisThread();
 	
-	/** calculates the brightest occuring color, (which means it basically searches for the upper end of the brightest peak */
-	bool calculateBrightestOccuringColor();
+	/** calculates the brightest occuring color from the sum of all histograms, (which means it basically searches for the upper end of the brightest peak */
+	static unsigned int calculateBrightestOccuringColor( const Mat& _histogram, const Vector<unsigned int>& _brightestPeak );
 
-	/** searches for the darkest color peak, first color that occurs at least pDarkPeakRelevanceThreshold times*/
-	bool calculateDarkestOccuringColor();
+	/** searches for the darkest color peak in the sum of all histograms, first color that occurs at least _relevanceThreshold times*/
+	static unsigned int calculateDarkestOccuringColor( const Mat& _histogram, float _relevanceThreshold );
 
-	/** calculates the brightest peak over all the histograms and writes it into the class member, bottomSizePercentage<=-1 doesn't neglect any peaks after they have been calculated
+	/** calculates the brightest peak over all the histograms: [color, nr of occurances in image], bottomSizePercentage<=-1 doesn't neglect any peaks after they have been calculated
 	* @return	false	if no peaks have been found
 	*/
-	bool calculateBrightestPeak( unsigned int peakExclusivenessWidth, double bottomSizePercentage );
+	static bool calculateBrightestPeak( const vector<Mat>& _histograms, unsigned int peakExclusivenessWidth, double bottomSizePercentage, Vector<unsigned int>& _brightestPeak );
 
-	/** calculates the histogram for every channel of the image
-	*	@ return: true if new histograms have been calculated
-	*/
-	bool calculateHistograms( Mat& _image );
-
-	/** returns true if at this step peak and histograms should be recalculated */
+	/** returns true if at this step peak and histograms should be recalculated, pAnalysisMutex must be locked */
 	bool recalculateSettings();
 
-	/** temporary storage for expansion factor, gets calculated through pBrightestOccuringColor and pDarkestOccuringColor */
-	double tExpansionFactor;
-	Mat pLookUpTable;
+	/** publishes the look up table for pBrightestOccuringColor and pDarkestOccuringColor, pAnalysisMutex must be locked */
 	void calculateExpansionFactor();
 
 	static bool isRegistered;
@@ -140,5 +177,11 @@ private:
 	* default: 20
 	*/
 	int pPeakExclusivenessWidth;
+
+	/** the histograms only count every pHistogramSamplingStep-th pixel in every pHistogramSamplingStep-th row, default: 1 */
+	int pHistogramSamplingStep;
+
+	/** if true then the peak analysis runs on the analysis thread, default: false */
+	bool pAsynchronousAnalysis;
 };
 
@@ -74,6 +74,9 @@ public:
 
 	/** load standard settings */
 	void resetSetting();
+
+	/** the adjustment is point-wise: it is applied through its look up table */
+	bool pointWise() const;
 protected:
 
 	/** applies the algorithm to the image
@@ -83,7 +86,6 @@ protected:
 private:
 	double pBrightnessOffset;
 	double pContrastFactor;
-	Mat pLookUpTable;
 
 	static bool isRegistered;
 
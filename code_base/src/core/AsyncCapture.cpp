@@ -0,0 +1,192 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "AsyncCapture.h"
+#include "Options.h"
+#include <iostream>
+
+
+AsyncCapture::AsyncCapture():pIsFile(false),pFrameRate(0),pRunning(false),pFirstCaptureTime(0)
+{
+	setupOptions();
+	pBufferSize = ( capture_buffer_size==0 )? 1 : capture_buffer_size;
+	if( capture_drop_policy=="newest" ) pRequestedPolicy = NEWEST;
+	else if( capture_drop_policy=="none" ) pRequestedPolicy = NO_DROP;
+	else
+	{
+		if( capture_drop_policy!="auto" ) cerr<<endl<<"AsyncCapture::AsyncCapture:: Unknown drop policy "<<capture_drop_policy<<", using auto."<<endl;
+		pRequestedPolicy = AUTOMATIC;
+	}
+	pPolicy = pRequestedPolicy;
+}
+
+AsyncCapture::AsyncCapture( unsigned int _bufferSize, DropPolicy _policy ):pIsFile(false),pBufferSize( _bufferSize==0? 1 : _bufferSize ),pRequestedPolicy(_policy),pPolicy(_policy),pFrameRate(0),pRunning(false),pFirstCaptureTime(0)
+{
+
+}
+
+AsyncCapture::~AsyncCapture()
+{
+	close();
+}
+
+
+void AsyncCapture::setupOptions()
+{
+	Options::load_options();
+	capture_buffer_size = (*Options::General)["runtime"]["capture"]["buffer_size"].as<unsigned int>();
+	capture_drop_policy = (*Options::General)["runtime"]["capture"]["drop_policy"].as<string>();
+}
+unsigned int AsyncCapture::capture_buffer_size;
+string AsyncCapture::capture_drop_policy;
+
+
+bool AsyncCapture::open( const string& _file )
+{
+	close();
+	if( !pSource.open( _file ) ) return false;
+	pIsFile = true;
+	return start();
+}
+
+bool AsyncCapture::open( int _device )
+{
+	close();
+	if( !pSource.open( _device ) ) return false;
+	pIsFile = false;
+	return start();
+}
+
+bool AsyncCapture::start()
+{
+	pPolicy = pRequestedPolicy;
+	if( pPolicy==AUTOMATIC ) pPolicy = pIsFile? NO_DROP : NEWEST;
+
+	pFrameRate = pSource.get(CV_CAP_PROP_FPS);
+	pFrameSize = Size( (int)pSource.get(CV_CAP_PROP_FRAME_WIDTH), (int)pSource.get(CV_CAP_PROP_FRAME_HEIGHT) );
+
+	pBuffer.clear();
+	pStatistics = Statistics();
+	pFirstCaptureTime = 0;
+	pRunning = true;
+	pWorker = boost::thread( &AsyncCapture::captureThread, this );
+	return true;
+}
+
+void AsyncCapture::close()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	pRunning = false;
+	pRoomAvailable.notify_all();
+	pFrameAvailable.notify_all();
+	lock.unlock();
+
+	if( pWorker.joinable() ) pWorker.join();
+	if( pSource.isOpened() ) pSource.release();
+	pBuffer.clear();
+}
+
+bool AsyncCapture::isOpened() const
+{
+	return pSource.isOpened();
+}
+
+
+bool AsyncCapture::read( CapturedFrame& _frame )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	while( pRunning && pBuffer.empty() ) pFrameAvailable.wait( lock );
+	if( pBuffer.empty() ) return false;
+
+	_frame = pBuffer.front();
+	pBuffer.pop_front();
+	pStatistics.delivered++;
+	pRoomAvailable.notify_one();
+	return true;
+}
+
+AsyncCapture& AsyncCapture::operator>>( Mat& _frame )
+{
+	CapturedFrame captured;
+	if( read( captured ) ) _frame = captured.image;
+	else _frame.release();
+	return *this;
+}
+
+
+double AsyncCapture::frameRate() const
+{
+	return pFrameRate;
+}
+
+Size AsyncCapture::frameSize() const
+{
+	return pFrameSize;
+}
+
+AsyncCapture::Statistics AsyncCapture::statistics() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pStatistics;
+}
+
+AsyncCapture::DropPolicy AsyncCapture::dropPolicy() const
+{
+	return pPolicy;
+}
+
+
+void AsyncCapture::captureThread()
+{
+	unsigned long index = 0;
+	while( true )
+	{
+		CapturedFrame frame;
+		frame.time = pSource.get(CV_CAP_PROP_POS_MSEC);
+		if( !pSource.read( frame.image ) || frame.image.empty() ) break; // the source has ended
+		frame.captureTime = FrameScheduler::now();
+		frame.index = index++;
+
+		// cameras often don't report a position: use the time since the first frame instead
+		if( index==1 ) pFirstCaptureTime = frame.captureTime;
+		if( frame.time<=0 && !pIsFile ) frame.time = frame.captureTime-pFirstCaptureTime;
+
+		boost::mutex::scoped_lock lock( pMutex );
+		if( pPolicy==NO_DROP )
+		{
+			while( pRunning && pBuffer.size()>=pBufferSize ) pRoomAvailable.wait( lock );
+		}
+		if( !pRunning ) return;
+
+		if( pBuffer.size()>=pBufferSize )
+		{
+			pBuffer.pop_front();
+			pStatistics.dropped++;
+		}
+		pBuffer.push_back( frame );
+		pStatistics.captured++;
+		pFrameAvailable.notify_one();
+	}
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pRunning = false;
+	pFrameAvailable.notify_all();
+}
@@ -23,21 +23,20 @@
 #include "Options.h"
 
 
-CompressedFrame::CompressedFrame(void)
+CompressedFrame::CompressedFrame(void):pEditedIsOriginal(false),pComplete(false),pDropped(false),pTime(0)
 {
 }
 
-CompressedFrame::CompressedFrame( Frame& _uncompressed )
+CompressedFrame::CompressedFrame( Frame& _uncompressed ):pEditedIsOriginal(false),pComplete(false),pDropped(false)
 {
-	Mat original = _uncompressed.original();
-
-	encodeImage( &pOriginal, original );
-	encodeImage( &pEdited, _uncompressed.edited() );
-	pTime = _uncompressed.time();
+	setupOptions();
+	encode( _uncompressed );
+	pComplete = true;
 }
 
-CompressedFrame::CompressedFrame(Mat _original, double& _time)
+CompressedFrame::CompressedFrame(Mat _original, double& _time):pEditedIsOriginal(false),pComplete(true),pDropped(false)
 {
+	setupOptions();
 	encodeImage( &pOriginal, _original );
     Mat clonedOriginal = _original.clone();
     encodeImage( &pEdited, clonedOriginal );
@@ -61,12 +60,14 @@ void CompressedFrame::original( Mat& _image )
 
 Mat CompressedFrame::edited() const
 {
+	if( pEditedIsOriginal ) return original();
 	return decodeImage( const_cast<std::vector<uchar>*>(&pEdited) );
 }
 
 void CompressedFrame::edited( Mat& _image )
 {
 	encodeImage( &pEdited, _image );
+	pEditedIsOriginal = false;
 	return;
 }
 
@@ -75,26 +76,45 @@ double CompressedFrame::time() const
 	return pTime;
 }
 
+void CompressedFrame::encode( Frame& _uncompressed )
+{
+	Mat original = _uncompressed.original();
+	Mat& edited = _uncompressed.edited();
+	pEditedIsOriginal = edited.data==original.data && edited.size()==original.size() && edited.type()==original.type();
+
+	encodeImage( &pOriginal, original );
+	if( pEditedIsOriginal ) pEdited.clear();
+	else encodeImage( &pEdited, edited );
+	pTime = _uncompressed.time();
+}
+
+Frame CompressedFrame::decode() const
+{
+	Mat decodedOriginal = original();
+	Mat decodedEdited = pEditedIsOriginal? decodedOriginal : edited();
+	return Frame( decodedOriginal, decodedEdited, pTime );
+}
+
 bool CompressedFrame::encodeImage( vector<uchar>* _targetMemory, Mat& _image )
 {
 	vector<int> params(2);
 	bool success=true;
 
-	if( (*Options::General)["runtime"]["compression"]["format"].as<string>()==".PNG" )
+	if( compression_format==".PNG" )
 	{
 		params[0]=CV_IMWRITE_PNG_COMPRESSION;
-		params[1]=(*Options::General)["runtime"]["compression"]["png_compression_level"].as<int>();
+		params[1]=png_compression_level;
 		success = success && imencode( ".PNG",_image,*_targetMemory, params );
 	}
-	else if( (*Options::General)["runtime"]["compression"]["format"].as<string>()==".JPEG" )
+	else if( compression_format==".JPEG" )
 	{
 		params[0]=CV_IMWRITE_JPEG_QUALITY;
-		params[1]=(*Options::General)["runtime"]["compression"]["jpeg_quality"].as<int>();
+		params[1]=jpeg_quality;
 		success = success &&  imencode( ".JPEG",_image,*_targetMemory, params );
 	}
 	else
 	{
-		std::cerr<<endl<<"Specified format for compression '"<<(*Options::General)["runtime"]["compression"]["format"].as<string>()<<"' is not supported."<<endl;
+		std::cerr<<endl<<"Specified format for compression '"<<compression_format<<"' is not supported."<<endl;
 		return false;
 	}
 	
@@ -120,3 +140,15 @@ int CompressedFrame::memUsage() const
 
 	return sizeof(double)+2*sizeof(vector<uchar>)+origSize*sizeof(uchar)+editSize*sizeof(uchar);
 }
+
+
+void CompressedFrame::setupOptions()
+{
+	Options::load_options();
+	compression_format = (*Options::General)["runtime"]["compression"]["format"].as<string>();
+	png_compression_level = (*Options::General)["runtime"]["compression"]["png_compression_level"].as<int>();
+	jpeg_quality = (*Options::General)["runtime"]["compression"]["jpeg_quality"].as<int>();
+}
+string CompressedFrame::compression_format;
+int CompressedFrame::png_compression_level;
+int CompressedFrame::jpeg_quality;
@@ -219,3 +219,11 @@ unsigned int DescriptorCreator::dataEntrySize()
 {
 	return pDescriptorSet.rows;
 }
+
+
+size_t DescriptorCreator::memUsage() const
+{
+	size_t usage = pDescriptorSet.total()*pDescriptorSet.elemSize() + pSnapshot.total()*pSnapshot.elemSize();
+	if( !pIds.empty() ) usage += pIds->capacity()*sizeof(unsigned int);
+	return usage;
+}
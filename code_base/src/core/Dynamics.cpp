@@ -302,18 +302,18 @@ void GenericObject::Dynamics::lastContour( vector<Point>& _contour )
 
 
 
-bool GenericObject::Dynamics::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color )
+bool GenericObject::Dynamics::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay )
 {
 	if( pHistory().empty() ) return false;
 	switch( _layerLevel ){
 		case 0:
-			drawPath( _img,_color );
+			drawPath( _img, _color, _overlay );
 			return false;
 		case 1:
-			drawDirection( _img, _color );
+			drawDirection( _img, _color, _overlay );
 			return false;
 		case 2:
-			drawName( _img );
+			drawName( _img, _overlay );
 			return true;
 		default:
 			return true;
@@ -322,7 +322,7 @@ bool GenericObject::Dynamics::drawLayer( Mat& _img, unsigned int _layerLevel, Sc
 
 
 
-void GenericObject::Dynamics::drawPath( Mat& _img, Scalar _color )
+void GenericObject::Dynamics::drawPath( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	if( pHistory().size()<2 ) return;
 
@@ -334,7 +334,9 @@ void GenericObject::Dynamics::drawPath( Mat& _img, Scalar _color )
 	if( GenericObject::path_length() == -2 ) // the passed image is the central path image, draw last made step on it
 	{
 		unsigned int lastElementId = pHistory().size();
-		line( _img, Point( pHistory()[lastElementId-2]->x, pHistory()[lastElementId-2]->y ), Point( pHistory()[lastElementId-1]->x, pHistory()[lastElementId-1]->y ), Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		Point start( pHistory()[lastElementId-2]->x, pHistory()[lastElementId-2]->y ), end( pHistory()[lastElementId-1]->x, pHistory()[lastElementId-1]->y );
+		line( _img, start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		if( _overlay!=NULL ) _overlay->pathStep( start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ) );
 		return;
 	}
 	else if( GenericObject::path_length() == -1 ) // draw last made step into the object's own path image
@@ -347,8 +349,10 @@ void GenericObject::Dynamics::drawPath( Mat& _img, Scalar _color )
 		}
 
 		unsigned int lastElementId = pHistory().size();
+		Point start( pHistory()[lastElementId-2]->x, pHistory()[lastElementId-2]->y ), end( pHistory()[lastElementId-1]->x, pHistory()[lastElementId-1]->y );
 	
-		line( *pPathMat(), Point( pHistory()[lastElementId-2]->x, pHistory()[lastElementId-2]->y ), Point( pHistory()[lastElementId-1]->x, pHistory()[lastElementId-1]->y ), Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		line( *pPathMat(), start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		if( _overlay!=NULL ) _overlay->pathStep( start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ) );
 
 		_img -= *pPathMat();
 		return;
@@ -356,40 +360,17 @@ void GenericObject::Dynamics::drawPath( Mat& _img, Scalar _color )
 	else if( GenericObject::path_length() == 0 || GenericObject::path_length() == 1 || GenericObject::path_length() < -2 ) return;
 
 	// a number of steps that are to be drawn is defined
-	
-	unsigned int pathStep = path_step_length;
-	if( pathStep<1 ) pathStep=1;
-
-	int nrOfSteps = GenericObject::path_length()/pathStep;
-	int lastStepOvershoot = pHistory().size() % pathStep;
-	
-	
 	vector<Point> path;
-
-	// startpoint on pathStep scale
-	int startPoint = pHistory().size()-nrOfSteps*pathStep; // nrOfSteps*pathStep is not equal the path_length as nrOfSteps as an integer is rounded downwards
-	
-	if( startPoint<0 ) startPoint = 0;
-	else
-	{
-		path.push_back( Point(pHistory()[startPoint]->x,pHistory()[startPoint]->y) );
-		startPoint += pathStep-lastStepOvershoot;
-	}
-
-
-    for( size_t i=startPoint; i<pHistory().size(); i+=pathStep )
-	{
-		path.push_back( Point(pHistory()[i]->x,pHistory()[i]->y) );
-		if( i+pathStep >= pHistory().size() ) path.push_back( Point(pHistory()[pHistory().size()-1]->x,pHistory()[pHistory().size()-1]->y) );
-	}
+	pathPoints( pHistory(), GenericObject::path_length(), path );
 	int size = path.size();
 	const cv::Point *pts = (const cv::Point*) Mat(path).data;
 	polylines(_img,&pts,&size,1,false,_color,1);
+	if( _overlay!=NULL ) _overlay->polyline( 0, path, _color, 1 );
 	return;
 }
 
 
-void GenericObject::Dynamics::drawDirection( Mat& _img, Scalar _color )
+void GenericObject::Dynamics::drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	if( pHistory().size()==0 ) return;
 
@@ -403,48 +384,32 @@ void GenericObject::Dynamics::drawDirection( Mat& _img, Scalar _color )
 	Point zwei( current->x+10*myDirection[0], current->y+10*myDirection[1] );
 
 	line( _img, eins, zwei, _color, 2, 8 );
+	if( _overlay!=NULL ) _overlay->line( 1, eins, zwei, _color, 2 );
 }
 
 
-void GenericObject::Dynamics::drawName( Mat& _img )
+void GenericObject::Dynamics::drawName( Mat& _img, FrameOverlay* _overlay )
+{
+	string name;
+	Scalar color;
+	label( name, color );
+
+	FrameOverlay::drawLabel( _img, pos(), name, color );
+	if( _overlay!=NULL ) _overlay->label( 2, pos(), name, color );
+	return;
+}
+
+
+void GenericObject::Dynamics::label( string& _text, Scalar& _color )
 {
 	stringstream nameBuilder;
 
 	string className;
-	Scalar color;
-	
-	pObjectPointer->classProperties( className, color );
+	pObjectPointer->classProperties( className, _color );
 	
 	nameBuilder<<"id#"<<pObjectPointer->pObjectId<<":";
-	string name;
-	nameBuilder>>name;
-	name += className;
-
-	Point actualPosition=pos();
-	Point textPosition = actualPosition;
-	
-	Point offset(10,15);
-	int fontFace =  FONT_HERSHEY_PLAIN;
-	double fontScale = 0.7;
-	int thickness = 1;
-	int baseline;
-	double rightBorderDistance = 5; // [px]
-	double bottomBorderDistance = 5; // [px]
-	int rectDistX = 2; // [px] backing rectangle: additional width left and right
-	int rectDistY = 3; // [px] backing rectangle: additional height top and bottom
-	Size textSize = getTextSize( name, fontFace, fontScale, thickness, &baseline );
-	if( textPosition.x+offset.x+textSize.width+rightBorderDistance+rectDistX > _img.cols ) textPosition.x = _img.cols-textSize.width-rightBorderDistance-offset.x-rectDistX;
-	if( textPosition.y+offset.y+textSize.height+bottomBorderDistance+rectDistY > _img.rows ) textPosition.y = _img.rows-textSize.height-bottomBorderDistance-offset.y-rectDistY;
-	
-	Point rectPos( textPosition.x+offset.x-rectDistX, textPosition.y+offset.y-textSize.height-rectDistY );
-	Mat opaque( textSize.height+2*rectDistY, textSize.width+2*rectDistX, CV_8UC3, CV_RGB(190,190,190) );
-	
-	Mat toOverlay = _img( Range( rectPos.y, rectPos.y+opaque.rows ),Range( rectPos.x, rectPos.x+opaque.cols ) );
-	
-	toOverlay = toOverlay+opaque;
-	putText( _img, name, textPosition+offset,  fontFace, fontScale, color, thickness, 8, false );
-	circle( _img, actualPosition, 3, color, 2 );
-	return;
+	nameBuilder>>_text;
+	_text += className;
 }
 
 
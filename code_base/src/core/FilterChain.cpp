@@ -0,0 +1,96 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "FilterChain.h"
+
+
+FilterChain::FilterChain():pPasses(0)
+{
+
+}
+
+
+bool FilterChain::apply( list< Ptr<IPAlgorithm> >& _stack, Mat& _image )
+{
+	pPasses = 0;
+	bool fuse = _image.depth()==CV_8U;
+	vector<const IPAlgorithm*> run;
+	unsigned int runNumber = 0;
+
+	for( list< Ptr<IPAlgorithm> >::iterator it=_stack.begin(); it!=_stack.end(); it++ )
+	{
+		IPAlgorithm& algorithm = **it;
+		if( !algorithm.active ) continue;
+
+		bool pointWise = fuse && algorithm.pointWise();
+		// the pending run is applied before an algorithm that has to see the image
+		if( !run.empty() && ( !pointWise || algorithm.needsImage() ) )
+		{
+			applyRun( runNumber++, run, _image );
+			run.clear();
+		}
+
+		if( !pointWise )
+		{
+			pPasses++;
+			if( !algorithm.apply( _image ) ) return false;
+			continue;
+		}
+
+		algorithm.updateLookUpTable( _image );
+		if( !algorithm.lookUpTable().empty() ) run.push_back( &algorithm );
+	}
+
+	if( !run.empty() ) applyRun( runNumber, run, _image );
+	return true;
+}
+
+
+unsigned int FilterChain::passes() const
+{
+	return pPasses;
+}
+
+
+void FilterChain::applyRun( unsigned int _run, const vector<const IPAlgorithm*>& _algorithms, Mat& _image )
+{
+	if( _run>=pRuns.size() ) pRuns.resize( _run+1 );
+	Run& cached = pRuns[_run];
+
+	// tables and versions are taken together, a table published meanwhile (e.g. by an analysis thread) is used from the next image on
+	vector<Mat> tables( _algorithms.size() );
+	vector<unsigned long> versions( _algorithms.size() );
+	for( size_t i=0; i<_algorithms.size(); i++ ) tables[i] = _algorithms[i]->lookUpTable( versions[i] );
+
+	// the versions are unique over all algorithms: an algorithm that was replaced by another one at the same address is noticed as well
+	bool upToDate = !cached.table.empty() && cached.algorithms==_algorithms && cached.versions==versions;
+
+	if( !upToDate )
+	{
+		cached.algorithms = _algorithms;
+		cached.versions = versions;
+
+		cached.table = tables[0].clone();
+		for( size_t i=1; i<tables.size(); i++ ) LUT( cached.table, tables[i], cached.table );
+	}
+
+	LUT( _image, cached.table, _image );
+	pPasses++;
+}
@@ -103,3 +103,4 @@ FilteredDynamics::State::~State()
 FilteredDynamics::State::State( double _x, double _y, double time, double _angle, double _area ):SceneObject::State( _x, _y, time, _angle, _area, classId ){}
 
 FilteredDynamics::State::State( Point _pos, double time, double _angle, double _area ):SceneObject::State( _pos, time, _angle, _area, classId ){}
+size_t FilteredDynamics::State::memUsage() const{ return sizeof(FilteredDynamics::State); }
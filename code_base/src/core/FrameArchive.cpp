@@ -0,0 +1,351 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FrameArchive.h"
+#include "boost/filesystem.hpp"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+
+FrameArchive::FrameArchive():pWritable(false),pDataSize(0)
+{
+
+}
+
+FrameArchive::~FrameArchive()
+{
+	close();
+}
+
+
+bool FrameArchive::create( const string& _path )
+{
+	close();
+	boost::mutex::scoped_lock lock( pMutex );
+	pPath = _path;
+
+	pData.open( dataFile().c_str(), ios::out | ios::binary | ios::trunc );
+	pIndexOut.open( indexFile().c_str(), ios::out | ios::binary | ios::trunc );
+	if( !pData.is_open() || !pIndexOut.is_open() )
+	{
+		cerr<<endl<<"FrameArchive::create:: Could not create the archive "<<_path<<"."<<endl;
+		pData.close();
+		pIndexOut.close();
+		return false;
+	}
+
+	Header dataHeader = header('d');
+	Header indexHeader = header('i');
+	pData.write( reinterpret_cast<const char*>(&dataHeader), sizeof(Header) );
+	pIndexOut.write( reinterpret_cast<const char*>(&indexHeader), sizeof(Header) );
+	pData.flush();
+	pIndexOut.flush();
+
+	pDataSize = sizeof(Header);
+	pWritable = true;
+	return true;
+}
+
+
+bool FrameArchive::open( const string& _path, bool _append )
+{
+	close();
+	boost::mutex::scoped_lock lock( pMutex );
+	pPath = _path;
+
+	ifstream data( dataFile().c_str(), ios::in | ios::binary );
+	ifstream index( indexFile().c_str(), ios::in | ios::binary );
+	Header dataHeader, indexHeader;
+	if( !data.read( reinterpret_cast<char*>(&dataHeader), sizeof(Header) ) || !index.read( reinterpret_cast<char*>(&indexHeader), sizeof(Header) ) || !validHeader( dataHeader, 'd' ) || !validHeader( indexHeader, 'i' ) )
+	{
+		cerr<<endl<<"FrameArchive::open:: "<<_path<<" is not a valid frame archive."<<endl;
+		return false;
+	}
+
+	// entries whose data wasn't written completely are ignored (and overwritten when appending)
+	boost::uint64_t dataSize = boost::filesystem::file_size( dataFile() );
+	IndexEntry entry;
+	while( index.read( reinterpret_cast<char*>(&entry), sizeof(IndexEntry) ) && entry.offset+entry.size<=dataSize ) pIndex.push_back( entry );
+	pDataSize = pIndex.empty()? sizeof(Header) : pIndex.back().offset+pIndex.back().size;
+
+	if( !_append ) return true;
+
+	// the files are cut back to the complete frames before appending
+	data.close();
+	index.close();
+	boost::filesystem::resize_file( dataFile(), pDataSize );
+	boost::filesystem::resize_file( indexFile(), sizeof(Header)+pIndex.size()*sizeof(IndexEntry) );
+	pData.open( dataFile().c_str(), ios::out | ios::binary | ios::app );
+	pIndexOut.open( indexFile().c_str(), ios::out | ios::binary | ios::app );
+	pWritable = pData.is_open() && pIndexOut.is_open();
+	if( !pWritable ) cerr<<endl<<"FrameArchive::open:: Could not open "<<_path<<" for appending."<<endl;
+	return pWritable;
+}
+
+
+void FrameArchive::close()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	pRegions.clear();
+	pMapping.reset();
+	if( pData.is_open() ) pData.close();
+	if( pIndexOut.is_open() ) pIndexOut.close();
+	pIndex.clear();
+	pDataSize = 0;
+	pWritable = false;
+}
+
+bool FrameArchive::isOpen() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return !pPath.empty() && pDataSize>0;
+}
+
+
+bool FrameArchive::append( Frame& _frame )
+{
+	if( !pWritable ) return false;
+
+	const Mat& original = _frame.original();
+	Mat& edited = _frame.edited();
+	Ptr<FrameOverlay> overlay = _frame.overlay();
+	bool editedIsOriginal = edited.data==original.data && edited.size()==original.size() && edited.type()==original.type();
+
+	IndexEntry entry;
+	memset( &entry, 0, sizeof(IndexEntry) );
+	entry.offset = pDataSize;
+	entry.time = _frame.time();
+	entry.codec = RAW;
+	entry.originalRows = original.rows;
+	entry.originalCols = original.cols;
+	entry.originalType = original.type();
+	entry.editedRows = edited.rows;
+	entry.editedCols = edited.cols;
+	entry.editedType = ( !overlay.empty() )? -2 : ( editedIsOriginal? -1 : edited.type() );
+
+	// only this thread writes, the readers just see the frame once its index entry has been added
+	entry.size = writeImage( original );
+	if( !overlay.empty() )
+	{
+		vector<uchar> overlayData;
+		overlay->serialize( overlayData );
+		if( !overlayData.empty() ) pData.write( reinterpret_cast<const char*>( &overlayData[0] ), overlayData.size() );
+		entry.overlaySize = overlayData.size();
+		entry.size += entry.overlaySize;
+	}
+	else if( !editedIsOriginal ) entry.size += writeImage( edited );
+	pData.flush();
+	pIndexOut.write( reinterpret_cast<const char*>(&entry), sizeof(IndexEntry) );
+	pIndexOut.flush();
+
+	if( !pData.good() || !pIndexOut.good() )
+	{
+		cerr<<endl<<"FrameArchive::append:: Could not write to the archive "<<pPath<<", no further frames are archived."<<endl;
+		pWritable = false;
+		return false;
+	}
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pIndex.push_back( entry );
+	pDataSize += entry.size;
+	return true;
+}
+
+
+unsigned long FrameArchive::size() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pIndex.size();
+}
+
+
+bool FrameArchive::load( unsigned long _i, Frame& _frame ) const
+{
+	Mat original;
+	Ptr<FrameOverlay> overlay;
+	double time;
+	if( !read( _i, original, overlay, &_frame, time ) ) return false;
+	if( overlay.empty() ) return true;
+
+	Mat edited;
+	overlay->render( original, edited );
+	_frame = Frame( original, edited, time );
+	_frame.setOverlay( overlay );
+	return true;
+}
+
+bool FrameArchive::loadOriginal( unsigned long _i, Mat& _original, Ptr<FrameOverlay>& _overlay, double& _time ) const
+{
+	return read( _i, _original, _overlay, NULL, _time );
+}
+
+
+long FrameArchive::find( double _time ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+
+	// time stamps increase with the frame number
+	unsigned long first = 0, last = pIndex.size();
+	while( first<last )
+	{
+		unsigned long middle = first+( last-first )/2;
+		if( pIndex[middle].time<=_time ) first = middle+1;
+		else last = middle;
+	}
+	return (long)first-1;
+}
+
+
+FrameArchive::IndexEntry FrameArchive::entry( unsigned long _i ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pIndex.at(_i);
+}
+
+
+size_t FrameArchive::bytes() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( pDataSize==0 ) return 0;
+	return (size_t)( pDataSize+sizeof(Header)+pIndex.size()*sizeof(IndexEntry) );
+}
+
+string FrameArchive::dataFile() const
+{
+	return pPath+".mfa";
+}
+
+string FrameArchive::indexFile() const
+{
+	return pPath+".mfi";
+}
+
+
+FrameArchive::Header FrameArchive::header( char _type )
+{
+	Header newHeader;
+	memset( &newHeader, 0, sizeof(Header) );
+	memcpy( newHeader.magic, "MOLARFA", 7 );
+	newHeader.magic[7] = _type;
+	newHeader.version = formatVersion;
+	newHeader.headerSize = sizeof(Header);
+	newHeader.entrySize = sizeof(IndexEntry);
+	return newHeader;
+}
+
+bool FrameArchive::validHeader( const Header& _header, char _type )
+{
+	return memcmp( _header.magic, "MOLARFA", 7 )==0 && _header.magic[7]==_type && _header.version==formatVersion && _header.headerSize==sizeof(Header) && _header.entrySize==sizeof(IndexEntry);
+}
+
+
+boost::uint64_t FrameArchive::writeImage( const Mat& _image )
+{
+	size_t rowSize = _image.cols*_image.elemSize();
+	if( _image.isContinuous() ) pData.write( reinterpret_cast<const char*>(_image.data), rowSize*_image.rows );
+	else
+	{
+		for( int y=0; y<_image.rows; y++ ) pData.write( reinterpret_cast<const char*>( _image.ptr(y) ), rowSize );
+	}
+	return (boost::uint64_t)rowSize*_image.rows;
+}
+
+
+bool FrameArchive::read( unsigned long _i, Mat& _original, Ptr<FrameOverlay>& _overlay, Frame* _frame, double& _time ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( _i>=pIndex.size() ) return false;
+
+	const IndexEntry& entry = pIndex[_i];
+	if( entry.codec!=RAW || !mapData( entry.offset+entry.size ) ) return false;
+
+	// the images are copied out of the mapping, which is replaced when the file grows
+	uchar* data = mappedData( entry.offset );
+	if( data==NULL ) return false;
+	_original = Mat( entry.originalRows, entry.originalCols, entry.originalType, data ).clone();
+	_time = entry.time;
+	_overlay.release();
+	data += _original.total()*_original.elemSize();
+
+	if( entry.editedType==-2 )
+	{
+		_overlay = new FrameOverlay();
+		if( !_overlay->deserialize( data, entry.overlaySize ) ) cerr<<endl<<"FrameArchive::read:: The overlay of frame "<<_i<<" in "<<pPath<<" is incomplete."<<endl;
+		return true;
+	}
+
+	if( _frame==NULL ) return true;
+	Mat edited = _original;
+	if( entry.editedType!=-1 ) edited = Mat( entry.editedRows, entry.editedCols, entry.editedType, data ).clone();
+	*_frame = Frame( _original, edited, entry.time );
+	return true;
+}
+
+
+bool FrameArchive::mapData( boost::uint64_t _end ) const
+{
+	boost::uint64_t start = pRegions.empty()? 0 : pRegions.back().end();
+	if( start>=_end ) return true;
+
+	// the ranges before the appended one are merged into it as long as they aren't larger
+	while( !pRegions.empty() && pRegions.back().end()-pRegions.back().offset<=pDataSize-start )
+	{
+		start = pRegions.back().offset;
+		pRegions.pop_back();
+	}
+
+	try
+	{
+		if( !pMapping ) pMapping.reset( new boost::interprocess::file_mapping( dataFile().c_str(), boost::interprocess::read_only ) );
+		MappedRange range;
+		range.offset = start;
+		range.region = new boost::interprocess::mapped_region( *pMapping, boost::interprocess::read_only, (boost::interprocess::offset_t)start, (size_t)( pDataSize-start ) );
+		pRegions.push_back( range );
+	}
+	catch( boost::interprocess::interprocess_exception& _exception )
+	{
+		cerr<<endl<<"FrameArchive::mapData:: Could not map "<<dataFile()<<": "<<_exception.what()<<endl;
+		pRegions.clear(); // the merged ranges are gone already, everything is mapped again on the next read
+		return false;
+	}
+	return pRegions.back().end()>=_end;
+}
+
+
+uchar* FrameArchive::mappedData( boost::uint64_t _offset ) const
+{
+	// the ranges are in ascending order: the last one starting before _offset contains it if any does
+	for( size_t i=pRegions.size(); i>0; i-- )
+	{
+		const MappedRange& range = pRegions[i-1];
+		if( range.offset>_offset ) continue;
+		if( _offset>=range.end() ) return NULL;
+		return static_cast<uchar*>( range.region->get_address() )+( _offset-range.offset );
+	}
+	return NULL;
+}
+
+
+boost::uint64_t FrameArchive::MappedRange::end() const
+{
+	return offset+region->get_size();
+}
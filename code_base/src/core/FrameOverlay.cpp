@@ -0,0 +1,271 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "FrameOverlay.h"
+#include "opencv2/imgproc/imgproc.hpp"
+#include "boost/cstdint.hpp"
+#include <cstring>
+#include <algorithm>
+
+
+FrameOverlay::FrameOverlay():pOrigin(0,0)
+{
+
+}
+
+
+void FrameOverlay::setOrigin( Point _origin )
+{
+	pOrigin = _origin;
+}
+
+
+void FrameOverlay::line( unsigned int _layer, Point _start, Point _end, Scalar _color, int _thickness )
+{
+	Primitive& primitive = add( LINE, _layer, _color, _thickness );
+	primitive.points.push_back( _start+pOrigin );
+	primitive.points.push_back( _end+pOrigin );
+}
+
+void FrameOverlay::polyline( unsigned int _layer, const vector<Point>& _points, Scalar _color, int _thickness )
+{
+	if( _points.empty() ) return;
+	Primitive& primitive = add( POLYLINE, _layer, _color, _thickness );
+	primitive.points.reserve( _points.size() );
+	for( size_t i=0; i<_points.size(); i++ ) primitive.points.push_back( _points[i]+pOrigin );
+}
+
+void FrameOverlay::rectangle( unsigned int _layer, Rect _rectangle, Scalar _color, int _thickness )
+{
+	Primitive& primitive = add( RECTANGLE, _layer, _color, _thickness );
+	primitive.points.push_back( _rectangle.tl()+pOrigin );
+	primitive.points.push_back( _rectangle.br()-Point(1,1)+pOrigin ); // the same corners cv::rectangle() uses for a Rect
+}
+
+void FrameOverlay::label( unsigned int _layer, Point _position, const string& _text, Scalar _color )
+{
+	Primitive& primitive = add( LABEL, _layer, _color, 1 );
+	primitive.points.push_back( _position+pOrigin );
+	primitive.text = _text;
+}
+
+void FrameOverlay::pathStep( Point _start, Point _end, Scalar _color )
+{
+	Primitive& primitive = add( PATH_STEP, 0, _color, 1 );
+	primitive.points.push_back( _start+pOrigin );
+	primitive.points.push_back( _end+pOrigin );
+}
+
+
+const vector<FrameOverlay::Primitive>& FrameOverlay::primitives() const
+{
+	return pPrimitives;
+}
+
+bool FrameOverlay::empty() const
+{
+	return pPrimitives.empty();
+}
+
+void FrameOverlay::clear()
+{
+	pPrimitives.clear();
+}
+
+
+void FrameOverlay::render( const Mat& _original, Mat& _annotated, Mat* _pathImage ) const
+{
+	bool usesPathImage = _pathImage!=NULL && !_pathImage->empty();
+	if( _original.channels()==1 ) cvtColor( _original, _annotated, CV_GRAY2BGR );
+	else if( pPrimitives.empty() && !usesPathImage )
+	{
+		_annotated = _original;
+		return;
+	}
+	else _annotated = _original.clone();
+
+	unsigned int topLayer = 0;
+	for( size_t i=0; i<pPrimitives.size(); i++ ) topLayer = max( topLayer, (unsigned int)pPrimitives[i].layer );
+
+	for( unsigned int layer=0; layer<=topLayer; layer++ )
+	{
+		for( size_t i=0; i<pPrimitives.size(); i++ )
+		{
+			const Primitive& primitive = pPrimitives[i];
+			if( primitive.layer!=layer ) continue;
+			if( primitive.type!=PATH_STEP ) draw( _annotated, primitive );
+			else if( usesPathImage ) draw( *_pathImage, primitive );
+		}
+		// the central path image lies between the first layer and the others, as in ObjectHandler::draw()
+		if( layer==0 && usesPathImage && _pathImage->size()==_annotated.size() && _pathImage->type()==_annotated.type() ) _annotated -= *_pathImage;
+	}
+}
+
+
+void FrameOverlay::serialize( vector<uchar>& _data ) const
+{
+	// per primitive: type, layer, thickness, colour (1 byte each), number of points (2 bytes), points (2x2 bytes), text length (2 bytes), text
+	boost::uint32_t count = pPrimitives.size();
+	const uchar* countBytes = reinterpret_cast<const uchar*>( &count );
+	_data.insert( _data.end(), countBytes, countBytes+sizeof(count) );
+
+	for( size_t i=0; i<pPrimitives.size(); i++ )
+	{
+		const Primitive& primitive = pPrimitives[i];
+		boost::uint16_t nrOfPoints = (boost::uint16_t)min( primitive.points.size(), (size_t)0xFFFF );
+		boost::uint16_t textLength = (boost::uint16_t)min( primitive.text.size(), (size_t)0xFFFF );
+
+		uchar fixed[6] = { primitive.type, primitive.layer, primitive.thickness, primitive.color[0], primitive.color[1], primitive.color[2] };
+		_data.insert( _data.end(), fixed, fixed+6 );
+		const uchar* lengthBytes = reinterpret_cast<const uchar*>( &nrOfPoints );
+		_data.insert( _data.end(), lengthBytes, lengthBytes+sizeof(nrOfPoints) );
+		for( unsigned int p=0; p<nrOfPoints; p++ )
+		{
+			boost::int16_t coordinates[2] = { saturate_cast<short>( primitive.points[p].x ), saturate_cast<short>( primitive.points[p].y ) };
+			const uchar* pointBytes = reinterpret_cast<const uchar*>( coordinates );
+			_data.insert( _data.end(), pointBytes, pointBytes+sizeof(coordinates) );
+		}
+		lengthBytes = reinterpret_cast<const uchar*>( &textLength );
+		_data.insert( _data.end(), lengthBytes, lengthBytes+sizeof(textLength) );
+		_data.insert( _data.end(), primitive.text.begin(), primitive.text.begin()+textLength );
+	}
+}
+
+
+bool FrameOverlay::deserialize( const uchar* _data, size_t _size )
+{
+	pPrimitives.clear();
+	pOrigin = Point(0,0);
+
+	const uchar* position = _data;
+	const uchar* end = _data+_size;
+	boost::uint32_t count;
+	if( end-position<(long)sizeof(count) ) return false;
+	memcpy( &count, position, sizeof(count) );
+	position += sizeof(count);
+
+	for( boost::uint32_t i=0; i<count; i++ )
+	{
+		boost::uint16_t nrOfPoints, textLength;
+		if( end-position<6+(long)sizeof(nrOfPoints) ) return false;
+
+		Primitive primitive;
+		primitive.type = position[0];
+		primitive.layer = position[1];
+		primitive.thickness = position[2];
+		primitive.color = Vec3b( position[3], position[4], position[5] );
+		memcpy( &nrOfPoints, position+6, sizeof(nrOfPoints) );
+		position += 6+sizeof(nrOfPoints);
+
+		if( end-position<(long)( nrOfPoints*2*sizeof(boost::int16_t)+sizeof(textLength) ) ) return false;
+		primitive.points.resize( nrOfPoints );
+		for( unsigned int p=0; p<nrOfPoints; p++ )
+		{
+			boost::int16_t coordinates[2];
+			memcpy( coordinates, position, sizeof(coordinates) );
+			primitive.points[p] = Point( coordinates[0], coordinates[1] );
+			position += sizeof(coordinates);
+		}
+		memcpy( &textLength, position, sizeof(textLength) );
+		position += sizeof(textLength);
+
+		if( end-position<textLength ) return false;
+		primitive.text.assign( reinterpret_cast<const char*>(position), textLength );
+		position += textLength;
+
+		pPrimitives.push_back( primitive );
+	}
+	return true;
+}
+
+
+size_t FrameOverlay::memUsage() const
+{
+	size_t bytes = sizeof(FrameOverlay)+pPrimitives.capacity()*sizeof(Primitive);
+	for( size_t i=0; i<pPrimitives.size(); i++ ) bytes += pPrimitives[i].points.capacity()*sizeof(Point)+pPrimitives[i].text.capacity();
+	return bytes;
+}
+
+
+void FrameOverlay::drawLabel( Mat& _img, Point _position, const string& _text, Scalar _color )
+{
+	Point textPosition = _position;
+	Point offset(10,15);
+	int fontFace =  FONT_HERSHEY_PLAIN;
+	double fontScale = 0.7;
+	int thickness = 1;
+	int baseline;
+	double rightBorderDistance = 5; // [px]
+	double bottomBorderDistance = 5; // [px]
+	int rectDistX = 2; // [px] backing rectangle: additional width left and right
+	int rectDistY = 3; // [px] backing rectangle: additional height top and bottom
+	Size textSize = getTextSize( _text, fontFace, fontScale, thickness, &baseline );
+	if( textPosition.x+offset.x+textSize.width+rightBorderDistance+rectDistX > _img.cols ) textPosition.x = _img.cols-textSize.width-rightBorderDistance-offset.x-rectDistX;
+	if( textPosition.y+offset.y+textSize.height+bottomBorderDistance+rectDistY > _img.rows ) textPosition.y = _img.rows-textSize.height-bottomBorderDistance-offset.y-rectDistY;
+	
+	Point rectPos( textPosition.x+offset.x-rectDistX, textPosition.y+offset.y-textSize.height-rectDistY );
+	Mat opaque( textSize.height+2*rectDistY, textSize.width+2*rectDistX, CV_8UC3, CV_RGB(190,190,190) );
+	Mat toOverlay = _img( Range( rectPos.y, rectPos.y+opaque.rows ),Range( rectPos.x, rectPos.x+opaque.cols ) );
+	
+	toOverlay = toOverlay+opaque;
+	putText( _img, _text, textPosition+offset,  fontFace, fontScale, _color, thickness, 8, false );
+	circle( _img, _position, 3, _color, 2 );
+}
+
+
+FrameOverlay::Primitive& FrameOverlay::add( unsigned char _type, unsigned int _layer, Scalar _color, int _thickness )
+{
+	pPrimitives.push_back( Primitive() );
+	Primitive& primitive = pPrimitives.back();
+	primitive.type = _type;
+	primitive.layer = (unsigned char)min( _layer, 255u );
+	primitive.thickness = (unsigned char)max( 1, min( _thickness, 255 ) );
+	primitive.color = Vec3b( saturate_cast<uchar>(_color[0]), saturate_cast<uchar>(_color[1]), saturate_cast<uchar>(_color[2]) );
+	return primitive;
+}
+
+
+void FrameOverlay::draw( Mat& _img, const Primitive& _primitive )
+{
+	Scalar color( _primitive.color[0], _primitive.color[1], _primitive.color[2] );
+	switch( _primitive.type )
+	{
+		case LINE:
+		case PATH_STEP:
+			if( _primitive.points.size()==2 ) cv::line( _img, _primitive.points[0], _primitive.points[1], color, _primitive.thickness, 8 );
+			return;
+		case POLYLINE:
+		{
+			if( _primitive.points.empty() ) return;
+			const Point* points = &_primitive.points[0];
+			int nrOfPoints = _primitive.points.size();
+			polylines( _img, &points, &nrOfPoints, 1, false, color, _primitive.thickness );
+			return;
+		}
+		case RECTANGLE:
+			if( _primitive.points.size()==2 ) cv::rectangle( _img, _primitive.points[0], _primitive.points[1], color, _primitive.thickness );
+			return;
+		case LABEL:
+			if( _primitive.points.size()==1 ) drawLabel( _img, _primitive.points[0], _primitive.text, color );
+			return;
+		default:
+			return;
+	}
+}
@@ -0,0 +1,142 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "FrameScheduler.h"
+#include "Options.h"
+#include <algorithm>
+
+
+FrameScheduler::FrameScheduler( double _frameRate ):pEstimatedCost(NR_OF_OPTIONAL_STAGES,0),pConsumed(NR_OF_OPTIONAL_STAGES,0)
+{
+	setupOptions();
+	setFrameRate( _frameRate );
+	pArrivalTime = now();
+
+	pStageBudget.resize( NR_OF_OPTIONAL_STAGES );
+	pStageBudget[CLASSIFICATION] = classification_budget;
+	pStageBudget[DRAWING] = drawing_budget;
+	pStageBudget[BUFFER_SPILL] = buffer_spill_budget;
+}
+
+
+void FrameScheduler::setupOptions()
+{
+	Options::load_options();
+	classification_budget = (*Options::General)["runtime"]["scheduling"]["classification_budget"].as<double>();
+	drawing_budget = (*Options::General)["runtime"]["scheduling"]["drawing_budget"].as<double>();
+	buffer_spill_budget = (*Options::General)["runtime"]["scheduling"]["buffer_spill_budget"].as<double>();
+}
+double FrameScheduler::classification_budget;
+double FrameScheduler::drawing_budget;
+double FrameScheduler::buffer_spill_budget;
+const double FrameScheduler::costSmoothing = 0.2;
+
+
+void FrameScheduler::setFrameRate( double _frameRate )
+{
+	if( _frameRate>0 ) pFramePeriod = 1000/_frameRate;
+}
+
+double FrameScheduler::framePeriod() const
+{
+	return pFramePeriod;
+}
+
+
+void FrameScheduler::frameArrived()
+{
+	frameArrived( now() );
+}
+
+void FrameScheduler::frameArrived( double _arrivalTime )
+{
+	pArrivalTime = _arrivalTime;
+	pConsumed.assign( NR_OF_OPTIONAL_STAGES, 0 );
+}
+
+
+double FrameScheduler::arrivalTime() const
+{
+	return pArrivalTime;
+}
+
+double FrameScheduler::deadline() const
+{
+	return pArrivalTime+pFramePeriod;
+}
+
+double FrameScheduler::elapsed() const
+{
+	return now()-pArrivalTime;
+}
+
+double FrameScheduler::remaining() const
+{
+	return deadline()-now();
+}
+
+
+double FrameScheduler::budget( OptionalStage _stage ) const
+{
+	double left = remaining();
+	if( pStageBudget[_stage]>0 ) return min( pStageBudget[_stage]-pConsumed[_stage], left );
+	return left;
+}
+
+bool FrameScheduler::allows( OptionalStage _stage, double _estimatedCost ) const
+{
+	if( pStageBudget[_stage]<0 ) return true;
+	return _estimatedCost < budget(_stage);
+}
+
+bool FrameScheduler::allows( OptionalStage _stage ) const
+{
+	return allows( _stage, pEstimatedCost[_stage] );
+}
+
+
+void FrameScheduler::reportCost( OptionalStage _stage, double _cost )
+{
+	pConsumed[_stage] += _cost;
+	if( pEstimatedCost[_stage]==0 ) pEstimatedCost[_stage] = _cost;
+	else pEstimatedCost[_stage] = (1-costSmoothing)*pEstimatedCost[_stage] + costSmoothing*_cost;
+}
+
+double FrameScheduler::estimatedCost( OptionalStage _stage ) const
+{
+	return pEstimatedCost[_stage];
+}
+
+double FrameScheduler::consumed( OptionalStage _stage ) const
+{
+	return pConsumed[_stage];
+}
+
+
+void FrameScheduler::setStageBudget( OptionalStage _stage, double _budget )
+{
+	pStageBudget[_stage] = _budget;
+}
+
+double FrameScheduler::stageBudget( OptionalStage _stage ) const
+{
+	return pStageBudget[_stage];
+}
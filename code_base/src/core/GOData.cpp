@@ -179,7 +179,6 @@ bool GenericObject::GOData::registerClass()
 	// register class as generic object type
 	genericObjectClasses.push_back( this );
 	int genericId = genericObjectClasses.size()-1;
-	genericObjectLists.resize( genericObjectClasses.size() );
 
 	classTypeLikelihoodFunctions.resize( genericObjectClasses.size() );
 	initializeStdTypeLikelihood( classTypeLikelihoodFunctions.back() );
@@ -187,7 +186,6 @@ bool GenericObject::GOData::registerClass()
 	if( genericToOverallClassIds.size() <= (overallClassId+1) ) genericToOverallClassIds.resize(overallClassId+1,-1);
 	genericToOverallClassIds[overallClassId] = genericId;
 
-	classifier.resize( genericObjectClasses.size(), NULL );
 	return true;
 }
 
@@ -22,6 +22,9 @@
 #include "GenericObject.h"
 #include "objecthandler.h"
 #include "Dynamics.h"
+#include "StreamContext.h"
+#include "boost/bind.hpp"
+#include <set>
 
 
 GenericObject::GenericObject( ObjectHandler* _environmentControl, int _genericClassId ): SceneObject(_environmentControl), pGenericClassId( _genericClassId )
@@ -61,9 +64,14 @@ Ptr<SceneObject> GenericObject::createGenericObject( SceneObject* _toCopy )
 {
 	int genId = genericId( _toCopy->type() );
 	Ptr<SceneObject> newGO = new GenericObject( _toCopy, genId );
-	Ptr<GenericObject> copy(newGO);
-	copy.addref();
-	genericObjectLists[ genId ].push_back( copy ); // register new generic object with correct class
+	if( _toCopy->environment()!=NULL )
+	{
+		Ptr<GenericObject> copy(newGO);
+		copy.addref();
+		StreamContext& stream = _toCopy->environment()->stream();
+		boost::mutex::scoped_lock lock( stream.genericObjectsMutex() );
+		stream.genericObjects( genId ).push_back( copy ); // register new generic object with correct class
+	}
 	
 	return newGO;
 }
@@ -129,9 +137,11 @@ bool GenericObject::initializeClass( int _classId, ObjectHandler* _environment )
 			throw 1;
 		}
 		
-		classifier[genId] = getClassifier( positiveFeatureSets, negativeFeatureSets );
+		// the classifier depends on the types in the scene and thus belongs to the stream, streams with the same types share the loaded instance
+		Ptr<CvBoost>& classifier = _environment->stream().classifier( genId );
+		classifier = getClassifier( positiveFeatureSets, negativeFeatureSets );
 
-		if( classifier[genId] == NULL ) throw 1; // if getClassifier method failed
+		if( classifier == NULL ) throw 1; // if getClassifier method failed
 
 		return true;
 	}
@@ -163,11 +173,8 @@ void GenericObject::setClassOptions( GenericMultiLevelMap<string>& _options, int
 	{
 		genericObjectClasses[genId]->dynamicsOptions = _options["dynamics_options"];
 		
-		// update dynamics options for already instantiated objects of the class
-        for( list<Ptr<GenericObject> >::iterator it = genericObjectLists[genId].begin(); it != genericObjectLists[genId].end(); it++ )
-		{
-			(*it)->pDynamics->setOptions( _options["dynamics_options"] );
-		}
+		// update dynamics options for already instantiated objects of the class in all streams
+		StreamContext::forEachStream( boost::bind( &GenericObject::setDynamicsOptions, _1, genId, boost::ref( _options["dynamics_options"] ) ) );
 	}
 
 	if( _options.hasKey("type_likelihood_function") )
@@ -419,13 +426,13 @@ double GenericObject::predictArea()
 }
 
 
-bool GenericObject::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color )
+bool GenericObject::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay )
 {
-	return pDynamics->drawLayer( _img, _layerLevel, _color );
+	return pDynamics->drawLayer( _img, _layerLevel, _color, _overlay );
 }
 
 
-double GenericObject::isType( Mat& /*_img*/, RectangleRegion& /*_boundingRect*/, Mat& _descriptors, int /*_id*/, int _classId )
+double GenericObject::isType( Mat& /*_img*/, RectangleRegion& /*_boundingRect*/, Mat& _descriptors, int /*_id*/, int _classId, ObjectHandler* _environment )
 {
 	
 	Mat descriptors =_descriptors;
@@ -438,10 +445,11 @@ double GenericObject::isType( Mat& /*_img*/, RectangleRegion& /*_boundingRect*/,
 	
 	int genId = genericId(_classId);
 	
-	if( classifier[genId]==NULL ) return 0.0;
+	Ptr<CvBoost> classifier = _environment->stream().classifier( genId );
+	if( classifier==NULL ) return 0.0;
 
 	Mat predictionResults;
-	for( int i=0; i<descriptors.size().height; i++ ) predictionResults.push_back( classifier[genId]->predict( descriptors.row(i) ) );
+	for( int i=0; i<descriptors.size().height; i++ ) predictionResults.push_back( classifier->predict( descriptors.row(i) ) );
 	
 
 	double percentageOfPositivelyClassifiedKeypoints = ((double) norm( predictionResults, NORM_L1 ) )/predictionResults.size().height;
@@ -554,12 +562,16 @@ void GenericObject::unregisterObject( Ptr<SceneObject> _old )
 	int genId = genericId( _old->type() );
 
 	Ptr<GenericObject> toUR(_old);
+	if( _old->environment()==NULL ) return;
 	
-    for( list<Ptr<GenericObject> >::iterator it = genericObjectLists[genId].begin(); it != genericObjectLists[genId].end() ; it++ )
+	StreamContext& stream = _old->environment()->stream();
+	boost::mutex::scoped_lock lock( stream.genericObjectsMutex() );
+	list<Ptr<GenericObject> >& objects = stream.genericObjects( genId );
+    for( list<Ptr<GenericObject> >::iterator it = objects.begin(); it != objects.end() ; it++ )
 	{
 		if( (*it) == toUR )
 		{
-			genericObjectLists[genId].erase(it);
+			objects.erase(it);
 			break;
 		}
 	}
@@ -568,6 +580,18 @@ void GenericObject::unregisterObject( Ptr<SceneObject> _old )
 }
 
 
+void GenericObject::setDynamicsOptions( StreamContext& _stream, unsigned int _genId, GenericMultiLevelMap<string>& _options )
+{
+	boost::mutex::scoped_lock lock( _stream.genericObjectsMutex() );
+	list<Ptr<GenericObject> >& objects = _stream.genericObjects( _genId );
+	for( list<Ptr<GenericObject> >::iterator it = objects.begin(); it != objects.end(); it++ )
+	{
+		(*it)->pDynamics->setOptions( _options );
+	}
+	return;
+}
+
+
 void GenericObject::initializeStdTypeLikelihood( vector<double>& _likelihoodVector )
 {
 	_likelihoodVector.clear();
@@ -635,9 +659,6 @@ const int& GenericObject::path_fadeout_speed()
 bool GenericObject::setupClass()
 {
     initializeGenericObjectFactory();
-	
-	// initialize size of vector for CvBoost pointers
-	classifier.resize( genericObjectClasses.size(), NULL );
 
 	// register all generic classes
     registerClasses();
@@ -726,6 +747,45 @@ bool GenericObject::isGenericType( int _classId )
 }
 
 
+/** size of the blocks allocated by an OpenCV memory storage */
+static size_t storageMemUsage( const CvMemStorage* _storage )
+{
+	if( _storage==NULL ) return 0;
+	size_t usage = 0;
+	for( CvMemBlock* block=_storage->bottom; block!=NULL; block=block->next ) usage += _storage->block_size;
+	return usage;
+}
+
+static size_t cvMatMemUsage( const CvMat* _mat )
+{
+	if( _mat==NULL ) return 0;
+	return (size_t)_mat->rows*_mat->step;
+}
+
+size_t GenericObject::classifierMemUsage( const vector<Ptr<CvBoost> >& _classifiers )
+{
+	size_t usage = 0;
+	set<const CvBoost*> counted; // several classes may use the same instance
+	for( unsigned int i=0; i<_classifiers.size(); i++ )
+	{
+		if( _classifiers[i].empty() || !counted.insert( _classifiers[i] ).second ) continue;
+		const Ptr<CvBoost>& classifier = _classifiers[i];
+		usage += sizeof(CvBoost);
+
+		CvSeq* weak = classifier->get_weak_predictors();
+		if( weak!=NULL ) usage += storageMemUsage( weak->storage ) + weak->total*sizeof(CvBoostTree); // the tree nodes and splits live in the storage of the training data
+
+		const CvDTreeTrainData* data = classifier->get_data();
+		if( data==NULL ) continue;
+		usage += sizeof(CvDTreeTrainData) + storageMemUsage( data->tree_storage ) + storageMemUsage( data->temp_storage );
+		usage += cvMatMemUsage( data->buf ) + cvMatMemUsage( data->counts ) + cvMatMemUsage( data->direction ) + cvMatMemUsage( data->split_buf );
+		usage += cvMatMemUsage( data->cat_count ) + cvMatMemUsage( data->cat_ofs ) + cvMatMemUsage( data->cat_map );
+		usage += cvMatMemUsage( data->priors ) + cvMatMemUsage( data->priors_mult ) + cvMatMemUsage( data->var_idx ) + cvMatMemUsage( data->var_type ) + cvMatMemUsage( data->responses_copy );
+	}
+	return usage;
+}
+
+
 void GenericObject::registerClasses()
 {
     for( size_t genericId=0; genericId<genericObjectClasses.size() ; genericId++ )
@@ -791,7 +851,6 @@ Ptr<CvBoost> GenericObject::getClassifier( const vector<Ptr<vector<string> > >&
 	return newClassifier->getInitializedClassifier();
 }
 
-vector<Ptr<CvBoost> > GenericObject::classifier;
 FastFeatureDetector GenericObject::detector(60); //keypoint extraction using the AGAST detector used in BRISK
 BRISK GenericObject::extractor;
 vector<Ptr<GenericObject::GOData> > GenericObject::genericObjectClasses;
@@ -800,7 +859,6 @@ vector<Ptr<GenericObject::FeatureData> > GenericObject::availableFeatureSets;
 vector<Ptr<GenericObject::ClassifierData> > GenericObject::availableClassifiers;
 
 vector<int> GenericObject::genericToOverallClassIds;
-vector<list<Ptr<GenericObject> > > GenericObject::genericObjectLists;
 vector<vector<double> > GenericObject::classTypeLikelihoodFunctions;
 
 
@@ -847,7 +905,6 @@ bool GenericObject::initializeGenericObjectFactory()
     SceneObject::setupObjectList();
 
 	genericToOverallClassIds.resize( (*SceneObject::objectList).size()+genericObjectClasses.size(), -1 );
-	genericObjectLists.resize( genericObjectClasses.size() );
 	classTypeLikelihoodFunctions.resize( genericObjectClasses.size() );
 
     for( uint i=0; i<genericObjectClasses.size(); i++ ) // standard likelihood function
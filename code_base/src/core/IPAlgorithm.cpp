@@ -23,11 +23,14 @@
 #include "IPAlgorithm.h"
 
 map<string,Ptr<IPAlgorithm>(*)()>* IPAlgorithm::registeredAlgorithms=NULL;
+unsigned long IPAlgorithm::lookUpTableVersions=0;
+boost::mutex IPAlgorithm::lookUpTableVersionsMutex;
 
 
 IPAlgorithm::IPAlgorithm(void)
 {
 	active = true;
+	pLookUpTableVersion = newLookUpTableVersion();
 }
 
 
@@ -87,3 +90,46 @@ bool IPAlgorithm::apply( Mat& _image )
 {
 	return process( _image );
 }
+
+
+bool IPAlgorithm::pointWise() const
+{
+	return false;
+}
+
+bool IPAlgorithm::needsImage() const
+{
+	return false;
+}
+
+void IPAlgorithm::updateLookUpTable( const Mat& /*_image*/ )
+{
+	return;
+}
+
+Mat IPAlgorithm::lookUpTable() const
+{
+	boost::mutex::scoped_lock lock( pLookUpTableMutex );
+	return pLookUpTable;
+}
+
+Mat IPAlgorithm::lookUpTable( unsigned long& _version ) const
+{
+	boost::mutex::scoped_lock lock( pLookUpTableMutex );
+	_version = pLookUpTableVersion;
+	return pLookUpTable;
+}
+
+void IPAlgorithm::setLookUpTable( const Mat& _table )
+{
+	unsigned long version = newLookUpTableVersion();
+	boost::mutex::scoped_lock lock( pLookUpTableMutex );
+	pLookUpTable = _table;
+	pLookUpTableVersion = version;
+}
+
+unsigned long IPAlgorithm::newLookUpTableVersion()
+{
+	boost::mutex::scoped_lock lock( lookUpTableVersionsMutex );
+	return ++lookUpTableVersions;
+}
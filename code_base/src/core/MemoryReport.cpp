@@ -0,0 +1,71 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "MemoryReport.h"
+#include <iomanip>
+
+
+MemoryReport::MemoryReport():frameBuffer(0),bufferedFrames(0),compressedBuffer(0),compressedFrames(0),diskSpill(0),spillFiles(0),histories(0),states(0),activeObjects(0),pathImages(0),lostObjects(0),lostCount(0),descriptorSets(0),classifiers(0)
+{
+
+}
+
+
+size_t MemoryReport::total() const
+{
+	return frameBuffer + compressedBuffer + histories + pathImages + lostObjects + descriptorSets + classifiers;
+}
+
+
+void MemoryReport::print( ostream& _out ) const
+{
+	const double MB = 1024.0*1024.0;
+
+	_out<<endl<<left<<setw(28)<<"memory [MB]"<<right<<setw(12)<<"size"<<"  details";
+	_out<<fixed<<setprecision(3);
+	_out<<endl<<left<<setw(28)<<"frame buffer"<<right<<setw(12)<<frameBuffer/MB<<"  "<<bufferedFrames<<" frames";
+	_out<<endl<<left<<setw(28)<<"compressed buffer"<<right<<setw(12)<<compressedBuffer/MB<<"  "<<compressedFrames<<" frames";
+	_out<<endl<<left<<setw(28)<<"object histories"<<right<<setw(12)<<histories/MB<<"  "<<states<<" states of "<<activeObjects<<" objects";
+	_out<<endl<<left<<setw(28)<<"path images"<<right<<setw(12)<<pathImages/MB;
+	_out<<endl<<left<<setw(28)<<"lost objects"<<right<<setw(12)<<lostObjects/MB<<"  "<<lostCount<<" objects";
+	_out<<endl<<left<<setw(28)<<"descriptor sets"<<right<<setw(12)<<descriptorSets/MB;
+	_out<<endl<<left<<setw(28)<<"classifiers"<<right<<setw(12)<<classifiers/MB;
+	_out<<endl<<left<<setw(28)<<"total (RAM)"<<right<<setw(12)<<total()/MB;
+	_out<<endl<<left<<setw(28)<<"spilled to disk"<<right<<setw(12)<<diskSpill/MB<<"  "<<spillFiles<<" files";
+	_out<<endl;
+}
+
+
+void MemoryReport::writeCsv( ostream& _out, unsigned int _frame, double _time, bool _header ) const
+{
+	if( _header ) _out<<"frame,time,frame_buffer,buffered_frames,compressed_buffer,compressed_frames,disk_spill,spill_files,histories,states,active_objects,path_images,lost_objects,lost_count,descriptor_sets,classifiers,total"<<endl;
+
+	_out<<_frame<<","<<_time<<","<<frameBuffer<<","<<bufferedFrames<<","<<compressedBuffer<<","<<compressedFrames<<","<<diskSpill<<","<<spillFiles<<","<<histories<<","<<states<<","<<activeObjects<<","<<pathImages<<","<<lostObjects<<","<<lostCount<<","<<descriptorSets<<","<<classifiers<<","<<total()<<endl;
+}
+
+
+size_t MemoryReport::matMemUsage( const Mat& _mat, set<const uchar*>& _counted )
+{
+	if( _mat.empty() || _mat.datastart==NULL ) return 0;
+	if( !_counted.insert( _mat.datastart ).second ) return 0; // already counted
+
+	return _mat.dataend - _mat.datastart;
+}
@@ -138,14 +138,52 @@ GenericMultiLevelMap<string>* Options::generalSettingsStandard()
 	(*General)["display"]["general"]["draw_observation_area"]["B"].as<double>()=55; // [12] 
 	
 	(*General)["runtime"]["memory"]["max_video_ram_usage"].as<int>()=0; // [13] MB: maximal size of memory used for video frames {affects: VideoBuffer }
+	(*General)["runtime"]["memory"]["max_compressed_ram_usage"].as<int>()=0; // [75] MB: memory for frames that left the uncompressed buffer and are kept compressed (format as set in runtime/compression), 0: no compressed buffer. Not used if record_input is set {affects: VideoBuffer }
 	(*General)["runtime"]["memory"]["temporary_folder_path"].as<string>()="temp"; // [14] {affects: VideoBuffer }
-
-	(*General)["runtime"]["buffer"]["activated"].as<bool>()=true; // [15] ((leave as is! - not yet completely implemented)) if deactivated then no buffering at all takes place, only last frame is saved {affects: SceneHandler}
-	(*General)["runtime"]["buffer"]["record_input"].as<bool>() = false; // [16] if set then everything that is put into the VideoBuffer gets recorded (lossless) until the program exits -> takes vast amount of hard disk space! {affects: VideoBuffer }
+	(*General)["runtime"]["memory"]["report_interval"].as<unsigned int>()=0; // [56] [nr of frames] if >0 then a memory report (see memoryReport() in SceneHandler) is created every report_interval frames {affects: SceneHandler}
+	(*General)["runtime"]["memory"]["report_file"].as<string>()=""; // [57] csv file the periodic memory reports are appended to, if empty they are printed to the console {affects: SceneHandler}
+
+	(*General)["runtime"]["buffer"]["activated"].as<bool>()=true; // [15] if deactivated then no buffering at all takes place, only the current frame is kept (lean mode for headless tracking: the memory used for frames stays constant, but no frame history is available) {affects: SceneHandler}
+	(*General)["runtime"]["buffer"]["record_input"].as<bool>() = false; // [16] if set then everything that is put into the VideoBuffer gets recorded (lossless, to a raw frame archive that can be read back through the VideoBuffer) until the program exits -> takes vast amount of hard disk space! {affects: VideoBuffer }
+	(*General)["runtime"]["buffer"]["spill_queue_length"].as<unsigned int>()=16; // [73] [nr of frames] frames recorded with record_input are written to the hard disk on a thread of their own, this many frames may wait for it {affects: SpillWriter}
+	(*General)["runtime"]["buffer"]["spill_drop"].as<bool>()=false; // [74] what happens if the spill queue is full: true: the frame is dropped (and counted in the spill statistics), false: processing waits until the writer has room again (no frame is lost) {affects: SpillWriter}
+	(*General)["runtime"]["buffer"]["record_overlay"].as<bool>()=false; // [78] if true then record_input only records the original frames together with a list of the figures drawn into them (FrameOverlay): about half the disk space and bandwidth. The edited frames are rendered from the two when they are loaded (without preprocessing effects and the accumulated paths of path_length -1 and -2, OverlayRenderer rebuilds those when exporting the recording as a video) {affects: VideoBuffer, SceneHandler}
+	(*General)["runtime"]["buffer"]["record_thumbnails"].as<bool>()=false; // [79] if true then record_input only records the areas of the tracked objects (their last regions of interest plus thumbnail_margin) with their track id, and the whole frame as background every keyframe_interval frames (ThumbnailArchive): a fraction of the disk space if the objects cover a small part of the frames. Frames loaded from the recording are approximate (the last keyframe with the object areas of the frame pasted in), the thumbnails of an object can be loaded on their own. Takes precedence over record_overlay {affects: VideoBuffer, SceneHandler}
+	(*General)["runtime"]["buffer"]["thumbnail_margin"].as<int>()=8; // [80] [px] margin added on every side of the object areas recorded with record_thumbnails {affects: ThumbnailArchive}
+	(*General)["runtime"]["buffer"]["keyframe_interval"].as<unsigned int>()=250; // [81] [nr of frames] with record_thumbnails the whole frame is recorded as background every keyframe_interval frames (and whenever the frame format changes), 0: only the first frame {affects: ThumbnailArchive}
+	(*General)["runtime"]["buffer"]["keep_archive"].as<bool>()=false; // [77] if true then the archive the recorded frames are written to (<temporary_folder_path>/~tmp<time>.mfa and .mfi, see FrameArchive, and .mti with record_thumbnails, see ThumbnailArchive) is kept when the program exits instead of being deleted {affects: VideoBuffer}
 	
-	(*General)["runtime"]["compression"]["format"].as<string>()=".PNG"; // [17] format used for compressing the temporary saved video stream on runtime, options: currently only .PNG, .JPEG (->openCV would support more)
+	(*General)["runtime"]["compression"]["format"].as<string>()=".PNG"; // [17] format used for compressing the frames of the compressed buffer (see max_compressed_ram_usage), options: currently only .PNG, .JPEG (->openCV would support more)
 	(*General)["runtime"]["compression"]["png_compression_level"].as<int>()=1; // [18] 0 to 9: openCV default is 3, higher compression levels take more time for computing
 	(*General)["runtime"]["compression"]["jpeg_quality"].as<int>()=100; // [19] 0 to 100
+	(*General)["runtime"]["compression"]["threads"].as<unsigned int>()=2; // [76] number of threads compressing the frames for the compressed buffer (see max_compressed_ram_usage), frames that arrive while all of them are busy are dropped from the buffer {affects: VideoBuffer}
+
+	(*General)["runtime"]["profiling"]["activated"].as<bool>()=false; // [51] if true then the time spent in each processing stage is measured, the statistics can be accessed through profile() in SceneHandler {affects: SceneHandler}
+	(*General)["runtime"]["profiling"]["window_size"].as<unsigned int>()=1000; // [52] [nr of frames] number of the latest measurements per stage from which the profiling statistics are calculated {affects: SceneHandler}
+
+	(*General)["runtime"]["tracing"]["activated"].as<bool>()=false; // [58] if true then a timeline of the processing stages, the classified objects and the object counts is written to the trace file (Chrome trace event format, view it with chrome://tracing or ui.perfetto.dev), can also be started at runtime through tracer() in SceneHandler {affects: SceneHandler}
+	(*General)["runtime"]["tracing"]["file"].as<string>()="trace.json"; // [59] file the trace is written to, it is overwritten for each new SceneHandler {affects: SceneHandler}
+
+	(*General)["runtime"]["pipeline"]["activated"].as<bool>()=false; // [60] if true then preprocessing, detection and tracking of consecutive frames run in parallel on separate threads: pushFrame() returns before the frame is processed, see setPipelined() in SceneHandler {affects: SceneHandler}
+	(*General)["runtime"]["pipeline"]["queue_length"].as<unsigned int>()=2; // [61] [nr of frames] number of frames that may wait in front of each pipeline stage, pushFrame() blocks if the first stage is full {affects: SceneHandler}
+	(*General)["runtime"]["pipeline"]["detection_threads"].as<unsigned int>()=1; // [67] number of threads the detection (threshold, contours, moments) runs on in pipelined mode: with more than one the detection of the following frames runs ahead in parallel (useful for the offline processing of recorded videos), the tracking still consumes the frames in order {affects: SceneHandler}
+
+	(*General)["runtime"]["capture"]["buffer_size"].as<unsigned int>()=2; // [62] [nr of frames] number of frames an AsyncCapture buffers {affects: AsyncCapture}
+	(*General)["runtime"]["capture"]["drop_policy"].as<string>()="auto"; // [63] what an AsyncCapture does if its buffer is full: "newest": drop the oldest frame (always process the newest frames, for live cameras), "none": wait for room (never drop, for video files), "auto": newest for cameras, none for files {affects: AsyncCapture}
+
+	(*General)["runtime"]["pool"]["workers"].as<unsigned int>()=0; // [68] number of worker threads a SceneHandlerPool shares among its streams, 0: one per core {affects: SceneHandlerPool}
+	(*General)["runtime"]["pool"]["queue_length"].as<unsigned int>()=2; // [69] [nr of frames] number of frames per stream that may wait for a worker of a SceneHandlerPool, pushFrame() blocks if the stream's queue is full, 0: no limit {affects: SceneHandlerPool}
+
+	(*General)["runtime"]["observation_area"]["crop_early"].as<bool>()=false; // [70] if true then frames are cropped to the observation area (see setObservationArea() in SceneHandler) right after the initial processing: preprocessing, greyscale extraction, buffering and the output then only cover the observation area {affects: SceneHandler}
+	(*General)["runtime"]["observation_area"]["buffer_full_frame"].as<bool>()=true; // [71] if crop_early is set: true: the buffered original still contains the whole frame (e.g. for recording), false: it is cropped as well {affects: SceneHandler}
+
+	(*General)["runtime"]["ingest"]["monochrome"].as<bool>()=false; // [64] if true then colour input is reduced to its first channel (the one objects are detected in) before it enters the pipeline, colour is only created for the output if annotations are drawn into it {affects: SceneHandler}
+	(*General)["runtime"]["ingest"]["window_low"].as<double>()=0; // [65] input with more than 8 bits per channel (e.g. 12 or 16 bit cameras) is mapped linearly to 8 bits: values at or below window_low become black {affects: SceneHandler}
+	(*General)["runtime"]["ingest"]["window_high"].as<double>()=-1; // [66] values at or above window_high become white, negative: the maximum of the input type (65535 for 16 bit images, set 4095 for 12 bit cameras) {affects: SceneHandler}
+
+	(*General)["runtime"]["scheduling"]["classification_budget"].as<double>()=0; // [53] [ms] time per frame classification may use: <0: not limited by the frame deadline, 0: whatever is left of the frame period, >0: at most this much (and not more than what is left). Only applies if classification/time_awareness is set {affects: SceneHandler}
+	(*General)["runtime"]["scheduling"]["drawing_budget"].as<double>()=-1; // [54] [ms] time per frame drawing the object information into the output may use, same semantics as classification_budget: if drawing doesn't fit into the frame anymore, the output of the frame stays without annotations {affects: SceneHandler}
+	(*General)["runtime"]["scheduling"]["buffer_spill_budget"].as<double>()=-1; // [55] [ms] time per frame handing buffered frames to the disk writer may use (only relevant if record_input is set, the encoding itself runs on a thread of its own: handing frames over only takes time if the writer's queue is full), same semantics as classification_budget: dumps that don't fit are postponed to later frames {affects: SceneHandler}
 
 	(*General)["video_content_descriptions"]["min_area"].as<double>()=100; // [20] [px^2], objects in image with smaller areas are not considered, unless their contour length is long enough (see contour_length_switch) {affects: ObjectHandler}
 	(*General)["video_content_descriptions"]["max_area"].as<double>()=2000; // [21] [px^2], objects in image with larger areas are not considered {affects: ObjectHandler}
@@ -160,6 +198,9 @@ GenericMultiLevelMap<string>* Options::generalSettingsStandard()
 	(*General)["object_detection"]["max_object_gridpoint_distance"].as<double>()=5.0; // [29] [px] max distance between grid points in grid point generation over predicted object surface used to calculate surface overlap area estimation if using the center point position prediction (and old position) failed to produce a match for a known object {affects:ObjectHandler, SceneObject}
 	(*General)["object_detection"]["static_threshold"].as<unsigned int>()=220; // [30] [color] determines which color value will be used in the object detection algorithm when thresholding the image to obtain a binary black and white {affects: ObjectHandler}
 	(*General)["object_detection"]["window_border_range"].as<unsigned int>()=20; // [31] [px] defines the distance from the window border which is considered as the leaving area for objects: if an object is lost in this area, it is considered to have left the visible area {affects: ObjectHandler}
+	(*General)["object_detection"]["pyramid_levels"].as<unsigned int>()=0; // [72] number of times the frame is halved (image pyramid) before it is thresholded and searched for contours, the contours are scaled back and the object states are still calculated on the full resolution image. Speeds up detection on large frames with objects that are much larger than 2^pyramid_levels pixels, 0 detects at full resolution {affects: ObjectHandler}
+	(*General)["object_detection"]["pyramid_region_growth"].as<double>()=1; // [82] [blocks] contours found on a pyramid level run through the centres of the blocks of 2^pyramid_levels x 2^pyramid_levels pixels on their border, which lie about half a block inside the object outline: the contours are grown by this many blocks (less one pixel) before their area and length are filtered and their regions and ROIs are calculated, 1 restores the full object extent {affects: ObjectHandler}
+	(*General)["object_detection"]["missing_search_pyramid_level"].as<unsigned int>()=0; // [83] pyramid level the corner search for merged objects runs on (the pyramid built for the detection is shared, the level is limited to pyramid_levels), the corners found are scaled back to full resolution. Higher levels are faster but locate the objects less precisely, 0 searches at full resolution {affects: ObjectHandler}
 
 	(*General)["object_detection"]["ABFSpiral"]["velocity_moving_average_width"].as<unsigned int>()=16; // [32] number of samples used for moving average filter of velocity, must be a power of two (for speed purposes, shift operations are used instead of division...) {affects: ABFSpiral}
 	(*General)["object_detection"]["ABFSpiral"]["angle_moving_average_width"].as<unsigned int>()=10; // [33] number of samples used for moving average filter of angle {affects: ABFSpiral}
@@ -0,0 +1,95 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "OverlayRenderer.h"
+#include "Options.h"
+#include <iostream>
+
+
+OverlayRenderer::OverlayRenderer():pFramesSinceLastFade(0)
+{
+	setupOptions();
+}
+
+
+void OverlayRenderer::setupOptions()
+{
+	Options::load_options();
+	path_fadeout_speed = (*Options::General)["display"]["objects"]["path_fadeout_speed"].as<int>();
+}
+int OverlayRenderer::path_fadeout_speed;
+
+
+void OverlayRenderer::reset()
+{
+	pPathImage.release();
+	pFramesSinceLastFade = 0;
+}
+
+
+void OverlayRenderer::render( const Mat& _original, const FrameOverlay& _overlay, Mat& _annotated )
+{
+	// fades the path image the way ObjectHandler::draw() does
+	if( pPathImage.empty() || pPathImage.size()!=_original.size() ) pPathImage = Mat( _original.size().height, _original.size().width, CV_8UC3, CV_RGB(0,0,0) );
+	else if( pFramesSinceLastFade++ >= path_fadeout_speed || path_fadeout_speed<0 )
+	{
+		pPathImage -= Scalar(1,1,1);
+		pFramesSinceLastFade = 0;
+	}
+
+	_overlay.render( _original, _annotated, &pPathImage );
+}
+
+
+unsigned long OverlayRenderer::exportVideo( const FrameArchive& _archive, const string& _file, double _frameRate, int _fourcc, unsigned long _first, unsigned long _last )
+{
+	if( _archive.size()==0 || _first>=_archive.size() ) return 0;
+	if( _last>=_archive.size() ) _last = _archive.size()-1;
+
+	// the paths are accumulated from the beginning of the archive on, the frames before _first are rendered but not written
+	reset();
+	VideoWriter writer;
+	unsigned long written = 0;
+	for( unsigned long i=0; i<=_last; i++ )
+	{
+		Mat original, annotated;
+		Ptr<FrameOverlay> overlay;
+		double time;
+		if( !_archive.loadOriginal( i, original, overlay, time ) ) break;
+
+		if( !overlay.empty() ) render( original, *overlay, annotated );
+		else
+		{
+			Frame recorded;
+			if( !_archive.load( i, recorded ) ) break;
+			annotated = recorded.edited();
+		}
+		if( i<_first ) continue;
+
+		if( !writer.isOpened() && !writer.open( _file, _fourcc, _frameRate, annotated.size(), annotated.channels()!=1 ) )
+		{
+			cerr<<endl<<"OverlayRenderer::exportVideo:: Could not open "<<_file<<" for writing."<<endl;
+			return 0;
+		}
+		writer<<annotated;
+		written++;
+	}
+	return written;
+}
@@ -0,0 +1,239 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Profiler.h"
+#include "Options.h"
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+
+
+Profiler::Section::Section( Profiler& _profiler, Stage _stage ):pProfiler(NULL),pStage(_stage),pStart(0)
+{
+	if( !_profiler.active() && !_profiler.tracing() ) return;
+	pProfiler = &_profiler;
+	pStart = now();
+}
+
+Profiler::Section::~Section()
+{
+	stop();
+}
+
+void Profiler::Section::addArgument( const string& _name, double _value )
+{
+	if( pProfiler==NULL ) return;
+	pArguments.push_back( make_pair( _name, _value ) );
+}
+
+void Profiler::Section::stop()
+{
+	if( pProfiler==NULL ) return;
+	double duration = now()-pStart;
+	pProfiler->record( pStage, duration );
+	if( pProfiler->tracing() ) pProfiler->pTracer->complete( stageName(pStage), pStart, duration, pArguments );
+	pProfiler = NULL;
+}
+
+
+
+Profiler::Profiler():pActive(false),pWindowSize(1000),pTracer(NULL),pCurrentFrameTime(0),pSlowFrameCount(0)
+{
+	setupOptions();
+	pActive = profiling_activated;
+	setWindowSize( profiling_window_size );
+}
+
+
+void Profiler::setupOptions()
+{
+	Options::load_options();
+	profiling_activated = (*Options::General)["runtime"]["profiling"]["activated"].as<bool>();
+	profiling_window_size = (*Options::General)["runtime"]["profiling"]["window_size"].as<unsigned int>();
+}
+bool Profiler::profiling_activated;
+unsigned int Profiler::profiling_window_size;
+
+
+void Profiler::setActive( bool _active )
+{
+	pActive = _active;
+}
+
+bool Profiler::active() const
+{
+	return pActive;
+}
+
+void Profiler::setTracer( Tracer* _tracer )
+{
+	pTracer = _tracer;
+}
+
+bool Profiler::tracing() const
+{
+	return pTracer!=NULL && pTracer->active();
+}
+
+void Profiler::setWindowSize( unsigned int _size )
+{
+	pWindowSize = ( _size==0 )? 1 : _size;
+	reset();
+}
+
+
+void Profiler::beginFrame( double _frameTime )
+{
+	if( !pActive ) return;
+	boost::mutex::scoped_lock lock( pMutex );
+	pCurrentFrameTime = _frameTime;
+	pCurrentFrame.assign( NR_OF_STAGES, 0 );
+}
+
+void Profiler::endFrame( double _budget )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive || pCurrentFrame.size()!=NR_OF_STAGES ) return;
+
+	if( _budget>0 && pCurrentFrame[FRAME_TOTAL]>_budget )
+	{
+		pSlowFrameCount++;
+
+		SlowFrame slowFrame;
+		slowFrame.time = pCurrentFrameTime;
+		slowFrame.budget = _budget;
+		slowFrame.stageTimes = pCurrentFrame;
+		slowFrame.dominantStage = INITIAL_PROCESSING;
+		for( int i=0; i<FRAME_TOTAL; i++ )
+		{
+			if( pCurrentFrame[i]>pCurrentFrame[slowFrame.dominantStage] ) slowFrame.dominantStage = (Stage)i;
+		}
+
+		pSlowFrames.push_front( slowFrame );
+		if( pSlowFrames.size()>maxSlowFrames ) pSlowFrames.pop_back();
+	}
+	pCurrentFrame.clear();
+}
+
+
+void Profiler::record( Stage _stage, double _duration )
+{
+	if( !pActive ) return;
+	boost::mutex::scoped_lock lock( pMutex );
+
+	vector<double>& samples = pSamples[_stage];
+	samples[ pNextSample[_stage] ] = _duration;
+	pNextSample[_stage] = ( pNextSample[_stage]+1 )%pWindowSize;
+	if( pSampleCount[_stage]<pWindowSize ) pSampleCount[_stage]++;
+	if( _duration>pAllTimeMax[_stage] ) pAllTimeMax[_stage] = _duration;
+
+	// stages may be entered several times per frame
+	if( pCurrentFrame.size()==NR_OF_STAGES ) pCurrentFrame[_stage] += _duration;
+}
+
+
+Profiler::StageStatistics Profiler::statistics( Stage _stage ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	StageStatistics stats;
+	stats.count = pSampleCount[_stage];
+	stats.allTimeMax = pAllTimeMax[_stage];
+	if( stats.count==0 ) return stats;
+
+	vector<double> sorted( pSamples[_stage].begin(), pSamples[_stage].begin()+stats.count );
+	sort( sorted.begin(), sorted.end() );
+
+	double sum = 0;
+	for( unsigned int i=0; i<sorted.size(); i++ ) sum += sorted[i];
+	stats.mean = sum/stats.count;
+
+	// nearest rank
+	stats.p50 = sorted[ max( (int)ceil( 0.50*stats.count )-1, 0 ) ];
+	stats.p95 = sorted[ max( (int)ceil( 0.95*stats.count )-1, 0 ) ];
+	stats.p99 = sorted[ max( (int)ceil( 0.99*stats.count )-1, 0 ) ];
+	stats.max = sorted.back();
+	return stats;
+}
+
+
+unsigned int Profiler::slowFrameCount() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pSlowFrameCount;
+}
+
+deque<Profiler::SlowFrame> Profiler::slowFrames() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pSlowFrames;
+}
+
+
+void Profiler::report( ostream& _out ) const
+{
+	_out<<endl<<left<<setw(44)<<"stage [ms]"<<right<<setw(8)<<"count"<<setw(10)<<"mean"<<setw(10)<<"p50"<<setw(10)<<"p95"<<setw(10)<<"p99"<<setw(10)<<"max"<<setw(10)<<"all max";
+	for( int i=0; i<NR_OF_STAGES; i++ )
+	{
+		StageStatistics stats = statistics( (Stage)i );
+		_out<<endl<<left<<setw(44)<<stageName( (Stage)i )<<right<<setw(8)<<stats.count<<fixed<<setprecision(3)<<setw(10)<<stats.mean<<setw(10)<<stats.p50<<setw(10)<<stats.p95<<setw(10)<<stats.p99<<setw(10)<<stats.max<<setw(10)<<stats.allTimeMax;
+	}
+	boost::mutex::scoped_lock lock( pMutex );
+	_out<<endl<<"Frames over budget: "<<pSlowFrameCount;
+	if( !pSlowFrames.empty() ) _out<<" (last one at "<<pSlowFrames.front().time<<"ms: "<<pSlowFrames.front().stageTimes[FRAME_TOTAL]<<"ms, mostly spent in "<<stageName( pSlowFrames.front().dominantStage )<<")";
+	_out<<endl;
+}
+
+
+void Profiler::reset()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	pSamples.assign( NR_OF_STAGES, vector<double>( pWindowSize, 0 ) );
+	pNextSample.assign( NR_OF_STAGES, 0 );
+	pSampleCount.assign( NR_OF_STAGES, 0 );
+	pAllTimeMax.assign( NR_OF_STAGES, 0 );
+	pCurrentFrame.clear();
+	pSlowFrameCount = 0;
+	pSlowFrames.clear();
+}
+
+
+string Profiler::stageName( Stage _stage )
+{
+	switch( _stage )
+	{
+		case INITIAL_PROCESSING: return "initialProcessing";
+		case PRE_PROCESS: return "preProcess";
+		case BUFFERING: return "buffering";
+		case PRE_PROCESS_INTERN: return "preProcessIntern";
+		case THRESHOLD: return "threshold";
+		case OBJ_REGIONS: return "objRegions";
+		case ROI_PROPERTIES: return "roiProperties";
+		case PREDICT_PROPERTIES: return "predictProperties";
+		case MATCH_OBJECTS: return "matchObjects";
+		case FIND_POTENTIAL_AREA_MATCHES: return "findPotentialAreaMatchesForMissingObjects";
+		case LOCATE_MISSING_OBJECTS: return "locateMissingObjects";
+		case UPDATE_OBJECTS: return "updateObjects";
+		case DRAW: return "draw";
+		case UPDATE_CLASSIFICATIONS: return "updateClassifications";
+		case FRAME_TOTAL: return "frame total";
+		default: return "unknown";
+	}
+}
@@ -21,12 +21,22 @@
 
 
 #include "SceneHandler.h"
+#include "GenericObject.h"
 #include <iostream>
+#include <fstream>
+#include <map>
+#include "boost/bind.hpp"
 
-SceneHandler::SceneHandler( bool _initializeAllObjectClasses ):pObjectSet( this,&pVideo ),pObservationArea()
+SceneHandler::SceneHandler( bool _initializeAllObjectClasses ):pPipelined(false),pSubmittedFrames(0),pFrameCount(0),pObjectSet( this,&pVideo ),pObservationArea()
 {
 	pFrameRate = standardFrameRate;
+	pScheduler.setFrameRate( pFrameRate );
+	pVideo.setScheduler( &pScheduler );
+	pProfiler.setTracer( &pTracer );
+	pIngestFailureReported = false;
 	setupOptions();
+	pDetectionThreads = ( pipeline_detection_threads==0 )? 1 : pipeline_detection_threads;
+	setPipelined( pipeline_activated );
 	
 	if( _initializeAllObjectClasses )
 	{
@@ -37,15 +47,21 @@ SceneHandler::SceneHandler( bool _initializeAllObjectClasses ):pObjectSet( this,
 
 }
 
-SceneHandler::SceneHandler( double _frameRate ):pObjectSet( this,&pVideo ),pObservationArea()
+SceneHandler::SceneHandler( double _frameRate ):pPipelined(false),pSubmittedFrames(0),pFrameCount(0),pObjectSet( this,&pVideo ),pObservationArea()
 {
 	setFrameRate(_frameRate);
+	pVideo.setScheduler( &pScheduler );
+	pProfiler.setTracer( &pTracer );
+	pIngestFailureReported = false;
 	setupOptions();
+	pDetectionThreads = ( pipeline_detection_threads==0 )? 1 : pipeline_detection_threads;
+	setPipelined( pipeline_activated );
 }
 
 
 SceneHandler::~SceneHandler(void)
 {
+	stopPipeline();
 	/*Mat descriptorSet;
 	//descriptorSet.push_back( ThickHelix::descriptors1 );
 	for( int i=0;i<17; i++ ) descriptorSet.push_back( ThickHelix::descriptors1 );
@@ -93,12 +109,32 @@ void SceneHandler::setupOptions()
 	draw_observation_area_color = Scalar( (*Options::General)["display"]["general"]["draw_observation_area"]["B"].as<double>(), (*Options::General)["display"]["general"]["draw_observation_area"]["G"].as<double>(), (*Options::General)["display"]["general"]["draw_observation_area"]["R"].as<double>() );
 	create_preprocess_filter_image = (*Options::General)["display"]["objects"]["create_preprocess_filter_image"].as<bool>();
 	create_prethreshold_filter_image = (*Options::General)["display"]["objects"]["create_prethreshold_filter_image"].as<bool>();
+	memory_report_interval = (*Options::General)["runtime"]["memory"]["report_interval"].as<unsigned int>();
+	memory_report_file = (*Options::General)["runtime"]["memory"]["report_file"].as<string>();
+	pipeline_activated = (*Options::General)["runtime"]["pipeline"]["activated"].as<bool>();
+	pipeline_queue_length = (*Options::General)["runtime"]["pipeline"]["queue_length"].as<unsigned int>();
+	pipeline_detection_threads = (*Options::General)["runtime"]["pipeline"]["detection_threads"].as<unsigned int>();
+	observation_area_crop_early = (*Options::General)["runtime"]["observation_area"]["crop_early"].as<bool>();
+	observation_area_buffer_full_frame = (*Options::General)["runtime"]["observation_area"]["buffer_full_frame"].as<bool>();
+	monochrome_ingest = (*Options::General)["runtime"]["ingest"]["monochrome"].as<bool>();
+	ingest_window_low = (*Options::General)["runtime"]["ingest"]["window_low"].as<double>();
+	ingest_window_high = (*Options::General)["runtime"]["ingest"]["window_high"].as<double>();
 }
 bool SceneHandler::create_preprocess_filter_image;
 bool SceneHandler::create_prethreshold_filter_image;
 bool SceneHandler::draw_observation_area;
 Scalar SceneHandler::draw_observation_area_color;
 bool SceneHandler::buffering_activated;
+unsigned int SceneHandler::memory_report_interval;
+string SceneHandler::memory_report_file;
+bool SceneHandler::pipeline_activated;
+unsigned int SceneHandler::pipeline_queue_length;
+unsigned int SceneHandler::pipeline_detection_threads;
+bool SceneHandler::observation_area_crop_early;
+bool SceneHandler::observation_area_buffer_full_frame;
+bool SceneHandler::monochrome_ingest;
+double SceneHandler::ingest_window_low;
+double SceneHandler::ingest_window_high;
 
 
 
@@ -213,7 +249,27 @@ bool SceneHandler::loadFromFile( string _filePath )
 
 void SceneHandler::pushFrame( Mat _frame, double _time )
 {
-	pTime = msTime(); // safe the actual global time
+	pushFrame( _frame, _time, FrameScheduler::now() );
+}
+
+
+void SceneHandler::pushFrame( Mat _frame, double _time, double _arrivalTime )
+{
+	if( pPipelined )
+	{
+		Ptr<FrameJob> job = new FrameJob( _frame.clone(), _time, pSubmittedFrames++ ); // the caller may reuse its buffer while the frame waits in the queue
+		job->arrival = _arrivalTime;
+		pTime = job->arrival;
+		pPreProcessQueue.push( job ); // waits while the pipeline is full
+		return;
+	}
+
+	pScheduler.frameArrived( _arrivalTime );
+	pTime = pScheduler.arrivalTime(); // safe the actual global time
+	pProfiler.beginFrame( _time );
+	Profiler::Section frameSection( pProfiler, Profiler::FRAME_TOTAL );
+	frameSection.addArgument( "frame", pFrameCount );
+	frameSection.addArgument( "time", _time );
 	//ellipse(_frame, Point(30,30), Size(20,18),40,0,360,Scalar(40,40,40),3);
 	/*if( true||count<175 ) // write additional object into video
 	{
@@ -251,99 +307,367 @@ void SceneHandler::pushFrame( Mat _frame, double _time )
 		}
 	}
 	count++;*/
+	FrameJob job( _frame, _time, pFrameCount );
+	job.arrival = pTime;
+	prepareFrame( job );
+	if( !job.failed )
+	{
+		pObjectSet.detect( job.forCalculations, job.detection );
+		finishFrame( job );
+	}
+	else
+	{
+		boost::mutex::scoped_lock progressLock( pProgressMutex );
+		pFrameCount++;
+	}
+
+	frameSection.stop();
+	pProfiler.endFrame( pScheduler.framePeriod() );
+	return;
+}
+
+
+SceneHandler::FrameJob::FrameJob( Mat _original, double _time, unsigned int _number ):original(_original),time(_time),number(_number),arrival( FrameScheduler::now() ),failed(false)
+{
+
+}
+
+
+void SceneHandler::prepareFrame( FrameJob& _job )
+{
 	// initial processing and conversion
-	//double time1 = msTime();
+	Profiler::Section initialSection( pProfiler, Profiler::INITIAL_PROCESSING );
+	if( !initialProcessing( _job.original ) )
+	{
+		_job.failed = true; // the unreduced frame must not reach detection and the buffer
+		return;
+	}
 
-	initialProcessing( _frame );
+	// with early cropping all further stages only see the observation area, the buffered original optionally keeps the whole frame
+	Mat toEdit = _job.original;
+	Rect area = clippedObservationArea( _job.original.size() );
+	bool cropEarly = observation_area_crop_early && area.area()!=0;
+	if( cropEarly )
+	{
+		toEdit = _job.original( area );
+		if( !observation_area_buffer_full_frame )
+		{
+			_job.original = buffering_activated? toEdit.clone() : toEdit; // a view would keep the whole frame alive in the buffer
+			toEdit = _job.original;
+		}
+	}
+	initialSection.stop();
 	
 	// apply pre processing stage to edit image
-    //double t=msTime();
-	Mat toEdit=_frame.clone();
+	Profiler::Section preProcessSection( pProfiler, Profiler::PRE_PROCESS );
+	if( !buffering_activated ) _job.frame = recycledFrame(); // the buffers of the frames that were current before are reused
+	if( stackActive( pPreProcessStack ) ) toEdit = _job.frame.spareCopy( toEdit ); // without preprocessing the edited version shares the original's data until it is drawn into
 	
 	
 	// preprocessing
 	preProcess( toEdit );
 
-	if( create_preprocess_filter_image ) toEdit.copyTo( pPreProcessImage );
-	
-	//double time2 = msTime();
-
-	// buffering
-	Mat forCalculations; //use only grey image for further processing
-	if( buffering_activated )
+	if( create_preprocess_filter_image )
 	{
-        Frame toAdd(_frame, toEdit, _time );
-        pVideo << toAdd;
-		forCalculations = pVideo.grey();
+		Mat preProcessed = toEdit.clone(); // published as a new Mat: a reader may still hold the previous one
+		boost::mutex::scoped_lock lock( pResultMutex );
+		pPreProcessImage = preProcessed;
 	}
-	else
+	_job.frame.set( _job.original, toEdit, _job.time );
+	preProcessSection.stop();
+
+	Mat forCalculations = stackActive( pInternPreProcessStack )? _job.frame.editableGrey() : _job.frame.grey(); //use only grey image for further processing
+
+	// test if an observation range has been specified (and not already applied)
+	if( !cropEarly && area.area()!=0 )
 	{
-		Frame myFrame( _frame, toEdit, _time );
-		pWorkingFrame = myFrame.grey();
-		forCalculations = pWorkingFrame;
+		_job.calculationArea = area;
+		forCalculations = forCalculations( area );
 	}
 	
-	Mat displayOutput = pVideo.loadMat();
+	// intern preprocessing
+	Profiler::Section preProcessInternSection( pProfiler, Profiler::PRE_PROCESS_INTERN );
+	preProcessIntern( forCalculations );
+
 
-	// test if an observation range has been specified
-	if( pObservationArea.area()!=0 )
+	if( create_prethreshold_filter_image )
 	{
-		int xMin = max( pObservationArea.x, 0 );
-		int xMax = min( pObservationArea.x+pObservationArea.width, forCalculations.size().width );
-		int yMin = max( pObservationArea.y, 0 );
-		int yMax = min( pObservationArea.y+pObservationArea.height, forCalculations.size().height );
-		Rect draw(xMin,yMin,xMax-xMin,yMax-yMin);
-		if( draw_observation_area ) rectangle(displayOutput, draw, draw_observation_area_color );
-		Range colRange( xMin, xMax );
-		Range rowRange( yMin, yMax );
+		Mat preThreshold = forCalculations.clone();
+		boost::mutex::scoped_lock lock( pResultMutex );
+		pPreThresholdImage = preThreshold;
+	}
+	preProcessInternSection.stop();
+
+	_job.forCalculations = forCalculations;
+	return;
+}
+
+
+void SceneHandler::finishFrame( FrameJob& _job )
+{
+	// the output is copied (and converted to colour if it is monochrome) only if something is going to be drawn into it (drawing is never allowed later in the frame if it isn't now)
+	bool annotate = pScheduler.allows( FrameScheduler::DRAWING ) || ( draw_observation_area && _job.calculationArea.area()!=0 );
+	Mat displayOutput = annotate? _job.frame.annotatableEdited() : _job.frame.edited();
 
-		forCalculations = forCalculations(rowRange,colRange);
-		displayOutput = displayOutput(rowRange,colRange);
+	// when recording the annotations as an overlay, everything drawn is recorded into it as well (in coordinates of the whole frame)
+	Ptr<FrameOverlay> overlay;
+	if( buffering_activated && VideoBuffer::recordsOverlay() )
+	{
+		overlay = new FrameOverlay();
+		// early cropping with the whole frame buffered: the edited version is the observation area of the original
+		if( _job.frame.edited().size()!=_job.frame.original().size() ) overlay->setOrigin( clippedObservationArea( _job.frame.original().size() ).tl() );
 	}
-	
-	//double time3 = msTime();
-	// intern preprocessing
-	preProcessIntern( forCalculations );
 
+	if( _job.calculationArea.area()!=0 )
+	{
+		if( draw_observation_area )
+		{
+			rectangle(displayOutput, _job.calculationArea, draw_observation_area_color );
+			if( !overlay.empty() ) overlay->rectangle( 0, _job.calculationArea, draw_observation_area_color );
+		}
+		displayOutput = displayOutput(_job.calculationArea);
+		if( !overlay.empty() ) overlay->setOrigin( _job.calculationArea.tl() );
+	}
 
-	if( create_prethreshold_filter_image ) forCalculations.copyTo( pPreThresholdImage );
+	pObjectSet.track( _job.detection, displayOutput, _job.time, overlay );
+	if( !overlay.empty() ) _job.frame.setOverlay( overlay );
 
-	//double time4 = msTime();
+	// when recording only the object thumbnails, the frame needs to know where the objects are (in coordinates of the original)
+	if( buffering_activated && VideoBuffer::recordsThumbnails() )
+	{
+		vector<Frame::ObjectRegion> regions;
+		pObjectSet.objectRegions( regions );
+		Point origin = _job.calculationArea.tl();
+		if( _job.frame.edited().size()!=_job.frame.original().size() ) origin = clippedObservationArea( _job.frame.original().size() ).tl();
+		for( size_t i=0; i<regions.size(); i++ ) regions[i].area += origin;
+		_job.frame.setObjectRegions( regions );
+	}
 
-	
-	/*ofstream file;
-	file.open( "chronometries.txt", ios_base::app );
-	file<<time2-time1<<" "<<time3-time2<<" "<<time4-time3<<" "<<time4-time1<<" ";
-	file.close();*/
+	// buffering: the video buffer copies the frame into one of its slots, it is thus buffered once everything has been drawn into it
+	Profiler::Section bufferSection( pProfiler, Profiler::BUFFERING );
+	boost::mutex::scoped_lock resultLock( pResultMutex );
+	if( buffering_activated ) pVideo << _job.frame;
+	else
+	{
+		if( !pWorkingFrame.original().empty() ) pFreeFrames.push_back( pWorkingFrame ); // its buffers are reused as soon as no caller holds them anymore
+		pWorkingFrame = _job.frame;
+	}
+	resultLock.unlock();
+	bufferSection.stop();
 
+	if( pFrameListener ) pFrameListener( _job.number, FrameScheduler::now()-_job.arrival );
 
-	pObjectSet.pushFrame( forCalculations, displayOutput, _time );
-	//double time5 = msTime();
-	
-	/*file.open( "chronometries.txt", ios_base::app );
-	file<<" "<<time5-time1<<endl;
-	file.close();*/
-	
+	boost::mutex::scoped_lock progressLock( pProgressMutex );
+	pFrameCount++;
+	pFrameFinished.notify_all();
+	progressLock.unlock();
+
+	if( memory_report_interval>0 && pFrameCount%memory_report_interval==0 ) periodicMemoryReport( _job.time );
 	return;
 }
 
 
+Frame SceneHandler::recycledFrame()
+{
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( pFreeFrames.empty() ) return Frame();
+	Frame frame = pFreeFrames.front();
+	pFreeFrames.pop_front();
+	lock.unlock();
+
+	frame.recycle();
+	return frame;
+}
+
+
+void SceneHandler::setPipelined( bool _pipelined )
+{
+	if( _pipelined==pPipelined ) return;
+	if( _pipelined ) startPipeline();
+	else stopPipeline();
+}
+
+bool SceneHandler::pipelined() const
+{
+	return pPipelined;
+}
+
+void SceneHandler::setDetectionThreads( unsigned int _threads )
+{
+	if( _threads==0 ) _threads = 1;
+	if( _threads==pDetectionThreads ) return;
+
+	bool running = pPipelined;
+	stopPipeline();
+	pDetectionThreads = _threads;
+	if( running ) startPipeline();
+}
+
+unsigned int SceneHandler::detectionThreads() const
+{
+	return pDetectionThreads;
+}
+
+void SceneHandler::flush()
+{
+	boost::mutex::scoped_lock lock( pProgressMutex );
+	while( pPipelined && pFrameCount<pSubmittedFrames ) pFrameFinished.wait( lock );
+}
+
+
+void SceneHandler::setFrameListener( boost::function<void( unsigned int _frame, double _latency )> _listener )
+{
+	flush();
+	pFrameListener = _listener;
+}
+
+
+void SceneHandler::startPipeline()
+{
+	pSubmittedFrames = pFrameCount;
+	pPreProcessQueue.setCapacity( pipeline_queue_length );
+	pDetectionQueue.setCapacity( max( pipeline_queue_length, pDetectionThreads ) ); // enough frames to keep all detection threads busy
+	pTrackingQueue.setCapacity( pipeline_queue_length );
+	pPreProcessQueue.reopen();
+	pDetectionQueue.reopen();
+	pTrackingQueue.reopen();
+
+	pPreProcessWorker = boost::thread( &SceneHandler::preProcessThread, this );
+	pDetectionWorkers = new boost::thread_group();
+	for( unsigned int i=0; i<pDetectionThreads; i++ ) pDetectionWorkers->create_thread( boost::bind( &SceneHandler::detectionThread, this ) );
+	pTrackingWorker = boost::thread( &SceneHandler::trackingThread, this );
+	pPipelined = true;
+}
+
+void SceneHandler::stopPipeline()
+{
+	if( !pPipelined ) return;
+
+	// closing the first queue lets each stage finish the frames it still has and then close the queue of the next one
+	pPreProcessQueue.close();
+	pPreProcessWorker.join();
+	pDetectionWorkers->join_all();
+	pDetectionWorkers.release(); // deletes the finished threads
+	pTrackingQueue.close(); // only once all detection threads are done
+	pTrackingWorker.join();
+	pPipelined = false;
+}
+
+
+void SceneHandler::preProcessThread()
+{
+	pTracer.setThreadName( "preprocessing" );
+	Ptr<FrameJob> job;
+	while( pPreProcessQueue.pop( job ) )
+	{
+		try
+		{
+			prepareFrame( *job );
+		}
+		catch(...)
+		{
+			cerr<<endl<<"SceneHandler::preProcessThread:: Preprocessing of frame "<<job->number<<" failed, the frame is skipped."<<endl;
+			job->failed = true;
+		}
+		pDetectionQueue.push( job );
+	}
+	pDetectionQueue.close();
+}
+
+void SceneHandler::detectionThread()
+{
+	pTracer.setThreadName( "detection" );
+	Ptr<FrameJob> job;
+	while( pDetectionQueue.pop( job ) )
+	{
+		try
+		{
+			if( !job->failed ) pObjectSet.detect( job->forCalculations, job->detection );
+		}
+		catch(...)
+		{
+			cerr<<endl<<"SceneHandler::detectionThread:: Detection in frame "<<job->number<<" failed, the frame is skipped."<<endl;
+			job->failed = true;
+		}
+		pTrackingQueue.push( job );
+	}
+}
+
+void SceneHandler::trackingThread()
+{
+	pTracer.setThreadName( "tracking" );
+	Ptr<FrameJob> job;
+	map< unsigned int, Ptr<FrameJob> > detectedAhead; // frames whose detection finished before that of an earlier frame
+	boost::mutex::scoped_lock progressLock( pProgressMutex );
+	unsigned int nextFrame = pFrameCount;
+	progressLock.unlock();
+
+	while( true )
+	{
+		map< unsigned int, Ptr<FrameJob> >::iterator next = detectedAhead.find( nextFrame );
+		if( next==detectedAhead.end() )
+		{
+			if( !pTrackingQueue.pop( job ) ) break;
+			detectedAhead[job->number] = job;
+			continue;
+		}
+		job = next->second;
+		detectedAhead.erase( next );
+		nextFrame++;
+
+		// the deadlines of the optional stages refer to the tracking stage alone: it has one frame period per frame
+		pScheduler.frameArrived();
+		bool tracked = false;
+		if( !job->failed ) // frames that failed in an earlier stage only advance the frame count
+		{
+			try
+			{
+				finishFrame( *job );
+				tracked = true;
+			}
+			catch(...)
+			{
+				cerr<<endl<<"SceneHandler::trackingThread:: Tracking in frame "<<job->number<<" failed."<<endl;
+			}
+		}
+		if( !tracked )
+		{
+			boost::mutex::scoped_lock progressLock( pProgressMutex );
+			pFrameCount = job->number+1;
+			pFrameFinished.notify_all();
+			continue;
+		}
+
+		// latency from pushFrame() to the end of the tracking
+		double latency = FrameScheduler::now()-job->arrival;
+		pProfiler.record( Profiler::FRAME_TOTAL, latency );
+		vector< pair<string,double> > arguments;
+		arguments.push_back( make_pair( string("frame"), (double)job->number ) );
+		arguments.push_back( make_pair( string("time"), job->time ) );
+		pTracer.asyncSpan( "frame", job->number, job->arrival, latency, arguments );
+	}
+}
+
+
 
 Mat const& SceneHandler::getOriginalFrame( unsigned int _frameNumber ) const
 {
-	if( !buffering_activated ) return pWorkingFrame;
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( !buffering_activated ) return pWorkingFrame.original();
 	return pVideo.loadOriginal(_frameNumber);
 }
 
 Mat SceneHandler::operator[]( unsigned int _frameNumber )
 {
-	if( !buffering_activated ) return pWorkingFrame;
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( !buffering_activated ) return pWorkingFrame.edited();
 	return pVideo[_frameNumber].edited();
 }
 
 Mat SceneHandler::last()
 {
-	if( !buffering_activated ) return pWorkingFrame;
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( !buffering_activated ) return pWorkingFrame.edited();
 	Mat lastEdited;
 	pVideo >> lastEdited;
 	return lastEdited;
@@ -351,7 +675,8 @@ Mat SceneHandler::last()
 
 Mat SceneHandler::grey()
 {
-	if( !buffering_activated ) return pWorkingFrame;
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( !buffering_activated ) return pWorkingFrame.grey();
 	Mat greyImg = pVideo.grey();
 	return greyImg;
 }
@@ -365,10 +690,11 @@ Mat SceneHandler::resized( double _factor )
 
 Mat SceneHandler::operator>>( Mat& _frame )
 {
+	boost::mutex::scoped_lock lock( pResultMutex );
 	if( !buffering_activated )
 	{
-		_frame = pWorkingFrame;
-		return pWorkingFrame;
+		_frame = pWorkingFrame.edited();
+		return _frame;
 	}
 	pVideo >> _frame;
 	return _frame;
@@ -378,8 +704,10 @@ bool SceneHandler::operator<<( VideoCapture& _vc )
 {
 	Mat newframe;
 
+	Tracer::Span captureSpan( pTracer, "capture" );
 	double time = _vc.get(CV_CAP_PROP_POS_MSEC);
 	_vc >> newframe;
+	captureSpan.stop();
 
 	if( !newframe.data )
 	{
@@ -392,9 +720,111 @@ bool SceneHandler::operator<<( VideoCapture& _vc )
 }
 
 
+bool SceneHandler::operator<<( AsyncCapture& _capture )
+{
+	AsyncCapture::CapturedFrame captured;
+
+	Tracer::Span captureSpan( pTracer, "capture" );
+	bool available = _capture.read( captured );
+	captureSpan.stop();
+
+	if( !available )
+	{
+		cout<<endl<<"Video ended."<<endl;
+		return false;
+	}
+
+	pushFrame( captured.image, captured.time, captured.captureTime );
+	return true;
+}
+
+
+Profiler& SceneHandler::profile()
+{
+	return pProfiler;
+}
+
+
+Tracer& SceneHandler::tracer()
+{
+	return pTracer;
+}
+
+
+FrameScheduler& SceneHandler::scheduler()
+{
+	return pScheduler;
+}
+
+
+StreamContext& SceneHandler::stream()
+{
+	return pStream;
+}
+
+
+MemoryReport SceneHandler::memoryReport()
+{
+	MemoryReport report;
+	boost::mutex::scoped_lock lock( pResultMutex );
+	if( buffering_activated ) pVideo.memoryReport( report );
+	else if( !pWorkingFrame.original().empty() )
+	{
+		set<const uchar*> counted;
+		report.frameBuffer = pWorkingFrame.memUsage( counted );
+		for( deque<Frame>::const_iterator it=pFreeFrames.begin(); it!=pFreeFrames.end(); it++ ) report.frameBuffer += it->memUsage( counted ); // recycled buffers
+		report.bufferedFrames = 1;
+	}
+	lock.unlock();
+	pObjectSet.memoryReport( report );
+	report.classifiers = GenericObject::classifierMemUsage( pStream.classifiers() );
+	return report;
+}
+
+
+SpillWriter::Statistics SceneHandler::spillStatistics() const
+{
+	boost::mutex::scoped_lock lock( pResultMutex );
+	return pVideo.spillStatistics();
+}
+
+VideoBuffer::CompressionStatistics SceneHandler::compressionStatistics() const
+{
+	boost::mutex::scoped_lock lock( pResultMutex );
+	return pVideo.compressionStatistics();
+}
+
+
+void SceneHandler::periodicMemoryReport( double _time )
+{
+	MemoryReport report = memoryReport();
+
+	if( memory_report_file.empty() )
+	{
+		cout<<endl<<"Memory usage after "<<pFrameCount<<" frames:";
+		report.print( cout );
+		return;
+	}
+
+	ifstream existing( memory_report_file.c_str() );
+	bool writeHeader = !existing.good() || existing.peek()==ifstream::traits_type::eof();
+	existing.close();
+
+	ofstream out( memory_report_file.c_str(), ios::app );
+	if( !out.is_open() )
+	{
+		cerr<<endl<<"SceneHandler::periodicMemoryReport:: Failed to open "<<memory_report_file<<", the report is printed instead."<<endl;
+		report.print( cerr );
+		return;
+	}
+	report.writeCsv( out, pFrameCount, _time, writeHeader );
+	return;
+}
+
+
 double SceneHandler::timeLeft()
 {
-	return (pTime+1000/pFrameRate) - msTime();
+	return pScheduler.remaining();
 }
 
 
@@ -406,6 +836,7 @@ double SceneHandler::getFrameRate() const
 void SceneHandler::setFrameRate( double& _newFPS )
 {
 	pFrameRate = _newFPS;
+	pScheduler.setFrameRate( pFrameRate );
 	return;
 }
 
@@ -415,6 +846,17 @@ void SceneHandler::setFrameRate( VideoCapture& _vc )
 	double newFPS = _vc.get(CV_CAP_PROP_FPS);
     if( isnan(newFPS) ) pFrameRate = (*Options::General)["general_settings"]["user_set_framerate"].as<int>();
     else pFrameRate = newFPS;
+	pScheduler.setFrameRate( pFrameRate );
+	return;
+}
+
+
+void SceneHandler::setFrameRate( const AsyncCapture& _capture )
+{
+	double newFPS = _capture.frameRate();
+	if( isnan(newFPS) || newFPS<=0 ) pFrameRate = (*Options::General)["general_settings"]["user_set_framerate"].as<int>();
+	else pFrameRate = newFPS;
+	pScheduler.setFrameRate( pFrameRate );
 	return;
 }
 
@@ -422,34 +864,70 @@ void SceneHandler::setFrameRate( VideoCapture& _vc )
 // [GENERAL IMAGE CONVERSION]
 // ***************************************************************************************************************
 
-bool SceneHandler::initialProcessing( Mat& /*_image*/ )
+bool SceneHandler::initialProcessing( Mat& _image )
 {
+	// channels are dropped first: less data to convert
+	if( monochrome_ingest && _image.channels()>1 )
+	{
+		Mat mono( _image.size(), CV_MAKETYPE( _image.depth(), 1 ) );
+		int fromTo[] = { 0,0 };
+		mixChannels( &_image, 1, &mono, 1, fromTo, 1 );
+		_image = mono;
+	}
+
+	if( _image.depth()!=CV_8U )
+	{
+		double low = ingest_window_low;
+		double high = ( ingest_window_high<0 )? depthMaximum( _image.depth() ) : ingest_window_high;
+		if( high<=low )
+		{
+			if( !pIngestFailureReported ) cerr<<endl<<"SceneHandler::initialProcessing:: The ingest window ["<<low<<","<<high<<"] is empty, frames with more than 8 bits per channel are skipped."<<endl;
+			pIngestFailureReported = true;
+			return false;
+		}
+		pIngestFailureReported = false;
+		// window/level: a single saturating linear pass, for 16 bit input this equals a lookup table over all input values
+		Mat reduced;
+		_image.convertTo( reduced, CV_MAKETYPE( CV_8U, _image.channels() ), 255/(high-low), -low*255/(high-low) );
+		_image = reduced;
+	}
 	return true;
 }
 
+double SceneHandler::depthMaximum( int _depth )
+{
+	switch( _depth )
+	{
+		case CV_8S: return 127;
+		case CV_16U: return 65535;
+		case CV_16S: return 32767;
+		case CV_32S: return 2147483647.0;
+		case CV_32F: case CV_64F: return 1; // floating point images are expected to be normalized
+		default: return 255;
+	}
+}
+
 
 // [PREPROCESSING] video frame preprocessing functions and variables
 // ***************************************************************************************************************
 bool SceneHandler::preProcess( Mat& _image )
 {
-	bool success=true;
+	// consecutive point-wise filters are applied as one combined look up table
+	return pPreProcessChain.apply( pPreProcessStack, _image );
+}
 
-	for( list< Ptr<IPAlgorithm> >::iterator it=pPreProcessStack.begin(); it!= pPreProcessStack.end() ; it++ )
+bool SceneHandler::stackActive( const list< Ptr<IPAlgorithm> >& _stack )
+{
+	for( list< Ptr<IPAlgorithm> >::const_iterator it=_stack.begin(); it!=_stack.end(); it++ )
 	{
-		if( (**it).active ) success = success && (**it).apply(_image);
+		if( (**it).active ) return true;
 	}
-	return success;
+	return false;
 }
 
 bool SceneHandler::preProcessIntern( Mat& _image )
 {
-	bool success=true;
-
-	for( list< Ptr<IPAlgorithm> >::iterator it=pInternPreProcessStack.begin(); it!= pInternPreProcessStack.end() ; it++ )
-	{
-		if( (**it).active ) success = success && (**it).apply(_image);
-	}
-	return success;
+	return pInternPreProcessChain.apply( pInternPreProcessStack, _image );
 }
 
 list<string> SceneHandler::preProcessStackInfo()
@@ -671,15 +1149,17 @@ void SceneHandler::moveInternPreProcessAlgorithmDown( int _idx )
 }
 
 
-const Mat& SceneHandler::preProcessImage()
+Mat SceneHandler::preProcessImage()
 {
+	boost::mutex::scoped_lock lock( pResultMutex );
 	return pPreProcessImage;
 }
 
 
 
-const Mat& SceneHandler::preThresholdImage()
+Mat SceneHandler::preThresholdImage()
 {
+	boost::mutex::scoped_lock lock( pResultMutex );
 	return pPreThresholdImage;
 }
 
@@ -754,6 +1234,19 @@ const Rect& SceneHandler::getObservationArea()
 }
 
 
+Rect SceneHandler::clippedObservationArea( Size _frameSize ) const
+{
+	if( pObservationArea.area()==0 ) return Rect();
+
+	int xMin = max( pObservationArea.x, 0 );
+	int xMax = min( pObservationArea.x+pObservationArea.width, _frameSize.width );
+	int yMin = max( pObservationArea.y, 0 );
+	int yMax = min( pObservationArea.y+pObservationArea.height, _frameSize.height );
+	if( xMax<=xMin || yMax<=yMin ) return Rect(); // outside of the frame
+	return Rect( xMin, yMin, xMax-xMin, yMax-yMin );
+}
+
+
 void SceneHandler::setThreshold( double _threshold )
 {
 	pObjectSet.setThreshold( _threshold );
@@ -0,0 +1,178 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SceneHandlerPool.h"
+#include "Options.h"
+#include "boost/bind.hpp"
+#include "boost/filesystem.hpp"
+#include <iostream>
+
+
+SceneHandlerPool::SceneHandlerPool( unsigned int _workers ):pStopping(false)
+{
+	setupOptions();
+	pWorkerCount = ( _workers!=0 )? _workers : pool_workers;
+	if( pWorkerCount==0 ) pWorkerCount = boost::thread::hardware_concurrency();
+	if( pWorkerCount==0 ) pWorkerCount = 1;
+	ObjectHandler::setupOptions(); // the workers only read the object options
+
+	for( unsigned int i=0; i<pWorkerCount; i++ ) pWorkers.create_thread( boost::bind( &SceneHandlerPool::workerThread, this ) );
+}
+
+SceneHandlerPool::~SceneHandlerPool()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	pStopping = true;
+	pWorkAvailable.notify_all();
+	lock.unlock();
+
+	pWorkers.join_all(); // the workers leave as soon as no frames are waiting anymore
+}
+
+
+void SceneHandlerPool::setupOptions()
+{
+	Options::load_options();
+	pool_workers = (*Options::General)["runtime"]["pool"]["workers"].as<unsigned int>();
+	pool_queue_length = (*Options::General)["runtime"]["pool"]["queue_length"].as<unsigned int>();
+}
+unsigned int SceneHandlerPool::pool_workers;
+unsigned int SceneHandlerPool::pool_queue_length;
+
+
+unsigned int SceneHandlerPool::addStream( const string& _name, double _frameRate )
+{
+	Ptr<Stream> stream = new Stream();
+	stream->scene = new SceneHandler( _frameRate ); // constructed here, not in the workers: the class setup isn't made for concurrent access
+	stream->scene->setPipelined( false ); // the pool provides the threads
+	stream->scene->stream().setName( _name );
+
+	// the streams mustn't share the trace file
+	if( stream->scene->tracer().active() )
+	{
+		boost::filesystem::path traceFile( (*Options::General)["runtime"]["tracing"]["file"].as<string>() );
+		stream->scene->tracer().start( ( traceFile.parent_path()/( traceFile.stem().string()+"_"+_name+traceFile.extension().string() ) ).string() );
+	}
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pStreams.push_back( stream );
+	return pStreams.size()-1;
+}
+
+unsigned int SceneHandlerPool::streamCount() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pStreams.size();
+}
+
+
+SceneHandler& SceneHandlerPool::scene( unsigned int _stream )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return *pStreams[_stream]->scene;
+}
+
+
+void SceneHandlerPool::pushFrame( unsigned int _stream, Mat _frame, double _time )
+{
+	PendingFrame frame;
+	frame.image = _frame.clone(); // the frame waits in the queue of the stream, the caller may reuse its buffer meanwhile
+	frame.time = _time;
+	frame.arrival = FrameScheduler::now();
+
+	boost::mutex::scoped_lock lock( pMutex );
+	if( _stream>=pStreams.size() )
+	{
+		cerr<<endl<<"SceneHandlerPool::pushFrame:: There is no stream "<<_stream<<", the frame is ignored."<<endl;
+		return;
+	}
+	Stream& stream = *pStreams[_stream];
+	while( stream.frames.size()>=pool_queue_length && pool_queue_length>0 ) pProgress.wait( lock );
+
+	stream.frames.push_back( frame );
+	stream.pushed++;
+
+	// a stream is ready if it has waiting frames and no worker is busy with it
+	if( !stream.busy && stream.frames.size()==1 )
+	{
+		pReady.push_back( _stream );
+		pWorkAvailable.notify_one();
+	}
+}
+
+
+void SceneHandlerPool::flush( unsigned int _stream )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( _stream>=pStreams.size() ) return;
+	Ptr<Stream> stream = pStreams[_stream];
+	while( stream->processed<stream->pushed ) pProgress.wait( lock );
+}
+
+void SceneHandlerPool::flush()
+{
+	for( unsigned int i=0; i<streamCount(); i++ ) flush( i );
+}
+
+
+unsigned int SceneHandlerPool::workerCount() const
+{
+	return pWorkerCount;
+}
+
+
+void SceneHandlerPool::workerThread()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	while( true )
+	{
+		while( !pStopping && pReady.empty() ) pWorkAvailable.wait( lock );
+		if( pReady.empty() ) return; // stopping and no frames left
+
+		unsigned int index = pReady.front();
+		pReady.pop_front();
+		Ptr<Stream> stream = pStreams[index];
+		PendingFrame frame = stream->frames.front();
+		stream->frames.pop_front();
+		stream->busy = true;
+		pProgress.notify_all(); // there is room in the queue of the stream again
+		lock.unlock();
+
+		try
+		{
+			stream->scene->pushFrame( frame.image, frame.time, frame.arrival );
+		}
+		catch(...)
+		{
+			cerr<<endl<<"SceneHandlerPool::workerThread:: Processing a frame of stream "<<stream->scene->stream().name()<<" failed."<<endl;
+		}
+
+		lock.lock();
+		stream->busy = false;
+		stream->processed++;
+		if( !stream->frames.empty() )
+		{
+			pReady.push_back( index );
+			pWorkAvailable.notify_one();
+		}
+		pProgress.notify_all();
+	}
+}
@@ -0,0 +1,216 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpillWriter.h"
+#include "Options.h"
+#include "FrameScheduler.h"
+#include "MemoryReport.h"
+#include "boost/filesystem.hpp"
+#include <iostream>
+#include <algorithm>
+
+
+SpillWriter::SpillWriter( const string& _folder, const string& _baseName, bool _objectCentric ):pFolder(_folder),pBaseName(_baseName),pObjectCentric(_objectCentric),pRunning(true)
+{
+	setupOptions();
+	pQueueLength = ( spill_queue_length==0 )? 1 : spill_queue_length;
+	pDropping = spill_drop;
+	pWorker = boost::thread( &SpillWriter::writerThread, this );
+}
+
+SpillWriter::~SpillWriter()
+{
+	close();
+}
+
+
+void SpillWriter::setupOptions()
+{
+	Options::load_options();
+	spill_queue_length = (*Options::General)["runtime"]["buffer"]["spill_queue_length"].as<unsigned int>();
+	spill_drop = (*Options::General)["runtime"]["buffer"]["spill_drop"].as<bool>();
+}
+unsigned int SpillWriter::spill_queue_length;
+bool SpillWriter::spill_drop;
+
+
+bool SpillWriter::push( const Frame& _frame )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pRunning ) return false;
+
+	if( pQueue.size()>=pQueueLength )
+	{
+		if( pDropping )
+		{
+			if( pStatistics.dropped==0 ) cerr<<endl<<"SpillWriter::push:: The disk can't keep up with the frames to be recorded, frames are dropped."<<endl;
+			pStatistics.dropped++;
+			return false;
+		}
+
+		double waitStart = FrameScheduler::now();
+		pStatistics.waits++;
+		while( pRunning && pQueue.size()>=pQueueLength ) pRoomAvailable.wait( lock );
+		pStatistics.waitTime += FrameScheduler::now()-waitStart;
+		if( !pRunning ) return false;
+	}
+
+	pQueue.push_back( _frame );
+	pStatistics.queued++;
+	if( pQueue.size()>pStatistics.maxQueueLength ) pStatistics.maxQueueLength = pQueue.size();
+	pFrameAvailable.notify_one();
+	return true;
+}
+
+
+void SpillWriter::close( bool _writeQueued )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !_writeQueued )
+	{
+		pStatistics.dropped += pQueue.size();
+		pQueue.clear();
+	}
+	pRunning = false;
+	pFrameAvailable.notify_all();
+	pRoomAvailable.notify_all();
+	lock.unlock();
+
+	if( pWorker.joinable() ) pWorker.join();
+}
+
+
+unsigned long SpillWriter::size() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pQueue.size()+pWriting.size()+pStatistics.written;
+}
+
+
+bool SpillWriter::load( unsigned long _i, Frame& _frame ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( _i<pQueue.size() )
+	{
+		_frame = pQueue[ pQueue.size()-1-_i ];
+		return true;
+	}
+	_i -= pQueue.size();
+	if( _i<pWriting.size() )
+	{
+		_frame = pWriting.front();
+		return true;
+	}
+	_i -= pWriting.size();
+
+	// the archive may already contain frames that aren't counted as written yet, the numbering only uses the counted ones
+	if( _i>=pStatistics.written ) return false;
+	unsigned long archived = pStatistics.written-1-_i;
+	lock.unlock();
+	if( pObjectCentric ) return pThumbnails.load( archived, _frame );
+	return pArchive.load( archived, _frame );
+}
+
+
+long SpillWriter::find( double _time ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	long number = 0;
+	for( deque<Frame>::const_reverse_iterator it=pQueue.rbegin(); it!=pQueue.rend(); it++, number++ )
+	{
+		if( it->time()<=_time ) return number;
+	}
+	for( deque<Frame>::const_iterator it=pWriting.begin(); it!=pWriting.end(); it++, number++ )
+	{
+		if( it->time()<=_time ) return number;
+	}
+	long written = (long)pStatistics.written;
+	lock.unlock();
+
+	long archived = min( pObjectCentric? pThumbnails.find( _time ) : pArchive.find( _time ), written-1 );
+	if( archived<0 ) return -1;
+	return number+( written-1-archived );
+}
+
+
+SpillWriter::Statistics SpillWriter::statistics() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	Statistics statistics = pStatistics;
+	lock.unlock();
+	statistics.bytes = pObjectCentric? pThumbnails.bytes() : pArchive.bytes();
+	return statistics;
+}
+
+const ThumbnailArchive* SpillWriter::thumbnails() const
+{
+	return pObjectCentric? &pThumbnails : NULL;
+}
+
+vector<string> SpillWriter::files() const
+{
+	vector<string> archiveFiles;
+	boost::mutex::scoped_lock lock( pMutex );
+	if( pStatistics.files==0 ) return archiveFiles;
+	if( pObjectCentric ) return pThumbnails.files();
+	archiveFiles.push_back( pArchive.dataFile() );
+	archiveFiles.push_back( pArchive.indexFile() );
+	return archiveFiles;
+}
+
+size_t SpillWriter::queuedMemUsage( set<const uchar*>& _counted ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	size_t usage = 0;
+	for( deque<Frame>::const_iterator it=pQueue.begin(); it!=pQueue.end(); it++ ) usage += it->memUsage( _counted );
+	for( deque<Frame>::const_iterator it=pWriting.begin(); it!=pWriting.end(); it++ ) usage += it->memUsage( _counted );
+	return usage;
+}
+
+
+void SpillWriter::writerThread()
+{
+	// the archive is created on this thread as well, the processing thread never touches the disk
+	boost::system::error_code error;
+	boost::filesystem::create_directories( pFolder, error );
+	string path = ( boost::filesystem::path( pFolder ) / pBaseName ).string();
+	bool created = pObjectCentric? pThumbnails.create( path ) : pArchive.create( path );
+
+	boost::mutex::scoped_lock lock( pMutex );
+	if( created ) pStatistics.files = pObjectCentric? 3 : 2;
+	while( true )
+	{
+		while( pRunning && pQueue.empty() ) pFrameAvailable.wait( lock );
+		if( pQueue.empty() ) break;
+
+		pWriting.push_back( pQueue.front() );
+		pQueue.pop_front();
+		pRoomAvailable.notify_one();
+		lock.unlock();
+
+		bool written = created && ( pObjectCentric? pThumbnails.append( pWriting.front() ) : pArchive.append( pWriting.front() ) );
+
+		lock.lock();
+		pWriting.clear();
+		if( written ) pStatistics.written++;
+		else pStatistics.dropped++;
+	}
+}
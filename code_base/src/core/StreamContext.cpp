@@ -0,0 +1,100 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "StreamContext.h"
+#include "GenericObject.h"
+
+
+StreamContext::StreamContext( const string& _name ):pName(_name),pObjectCount(0)
+{
+	boost::mutex::scoped_lock lock( pStreamsMutex );
+	pStreams.push_back( this );
+}
+
+StreamContext::~StreamContext()
+{
+	boost::mutex::scoped_lock lock( pStreamsMutex );
+	pStreams.remove( this );
+}
+
+list<StreamContext*> StreamContext::pStreams;
+boost::mutex StreamContext::pStreamsMutex;
+
+
+const string& StreamContext::name() const
+{
+	return pName;
+}
+
+void StreamContext::setName( const string& _name )
+{
+	pName = _name;
+}
+
+
+unsigned int StreamContext::nextObjectId()
+{
+	return pObjectCount++;
+}
+
+unsigned int StreamContext::objectCount() const
+{
+	return pObjectCount;
+}
+
+void StreamContext::resetObjectCount()
+{
+	pObjectCount = 0;
+}
+
+
+list< Ptr<GenericObject> >& StreamContext::genericObjects( unsigned int _genericClassId )
+{
+	// classes may be created at runtime
+	if( _genericClassId>=pGenericObjects.size() ) pGenericObjects.resize( _genericClassId+1 );
+	return pGenericObjects[_genericClassId];
+}
+
+boost::mutex& StreamContext::genericObjectsMutex()
+{
+	return pGenericObjectsMutex;
+}
+
+Ptr<CvBoost>& StreamContext::classifier( unsigned int _genericClassId )
+{
+	if( _genericClassId>=pClassifiers.size() ) pClassifiers.resize( _genericClassId+1 );
+	return pClassifiers[_genericClassId];
+}
+
+const vector< Ptr<CvBoost> >& StreamContext::classifiers() const
+{
+	return pClassifiers;
+}
+
+
+void StreamContext::forEachStream( boost::function<void(StreamContext&)> _visit )
+{
+	boost::mutex::scoped_lock lock( pStreamsMutex );
+	for( list<StreamContext*>::iterator stream = pStreams.begin(); stream != pStreams.end(); stream++ )
+	{
+		_visit( **stream );
+	}
+}
@@ -0,0 +1,363 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include "ThumbnailArchive.h"
+#include "Options.h"
+#include "boost/filesystem.hpp"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+
+const boost::uint64_t ThumbnailArchive::noImage;
+
+
+ThumbnailArchive::ThumbnailArchive():pWritable(false),pKeyframeType(-1),pFramesSinceKeyframe(0)
+{
+	setupOptions();
+}
+
+ThumbnailArchive::~ThumbnailArchive()
+{
+	close();
+}
+
+
+void ThumbnailArchive::setupOptions()
+{
+	Options::load_options();
+	thumbnail_margin = (*Options::General)["runtime"]["buffer"]["thumbnail_margin"].as<int>();
+	keyframe_interval = (*Options::General)["runtime"]["buffer"]["keyframe_interval"].as<unsigned int>();
+}
+int ThumbnailArchive::thumbnail_margin;
+unsigned int ThumbnailArchive::keyframe_interval;
+
+
+bool ThumbnailArchive::create( const string& _path )
+{
+	close();
+	if( !pImages.create( _path ) ) return false;
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pPath = _path;
+	pIndexOut.open( indexFile().c_str(), ios::out | ios::binary | ios::trunc );
+	if( !pIndexOut.is_open() )
+	{
+		cerr<<endl<<"ThumbnailArchive::create:: Could not create the archive "<<_path<<"."<<endl;
+		return false;
+	}
+	FrameArchive::Header indexHeader = header();
+	pIndexOut.write( reinterpret_cast<const char*>(&indexHeader), sizeof(FrameArchive::Header) );
+	pIndexOut.flush();
+	pWritable = true;
+	return true;
+}
+
+
+bool ThumbnailArchive::open( const string& _path, bool _append )
+{
+	close();
+	if( !pImages.open( _path, _append ) ) return false;
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pPath = _path;
+
+	ifstream index( indexFile().c_str(), ios::in | ios::binary );
+	FrameArchive::Header indexHeader;
+	FrameArchive::Header expected = header();
+	if( !index.read( reinterpret_cast<char*>(&indexHeader), sizeof(FrameArchive::Header) ) || memcmp( &indexHeader, &expected, sizeof(FrameArchive::Header) )!=0 )
+	{
+		cerr<<endl<<"ThumbnailArchive::open:: "<<_path<<" is not a valid thumbnail archive."<<endl;
+		return false;
+	}
+
+	// a frame whose images weren't all written completely is ignored along with its thumbnails (and overwritten when appending)
+	unsigned long images = pImages.size();
+	bool complete = true;
+	size_t frameStart = 0; // index position of the FRAME entry of the frame read
+	IndexEntry entry;
+	while( index.read( reinterpret_cast<char*>(&entry), sizeof(IndexEntry) ) )
+	{
+		if( entry.kind==FRAME ) frameStart = pIndex.size();
+		if( entry.image!=noImage && entry.image>=images )
+		{
+			complete = false;
+			break;
+		}
+		addToIndex( entry );
+	}
+	if( !complete )
+	{
+		vector<IndexEntry> entries( pIndex.begin(), pIndex.begin()+frameStart );
+		pIndex.clear();
+		pFrames.clear();
+		pKeyframes.clear();
+		pObjects.clear();
+		for( size_t i=0; i<entries.size(); i++ ) addToIndex( entries[i] );
+	}
+
+	if( !_append ) return true;
+
+	index.close();
+	boost::filesystem::resize_file( indexFile(), sizeof(FrameArchive::Header)+pIndex.size()*sizeof(IndexEntry) );
+	pIndexOut.open( indexFile().c_str(), ios::out | ios::binary | ios::app );
+	pWritable = pIndexOut.is_open();
+	if( !pWritable ) cerr<<endl<<"ThumbnailArchive::open:: Could not open "<<_path<<" for appending."<<endl;
+	// the next frame appended starts with a keyframe
+	pKeyframeType = -1;
+	return pWritable;
+}
+
+
+void ThumbnailArchive::close()
+{
+	pImages.close();
+	boost::mutex::scoped_lock lock( pMutex );
+	if( pIndexOut.is_open() ) pIndexOut.close();
+	pIndex.clear();
+	pFrames.clear();
+	pKeyframes.clear();
+	pObjects.clear();
+	pWritable = false;
+	pKeyframeType = -1;
+	pFramesSinceKeyframe = 0;
+}
+
+
+bool ThumbnailArchive::append( Frame& _frame )
+{
+	if( !pWritable ) return false;
+
+	const Mat& original = _frame.original();
+	vector<IndexEntry> entries;
+
+	IndexEntry frameEntry;
+	memset( &frameEntry, 0, sizeof(IndexEntry) );
+	frameEntry.frame = size();
+	frameEntry.image = noImage;
+	frameEntry.time = _frame.time();
+	frameEntry.objectId = -1;
+	frameEntry.kind = FRAME;
+	frameEntry.width = original.cols;
+	frameEntry.height = original.rows;
+	frameEntry.type = original.type();
+
+	// only this thread writes, the images are written before the index entries that refer to them
+	bool keyframeDue = pKeyframeType!=original.type() || pKeyframeSize!=original.size() || ( keyframe_interval>0 && pFramesSinceKeyframe+1>=keyframe_interval );
+	if( keyframeDue )
+	{
+		Frame background( original, _frame.time() );
+		if( !pImages.append( background ) ) return false;
+		frameEntry.image = pImages.size()-1;
+		pKeyframeSize = original.size();
+		pKeyframeType = original.type();
+		pFramesSinceKeyframe = 0;
+	}
+	else pFramesSinceKeyframe++;
+	entries.push_back( frameEntry );
+
+	const vector<Frame::ObjectRegion>& regions = _frame.objectRegions();
+	Rect frameArea( 0, 0, original.cols, original.rows );
+	for( size_t i=0; i<regions.size(); i++ )
+	{
+		Rect area = Rect( regions[i].area.x-thumbnail_margin, regions[i].area.y-thumbnail_margin, regions[i].area.width+2*thumbnail_margin, regions[i].area.height+2*thumbnail_margin ) & frameArea;
+		if( area.area()==0 ) continue;
+
+		Frame thumbnail( original( area ), _frame.time() );
+		if( !pImages.append( thumbnail ) ) return false;
+
+		IndexEntry objectEntry = frameEntry;
+		objectEntry.image = pImages.size()-1;
+		objectEntry.objectId = regions[i].id;
+		objectEntry.kind = OBJECT;
+		objectEntry.x = area.x;
+		objectEntry.y = area.y;
+		objectEntry.width = area.width;
+		objectEntry.height = area.height;
+		entries.push_back( objectEntry );
+	}
+
+	pIndexOut.write( reinterpret_cast<const char*>(&entries[0]), entries.size()*sizeof(IndexEntry) );
+	pIndexOut.flush();
+	if( !pIndexOut.good() )
+	{
+		cerr<<endl<<"ThumbnailArchive::append:: Could not write to the archive "<<pPath<<", no further frames are archived."<<endl;
+		pWritable = false;
+		return false;
+	}
+
+	boost::mutex::scoped_lock lock( pMutex );
+	for( size_t i=0; i<entries.size(); i++ ) addToIndex( entries[i] );
+	return true;
+}
+
+
+unsigned long ThumbnailArchive::size() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	return pFrames.size();
+}
+
+
+bool ThumbnailArchive::load( unsigned long _i, Frame& _frame ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( _i>=pFrames.size() ) return false;
+
+	unsigned long first = pFrames[_i];
+	unsigned long end = ( _i+1<pFrames.size() )? pFrames[_i+1] : pIndex.size();
+	IndexEntry frameEntry = pIndex[first];
+	vector<IndexEntry> thumbnails( pIndex.begin()+first+1, pIndex.begin()+end );
+
+	// the newest keyframe up to the frame
+	vector<unsigned long>::const_iterator keyframe = upper_bound( pKeyframes.begin(), pKeyframes.end(), first );
+	bool hasKeyframe = keyframe!=pKeyframes.begin();
+	IndexEntry keyframeEntry;
+	if( hasKeyframe ) keyframeEntry = pIndex[ *(keyframe-1) ];
+	lock.unlock();
+
+	Mat assembled;
+	if( !hasKeyframe || keyframeEntry.width!=frameEntry.width || keyframeEntry.height!=frameEntry.height || keyframeEntry.type!=frameEntry.type || !loadImage( keyframeEntry, assembled ) )
+	{
+		assembled = Mat::zeros( frameEntry.height, frameEntry.width, frameEntry.type );
+	}
+
+	vector<Frame::ObjectRegion> regions;
+	for( size_t i=0; i<thumbnails.size(); i++ )
+	{
+		Mat thumbnail;
+		Frame::ObjectRegion region;
+		region.id = thumbnails[i].objectId;
+		region.area = Rect( thumbnails[i].x, thumbnails[i].y, thumbnails[i].width, thumbnails[i].height );
+		if( !loadImage( thumbnails[i], thumbnail ) || thumbnail.type()!=assembled.type() ) continue;
+		thumbnail.copyTo( assembled( region.area ) );
+		regions.push_back( region );
+	}
+
+	_frame = Frame( assembled, frameEntry.time );
+	_frame.setObjectRegions( regions );
+	return true;
+}
+
+
+long ThumbnailArchive::find( double _time ) const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+
+	// time stamps increase with the frame number
+	unsigned long first = 0, last = pFrames.size();
+	while( first<last )
+	{
+		unsigned long middle = first+( last-first )/2;
+		if( pIndex[ pFrames[middle] ].time<=_time ) first = middle+1;
+		else last = middle;
+	}
+	return (long)first-1;
+}
+
+
+vector<int> ThumbnailArchive::objects() const
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	vector<int> ids;
+	for( map< int, vector<unsigned long> >::const_iterator it=pObjects.begin(); it!=pObjects.end(); it++ ) ids.push_back( it->first );
+	return ids;
+}
+
+
+bool ThumbnailArchive::clip( int _objectId, vector<Thumbnail>& _clip ) const
+{
+	_clip.clear();
+	boost::mutex::scoped_lock lock( pMutex );
+	map< int, vector<unsigned long> >::const_iterator object = pObjects.find( _objectId );
+	if( object==pObjects.end() ) return false;
+	vector<IndexEntry> entries;
+	for( size_t i=0; i<object->second.size(); i++ ) entries.push_back( pIndex[ object->second[i] ] );
+	lock.unlock();
+
+	for( size_t i=0; i<entries.size(); i++ )
+	{
+		Thumbnail thumbnail;
+		if( !loadImage( entries[i], thumbnail.image ) ) continue;
+		thumbnail.area = Rect( entries[i].x, entries[i].y, entries[i].width, entries[i].height );
+		thumbnail.time = entries[i].time;
+		thumbnail.frame = (unsigned long)entries[i].frame;
+		_clip.push_back( thumbnail );
+	}
+	return !_clip.empty();
+}
+
+
+size_t ThumbnailArchive::bytes() const
+{
+	size_t imageBytes = pImages.bytes();
+	boost::mutex::scoped_lock lock( pMutex );
+	if( pPath.empty() ) return imageBytes;
+	return imageBytes+sizeof(FrameArchive::Header)+pIndex.size()*sizeof(IndexEntry);
+}
+
+vector<string> ThumbnailArchive::files() const
+{
+	vector<string> archiveFiles;
+	archiveFiles.push_back( pImages.dataFile() );
+	archiveFiles.push_back( pImages.indexFile() );
+	archiveFiles.push_back( indexFile() );
+	return archiveFiles;
+}
+
+string ThumbnailArchive::indexFile() const
+{
+	return pPath+".mti";
+}
+
+
+void ThumbnailArchive::addToIndex( const IndexEntry& _entry )
+{
+	unsigned long number = pIndex.size();
+	pIndex.push_back( _entry );
+	if( _entry.kind==FRAME )
+	{
+		pFrames.push_back( number );
+		if( _entry.image!=noImage ) pKeyframes.push_back( number );
+	}
+	else pObjects[ _entry.objectId ].push_back( number );
+}
+
+
+FrameArchive::Header ThumbnailArchive::header()
+{
+	FrameArchive::Header newHeader;
+	memset( &newHeader, 0, sizeof(FrameArchive::Header) );
+	memcpy( newHeader.magic, "MOLARTA", 7 );
+	newHeader.magic[7] = 'i';
+	newHeader.version = formatVersion;
+	newHeader.headerSize = sizeof(FrameArchive::Header);
+	newHeader.entrySize = sizeof(IndexEntry);
+	return newHeader;
+}
+
+
+bool ThumbnailArchive::loadImage( const IndexEntry& _entry, Mat& _image ) const
+{
+	Frame stored;
+	if( _entry.image==noImage || !pImages.load( (unsigned long)_entry.image, stored ) ) return false;
+	_image = stored.original();
+	return true;
+}
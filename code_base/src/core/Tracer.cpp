@@ -0,0 +1,217 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "Tracer.h"
+#include "Options.h"
+#include <iostream>
+#include <iomanip>
+
+
+Tracer::Span::Span( Tracer& _tracer, const string& _name ):pTracer(NULL),pStart(0)
+{
+	if( !_tracer.active() ) return;
+	pTracer = &_tracer;
+	pName = _name;
+	pStart = FrameScheduler::now();
+}
+
+Tracer::Span::Span( Tracer& _tracer, const string& _name, const string& _argName, double _argValue ):pTracer(NULL),pStart(0)
+{
+	if( !_tracer.active() ) return;
+	pTracer = &_tracer;
+	pName = _name;
+	pArguments.push_back( make_pair( _argName, _argValue ) );
+	pStart = FrameScheduler::now();
+}
+
+Tracer::Span::~Span()
+{
+	stop();
+}
+
+void Tracer::Span::addArgument( const string& _name, double _value )
+{
+	if( pTracer==NULL ) return;
+	pArguments.push_back( make_pair( _name, _value ) );
+}
+
+void Tracer::Span::stop()
+{
+	if( pTracer==NULL ) return;
+	pTracer->complete( pName, pStart, FrameScheduler::now()-pStart, pArguments );
+	pTracer = NULL;
+}
+
+
+
+Tracer::Tracer():pActive(false),pFirstEvent(true),pOrigin(0)
+{
+	setupOptions();
+	if( tracing_activated ) start( tracing_file );
+}
+
+Tracer::~Tracer()
+{
+	stop();
+}
+
+
+void Tracer::setupOptions()
+{
+	Options::load_options();
+	tracing_activated = (*Options::General)["runtime"]["tracing"]["activated"].as<bool>();
+	tracing_file = (*Options::General)["runtime"]["tracing"]["file"].as<string>();
+}
+bool Tracer::tracing_activated;
+string Tracer::tracing_file;
+
+
+bool Tracer::start( const string& _file )
+{
+	stop();
+
+	boost::mutex::scoped_lock lock( pMutex );
+	pFile.open( _file.c_str(), ios::out|ios::trunc );
+	if( !pFile.is_open() )
+	{
+		cerr<<endl<<"Tracer::start:: Failed to open trace file "<<_file<<endl;
+		return false;
+	}
+	pFile<<"["<<setprecision(12);
+	pFirstEvent = true;
+	pThreadIds.clear();
+	pOrigin = FrameScheduler::now();
+	pActive = true;
+	return true;
+}
+
+void Tracer::stop()
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	pActive = false;
+	pFile<<endl<<"]"<<endl;
+	pFile.close();
+}
+
+bool Tracer::active() const
+{
+	return pActive;
+}
+
+
+void Tracer::complete( const string& _name, double _start, double _duration, const vector< pair<string,double> >& _arguments )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	beginEvent( _name, 'X', _start );
+	pFile<<",\"dur\":"<<_duration*1000;
+	writeArguments( _arguments );
+	pFile<<"}";
+}
+
+void Tracer::asyncSpan( const string& _name, unsigned int _id, double _start, double _duration, const vector< pair<string,double> >& _arguments )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	beginEvent( _name, 'b', _start );
+	pFile<<",\"cat\":\""<<escape(_name)<<"\",\"id\":"<<_id;
+	writeArguments( _arguments );
+	pFile<<"}";
+	beginEvent( _name, 'e', _start+_duration );
+	pFile<<",\"cat\":\""<<escape(_name)<<"\",\"id\":"<<_id<<"}";
+}
+
+void Tracer::counter( const string& _name, const vector< pair<string,double> >& _values )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	beginEvent( _name, 'C', FrameScheduler::now() );
+	writeArguments( _values );
+	pFile<<"}";
+}
+
+void Tracer::counter( const string& _name, double _value )
+{
+	if( !pActive ) return;
+	counter( _name, vector< pair<string,double> >( 1, make_pair( string("value"), _value ) ) );
+}
+
+void Tracer::instant( const string& _name )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	beginEvent( _name, 'i', FrameScheduler::now() );
+	pFile<<",\"s\":\"t\"}";
+}
+
+
+void Tracer::setThreadName( const string& _name )
+{
+	boost::mutex::scoped_lock lock( pMutex );
+	if( !pActive ) return;
+	beginEvent( "thread_name", 'M', pOrigin );
+	pFile<<",\"args\":{\"name\":\""<<escape(_name)<<"\"}}";
+}
+
+
+int Tracer::threadId()
+{
+	boost::thread::id id = boost::this_thread::get_id();
+	map<boost::thread::id,int>::iterator it = pThreadIds.find( id );
+	if( it!=pThreadIds.end() ) return it->second;
+
+	int newId = pThreadIds.size()+1;
+	pThreadIds[id] = newId;
+	return newId;
+}
+
+void Tracer::beginEvent( const string& _name, char _phase, double _time )
+{
+	if( !pFirstEvent ) pFile<<",";
+	pFirstEvent = false;
+	pFile<<endl<<"{\"name\":\""<<escape(_name)<<"\",\"ph\":\""<<_phase<<"\",\"pid\":1,\"tid\":"<<threadId()<<",\"ts\":"<<( _time-pOrigin )*1000;
+}
+
+void Tracer::writeArguments( const vector< pair<string,double> >& _arguments )
+{
+	if( _arguments.empty() ) return;
+	pFile<<",\"args\":{";
+	for( unsigned int i=0; i<_arguments.size(); i++ )
+	{
+		if( i!=0 ) pFile<<",";
+		pFile<<"\""<<escape( _arguments[i].first )<<"\":"<<_arguments[i].second;
+	}
+	pFile<<"}";
+}
+
+
+string Tracer::escape( const string& _text )
+{
+	string escaped;
+	for( unsigned int i=0; i<_text.size(); i++ )
+	{
+		if( _text[i]=='"' || _text[i]=='\\' ) escaped += '\\';
+		if( (unsigned char)_text[i]<0x20 ) continue; // control characters are dropped
+		escaped += _text[i];
+	}
+	return escaped;
+}
@@ -20,9 +20,11 @@
 */
 
 #include "VideoBuffer.h"
+#include "boost/bind.hpp"
+#include <iterator>
 
 
-VideoBuffer::VideoBuffer(void):tmpFilesO(),tmpFilesE(),pFrameCnt(0),buffCnt(0)
+VideoBuffer::VideoBuffer(void):pUBuffer(1),pNewest(0),pUBufferCount(0),pFrameCnt(0),pCBufferBytes(0),pScheduler(NULL),pSpillWriter(NULL)
 {
 	tempVideoFileName="";
 	tempVideoFileFolder="";
@@ -32,22 +34,29 @@ VideoBuffer::VideoBuffer(void):tmpFilesO(),tmpFilesE(),pFrameCnt(0),buffCnt(0)
 
 VideoBuffer::~VideoBuffer(void)
 {
-	//delete temporary files on hard disk
-	while( tmpFilesO.size()> 0 )
+	pCompressionQueue.close();
+	pCompressionWorkers.join_all();
+
+	if( pSpillWriter==NULL ) return;
+
+	// frames that haven't been written yet are discarded, then the temporary files on hard disk are deleted unless the archive is to be kept
+	pSpillWriter->close( keep_archive );
+	vector<string> files = pSpillWriter->files();
+	delete pSpillWriter;
+
+	if( keep_archive )
 	{
-        if( !boost::filesystem::remove( tempVideoFileFolder+"/"+tmpFilesO.top()+"o.avi" ) )
-		{
-			cerr<<endl<<"Temporary video file "<<tmpFilesO.top() << "o.avi" << " could not be removed."<<endl;
-		}
-		else tmpFilesO.pop();
+		if( !files.empty() ) cout<<endl<<"The recorded frames were archived in "<<files[0]<<"."<<endl;
+		return;
 	}
-	while( tmpFilesE.size()> 0 )
+
+	for( unsigned int i=0; i<files.size(); i++ )
 	{
-        if( !boost::filesystem::remove( tempVideoFileFolder+"/"+tmpFilesE.top()+"e.avi"  ) )
+		boost::system::error_code error;
+		if( boost::filesystem::exists( files[i], error ) && !boost::filesystem::remove( files[i], error ) )
 		{
-			cerr<<endl<<"Temporary video file " << tmpFilesE.top() <<"e.avi"<<" could not be removed." << endl ;
+			cerr<<endl<<"Temporary video file "<<files[i]<<" could not be removed."<<endl;
 		}
-		else tmpFilesE.pop();
 	}
 }
 
@@ -57,162 +66,266 @@ Frame& VideoBuffer::operator<<( Frame& _frame )
 	//uncompressed memory first
 	pFrameCnt++;
 
-	pUBuffer.push_front( _frame );
-
-	unsigned int pUBufferSize = pUBuffer.size()*pUBuffer.back().memUsage(); // [Byte]
-	
-	if( pUBufferSize <= max_video_ram_usage ) return _frame;
-	
-	if( pUBuffer.size()==1 )
+	unsigned int frameSize = _frame.memUsage(); // [Byte]
+	if( frameSize > max_video_ram_usage )
 	{
 		cerr << endl << "Frame& VideoBuffer::operator<<( Frame& _frame ):: Warning: Not enough RAM assigned to hold even 1 frame. Ignoring RAM size assignment." << endl;
-		return _frame;
 	}
 
-	if( !record_input )
+	// the number of slots only changes with the format of the frames
+	if( pUBufferCount==0 || slot(0).original().size()!=_frame.original().size() || slot(0).original().type()!=_frame.original().type() ) fitCapacity( frameSize );
+
+	// the oldest frame is overwritten if the ring is full, unless it moves on to the compressed tier
+	if( pUBufferCount==pUBuffer.size() && compressedTierActive() ) compress( slot( pUBufferCount-1 ) );
+	pNewest = ( pNewest+1 )%pUBuffer.size();
+	pUBuffer[pNewest].assign( _frame );
+	if( pUBufferCount<pUBuffer.size() ) pUBufferCount++;
+
+	if( !record_input ) return _frame;
+
+	unsigned int pUBufferSize = pUBufferCount*frameSize; // [Byte]
+	if( pUBufferSize <= max_video_ram_usage || pUBufferCount==1 ) return _frame;
+
+	// dumping is postponed to a later frame if it doesn't fit into the current one anymore, as long as the buffer hasn't grown by more than the amount a dump frees
+	if( pScheduler!=NULL && !pScheduler->allows( FrameScheduler::BUFFER_SPILL ) && pUBufferSize <= max_video_ram_usage/4*5 ) return _frame;
+	spill( frameSize );
+	return _frame;
+}
+
+
+Frame& VideoBuffer::slot( unsigned int _i )
+{
+	return pUBuffer[ ( pNewest+pUBuffer.size()-_i )%pUBuffer.size() ];
+}
+
+const Frame& VideoBuffer::slot( unsigned int _i ) const
+{
+	return pUBuffer[ ( pNewest+pUBuffer.size()-_i )%pUBuffer.size() ];
+}
+
+
+void VideoBuffer::fitCapacity( unsigned int _frameSize )
+{
+	unsigned int capacity = ( _frameSize==0 )? 1 : max_video_ram_usage/_frameSize;
+	if( record_input && _frameSize!=0 ) capacity = max_video_ram_usage/4*5/_frameSize+1; // room for the frames whose dumping was postponed
+	if( capacity==0 ) capacity = 1;
+	if( capacity==pUBuffer.size() ) return;
+
+	unsigned int kept = ( pUBufferCount<capacity )? pUBufferCount : capacity;
+	std::vector<Frame> ring( capacity );
+	for( unsigned int i=0; i<kept; i++ ) ring[kept-1-i] = slot(i);
+
+	pUBuffer.swap( ring );
+	pNewest = ( kept==0 )? capacity-1 : kept-1;
+	pUBufferCount = kept;
+}
+
+
+void VideoBuffer::spill( unsigned int _frameSize )
+{
+	double spillStart = FrameScheduler::now();
+
+	// the writing takes place on the writer's thread, handing a frame over only waits if the writer's queue is full
+	if( pSpillWriter==NULL ) pSpillWriter = new SpillWriter( tempFileFolder(), tempFileName(), recordsThumbnails() );
+
+	// hands 3/4 of the buffer over, the slots are reused for the following frames (they get new buffers as long as the writer still holds the old ones)
+	while( pUBufferCount>0 && pUBufferCount*_frameSize > max_video_ram_usage*3/4 )
 	{
-		pUBuffer.pop_back();
-		return _frame;
+		pSpillWriter->push( slot( pUBufferCount-1 ) );
+		pUBufferCount--;
 	}
-	
-	boost::filesystem::create_directory( tempFileFolder() );
+	if( pScheduler!=NULL ) pScheduler->reportCost( FrameScheduler::BUFFER_SPILL, FrameScheduler::now()-spillStart );
+}
 
-	stringstream tName;
-	tName << tempFileName() << buffCnt++ ;
-	string tmpName;
-	tName >> tmpName;
 
-	tmpFilesO.push( tmpName );
-	tmpFilesE.push( tmpName );
+bool VideoBuffer::compressedTierActive() const
+{
+	return max_compressed_ram_usage>0 && !record_input;
+}
 
-	// HFYU : Files equivalent 17.9 MB huffman lossless codec
-	// with loss: MPEG
 
-    VideoWriter vOriginal( tempVideoFileFolder+"/"+tmpFilesO.top()+"o.avi", CV_FOURCC('H','F','Y','U'), 30, Size(640,480),true );
-    VideoWriter vEdited( tempVideoFileFolder+"/"+tmpFilesE.top()+"e.avi", CV_FOURCC('H','F','Y','U'), 30, Size(640,480),true );
-	
-	if( !vOriginal.isOpened() || !vEdited.isOpened() )
+void VideoBuffer::compress( Frame& _slot )
+{
+	boost::mutex::scoped_lock lock( pCompressionMutex );
+	if( pCompressionWorkers.size()==0 )
 	{
-			cerr<<endl<<"Frame& VideoBuffer::operator<<( Frame& _frame ):: Temporary video files couldn't be written. Data is lost."<<endl;
-			tmpFilesO.pop();
-			tmpFilesE.pop();
-			pUBuffer.pop_back();
+		CompressedFrame::setupOptions();
+		unsigned int threads = ( compression_threads==0 )? 1 : compression_threads;
+		pCompressionQueue.setCapacity( 2*threads );
+		for( unsigned int i=0; i<threads; i++ ) pCompressionWorkers.create_thread( boost::bind( &VideoBuffer::compressionThread, this ) );
 	}
 
-	// dumps 3/4 of the buffer to hard drive
-	while( pUBuffer.size()*pUBuffer.back().memUsage() > max_video_ram_usage*3/4 )
+	// this is the only thread adding jobs: pushing won't block if there is room now
+	if( pCompressionQueue.size()>=pCompressionQueue.capacity() )
 	{
-		Frame buffFrame = pUBuffer.back();
-		pUBuffer.pop_back();
-		
-		vOriginal << buffFrame.original();
-		vEdited << buffFrame.edited();
+		// a placeholder keeps the numbering of the following frames, the slot keeps its buffers
+		Ptr<CompressedFrame> placeholder = new CompressedFrame();
+		placeholder->pTime = _slot.time();
+		placeholder->pComplete = true;
+		placeholder->pDropped = true;
+		pCBuffer.push_front( placeholder );
+		pCBufferBytes += placeholder->memUsage();
+		pCompressionStatistics.dropped++;
+		return;
 	}
-	
-	/* saving files using png compression for each frame -> writing process wasn't finished since the compression
-	* stage takes too much time for real time application */
-	/*
-	//compress memory
-	CompressedFrame cFrame( pUBuffer.back() );
-
-	pCBuffer.push_front( cFrame );
-	pUBuffer.pop_back();
 
-	int maxCompressedBufferSize = 1024*1024*Options::General["runtime"]["memory"]["max_video_ram_usage"].as<int>();
-	int cBufferSizeEstimate = pCBuffer.front().memUsage()*pCBuffer.size();//using size of first frame in buffer as estimate for size of the other frames
+	pCompressionStatistics.queued++;
+	CompressionJob job;
+	job.frame = _slot;
+	job.target = new CompressedFrame();
+	pCBuffer.push_front( job.target );
 
-	if( cBufferSizeEstimate <= maxCompressedBufferSize ) return _frame;
-
-	//safe 50% of compressed buffer content to hard drive
-	boost::filesystem::create_directory( tempFileFolder() );
+	if( pSpareFrames.empty() ) _slot = Frame();
+	else
+	{
+		_slot = pSpareFrames.front();
+		pSpareFrames.pop_front();
+	}
+	lock.unlock();
 
-	string tmpFileName = tempFileName();
-	tmpFilesO.push( tmpFileName );
+	pCompressionQueue.push( job );
+}
 
-	std::string filePath = Options::General["general_settings"]["program_folder"].as<string>()+"\\"+tempVideoFileFolder + "\\" + tmpFileName+"o.avi";
-	
-	ofstream tempVideoFile( filePath, ios::out | ios::app | ios::binary ); //appending data to file
-	
 
-	while( pCBuffer.front().memUsage()*pCBuffer.size() > 0.5*maxCompressedBufferSize )
+void VideoBuffer::compressionThread()
+{
+	CompressionJob job;
+	while( pCompressionQueue.pop( job ) )
 	{
-		CompressedFrame frameToSave = pCBuffer.back();
-		pCBuffer.pop_back();
+		job.target->encode( job.frame );
+
+		boost::mutex::scoped_lock lock( pCompressionMutex );
+		job.target->pComplete = true;
+		pCBufferBytes += job.target->memUsage();
+		pCompressionStatistics.compressed++;
 
-		if( !tempVideoFile.is_open() ) std::cerr<<endl<<"Temporary video file couldn't be accessed or written."<<endl;
-		else
+		// the oldest complete frames are dropped if the budget is exceeded, placeholders of dropped frames once they are the oldest entries
+		while( !pCBuffer.empty() && pCBuffer.back()->pComplete && ( pCBufferBytes>max_compressed_ram_usage || pCBuffer.back()->pDropped ) )
 		{
-			tempVideoFile.write( reinterpret_cast<char*>( frameToSave.pOriginal.data() ), frameToSave.pOriginal.size()*sizeof(uchar) );
-			tempVideoFile.write( reinterpret_cast<char*>( frameToSave.pEdited.data() ), frameToSave.pEdited.size()*sizeof(uchar) );
+			pCBufferBytes -= pCBuffer.back()->memUsage();
+			pCBuffer.pop_back();
 		}
+
+		if( pSpareFrames.size()<pCompressionQueue.capacity() ) pSpareFrames.push_back( job.frame );
+		job = CompressionJob();
+		pCompressionDone.notify_all();
 	}
-	tempVideoFile.close();
-	*/
-	return _frame;
+}
+
+
+bool VideoBuffer::loadStored( unsigned int _i ) const
+{
+	boost::mutex::scoped_lock lock( pCompressionMutex );
+	if( _i>=pCBuffer.size() )
+	{
+		// recorded frames
+		_i -= pCBuffer.size();
+		lock.unlock();
+		Frame archived;
+		if( pSpillWriter==NULL || !pSpillWriter->load( _i, archived ) ) return false;
+		lock.lock();
+		pDecoded = archived;
+		return true;
+	}
+
+	std::list< Ptr<CompressedFrame> >::const_iterator entry = pCBuffer.begin();
+	std::advance( entry, _i );
+	Ptr<CompressedFrame> compressed = *entry; // keeps the entry alive if it is dropped meanwhile
+	if( compressed->pDropped ) return false;
+	while( !compressed->pComplete ) pCompressionDone.wait( lock );
+	lock.unlock();
+
+	Frame decoded = compressed->decode();
+	lock.lock();
+	pDecoded = decoded;
+	return true;
+}
+
+
+long VideoBuffer::find( double _time ) const
+{
+	for( unsigned int i=0; i<pUBufferCount; i++ )
+	{
+		if( slot(i).time()<=_time ) return i;
+	}
+	long number = pUBufferCount;
+
+	boost::mutex::scoped_lock lock( pCompressionMutex );
+	for( std::list< Ptr<CompressedFrame> >::const_iterator it=pCBuffer.begin(); it!=pCBuffer.end(); it++, number++ )
+	{
+		if( (*it)->pComplete && !(*it)->pDropped && (*it)->time()<=_time ) return number;
+	}
+	lock.unlock();
+
+	if( pSpillWriter==NULL ) return -1;
+	long recorded = pSpillWriter->find( _time );
+	return ( recorded<0 )? -1 : number+recorded;
 }
 
 
 Mat& VideoBuffer::operator<<( Mat& /*_image*/ )
 {
-	return pUBuffer.front().edited();
+	return slot(0).edited();
 }
 
 
 bool VideoBuffer::operator>>( Frame& _frame )
 {
-	if( pUBuffer.size()==0 )
+	if( pUBufferCount==0 )
 	{
 		cerr << endl << "bool VideoBuffer::operator>>( Frame& _frame ):: Attempting to load frame from empty buffer." << endl;
 		return false;
 	}
 
-	_frame = pUBuffer.front();
-	pUBuffer.pop_front();
+	_frame = slot(0);
+	pNewest = ( pNewest+pUBuffer.size()-1 )%pUBuffer.size();
+	pUBufferCount--;
 	return true;
 }
 
 
 bool VideoBuffer::operator>>( Mat& _image )
 {
-	if( pUBuffer.size()==0 )
+	if( pUBufferCount==0 )
 	{
 		cerr << endl << "bool VideoBuffer::operator>>( Mat& _image ):: Attempting to load image from empty buffer." << endl;
 		return false;
 	}
 
-	_image = pUBuffer.front().edited();
+	_image = slot(0).edited();
 	return true;
 }
 
 Mat& VideoBuffer::grey()
 {
-	return pUBuffer.front().grey();
+	return slot(0).grey();
 }
 
 
 Frame VideoBuffer::loadOldest()
 {
-	if( pUBuffer.size()==0 )
+	if( pUBufferCount==0 )
 	{
 		cerr << endl << "Frame& VideoBuffer::loadOldest():: Attempting to load oldest frame from empty buffer. Returned empty frame is not writable and attempting to do say may lead to memory faults."<<endl;
 		throw 1;
 	}
 
-	Frame _oldest = pUBuffer.back();
-	pUBuffer.pop_back();
+	Frame _oldest = slot( pUBufferCount-1 );
+	pUBufferCount--;
 	return _oldest;
 }
 
 
 Frame& VideoBuffer::load( unsigned int _i )
 {
-	if( _i>=pUBuffer.size() )
+	if( _i>=pUBufferCount && !loadStored( _i-pUBufferCount ) )
 	{
 		cerr << endl << "Frame& VideoBuffer::load( unsigned int _i ):: Attempting to load frame "<<_i<<" from buffer which isn't accessible. Returned empty frame is not writable and attempting to do say may lead to memory faults."<<endl;
 		throw 1;
 	}
 
-	return pUBuffer[_i];
+	if( _i>=pUBufferCount ) return pDecoded;
+	return slot(_i);
 }
 
 Frame& VideoBuffer::operator[]( unsigned int _i )
@@ -223,25 +336,27 @@ Frame& VideoBuffer::operator[]( unsigned int _i )
 
 Mat& VideoBuffer::loadMat( unsigned int _i )
 {
-	if( _i>=pUBuffer.size() )
+	if( _i>=pUBufferCount && !loadStored( _i-pUBufferCount ) )
 	{
 		cerr << endl << "Mat& VideoBuffer::loadMat( unsigned int _i ):: Attempting to load Mat "<<_i<<" from buffer which isn't accessible. Returned empty frame is not writable and attempting to do so may lead to memory faults."<<endl;
 		throw 1;
 	}
 
-	return pUBuffer[_i].edited();
+	if( _i>=pUBufferCount ) return pDecoded.edited();
+	return slot(_i).edited();
 }
 
 
 Mat const& VideoBuffer::loadOriginal( unsigned int _i ) const
 {
-	if( _i>=pUBuffer.size() )
+	if( _i>=pUBufferCount && !loadStored( _i-pUBufferCount ) )
 	{
 		cerr << endl << "Mat& VideoBuffer::loadOriginal( unsigned int _i ):: Attempting to load original Mat "<<_i<<" from buffer which isn't accessible. "<<endl;
 		throw 1;
 	}
 
-	return pUBuffer[_i].original();
+	if( _i>=pUBufferCount ) return pDecoded.original();
+	return slot(_i).original();
 }
 
 
@@ -251,6 +366,59 @@ unsigned int VideoBuffer::buffSize() const
 }
 
 
+void VideoBuffer::setScheduler( FrameScheduler* _scheduler )
+{
+	pScheduler = _scheduler;
+}
+
+
+void VideoBuffer::memoryReport( MemoryReport& _report ) const
+{
+	// the slots that don't hold a frame at the moment keep their buffers for the next frames and are counted as well
+	set<const uchar*> counted;
+	for( std::vector<Frame>::const_iterator it=pUBuffer.begin(); it!=pUBuffer.end(); it++ )
+	{
+		_report.frameBuffer += it->memUsage( counted );
+	}
+	_report.bufferedFrames += pUBufferCount;
+
+	boost::mutex::scoped_lock lock( pCompressionMutex );
+	for( std::list< Ptr<CompressedFrame> >::const_iterator it=pCBuffer.begin(); it!=pCBuffer.end(); it++ )
+	{
+		if( !(*it)->pComplete || (*it)->pDropped ) continue;
+		_report.compressedBuffer += (*it)->pOriginal.capacity() + (*it)->pEdited.capacity();
+		_report.compressedFrames++;
+	}
+	for( std::list<Frame>::const_iterator it=pSpareFrames.begin(); it!=pSpareFrames.end(); it++ ) _report.frameBuffer += it->memUsage( counted );
+	lock.unlock();
+
+	if( pSpillWriter==NULL ) return;
+	_report.frameBuffer += pSpillWriter->queuedMemUsage( counted );
+	SpillWriter::Statistics spillStatistics = pSpillWriter->statistics();
+	_report.diskSpill += spillStatistics.bytes;
+	_report.spillFiles += spillStatistics.files;
+}
+
+
+const ThumbnailArchive* VideoBuffer::thumbnails() const
+{
+	if( pSpillWriter==NULL ) return NULL;
+	return pSpillWriter->thumbnails();
+}
+
+SpillWriter::Statistics VideoBuffer::spillStatistics() const
+{
+	if( pSpillWriter==NULL ) return SpillWriter::Statistics();
+	return pSpillWriter->statistics();
+}
+
+VideoBuffer::CompressionStatistics VideoBuffer::compressionStatistics() const
+{
+	boost::mutex::scoped_lock lock( pCompressionMutex );
+	return pCompressionStatistics;
+}
+
+
 std::string VideoBuffer::tempFileName()
 {
 	time_t currentTime;
@@ -272,15 +440,35 @@ std::string VideoBuffer::tempFileFolder()
 	return tempVideoFileFolder;
 }
 
+bool VideoBuffer::recordsOverlay()
+{
+	return record_input && record_overlay && !record_thumbnails;
+}
+
+bool VideoBuffer::recordsThumbnails()
+{
+	return record_input && record_thumbnails;
+}
+
 bool VideoBuffer::setupOptions()
 {
 	Options::load_options();
 	max_video_ram_usage = 1024*1024*(*Options::General)["runtime"]["memory"]["max_video_ram_usage"].as<int>(); // [Byte]
 	record_input = (*Options::General)["runtime"]["buffer"]["record_input"].as<bool>();
+	keep_archive = (*Options::General)["runtime"]["buffer"]["keep_archive"].as<bool>();
+	record_overlay = (*Options::General)["runtime"]["buffer"]["record_overlay"].as<bool>();
+	record_thumbnails = (*Options::General)["runtime"]["buffer"]["record_thumbnails"].as<bool>();
 	temporary_folder_path = (*Options::General)["runtime"]["memory"]["temporary_folder_path"].as<string>();
+	max_compressed_ram_usage = (size_t)1024*1024*(*Options::General)["runtime"]["memory"]["max_compressed_ram_usage"].as<int>(); // [Byte]
+	compression_threads = (*Options::General)["runtime"]["compression"]["threads"].as<unsigned int>();
 	return true;
 }
 
 unsigned int VideoBuffer::max_video_ram_usage; // [Byte]
+size_t VideoBuffer::max_compressed_ram_usage; // [Byte]
+unsigned int VideoBuffer::compression_threads;
 bool VideoBuffer::record_input;
+bool VideoBuffer::keep_archive;
+bool VideoBuffer::record_overlay;
+bool VideoBuffer::record_thumbnails;
 std::string VideoBuffer::temporary_folder_path;
@@ -20,6 +20,8 @@
 */
 
 #include "frame.h"
+#include "MemoryReport.h"
+#include "opencv2/imgproc/imgproc.hpp"
 
 
 Frame::Frame(void)
@@ -30,12 +32,10 @@ Frame::Frame(void)
 Frame::Frame(Mat _original, double _time)
 {
 	pOriginal = _original;
-	pEdited = _original.clone();
+	pEdited = _original;
 	pTime = _time;
 
-	Mat channels[3];
-	split( _original, channels );
-	pGreyscale = channels[0];
+	extractGrey();
 }
 
 Frame::Frame(Mat _original, Mat _edited, double _time)
@@ -44,9 +44,7 @@ Frame::Frame(Mat _original, Mat _edited, double _time)
 	pEdited = _edited;
 	pTime = _time;
 
-	Mat channels[3];
-	split( _edited, channels );
-	pGreyscale = channels[0];
+	extractGrey();
 }
 
 Frame::~Frame(void)
@@ -74,9 +72,167 @@ double Frame::time() const
 	return pTime;
 }
 
+
+Mat& Frame::editableEdited()
+{
+	if( !pEdited.empty() && ( pEdited.datastart==pOriginal.datastart || pEdited.datastart==pGreyscale.datastart ) ) pEdited = copyToSpare( pEdited, pSpares ); // the greyscale view keeps the unedited data
+	return pEdited;
+}
+
+Mat& Frame::annotatableEdited()
+{
+	if( pEdited.channels()!=1 ) return editableEdited();
+
+	// monochrome frames are only converted to colour when something is drawn into them
+	Mat colour = takeSpare( pEdited.size(), CV_MAKETYPE( pEdited.depth(), 3 ), pSpares );
+	cvtColor( pEdited, colour, CV_GRAY2BGR );
+	pEdited = colour;
+	return pEdited;
+}
+
+Mat& Frame::editableGrey()
+{
+	if( !pGreyscale.empty() && ( pGreyscale.datastart==pEdited.datastart || pGreyscale.datastart==pOriginal.datastart ) ) pGreyscale = copyToSpare( pGreyscale, pSpares );
+	return pGreyscale;
+}
+
+
+void Frame::extractGrey()
+{
+	if( pEdited.channels()==1 )
+	{
+		pGreyscale = pEdited;
+		return;
+	}
+
+	// only the first channel is needed: copying it directly avoids allocating and filling a plane for every channel
+	pGreyscale = takeSpare( pEdited.size(), CV_MAKETYPE( pEdited.depth(), 1 ), pSpares );
+	int fromTo[] = { 0,0 };
+	mixChannels( &pEdited, 1, &pGreyscale, 1, fromTo, 1 );
+}
+
+void Frame::assign( const Frame& _frame )
+{
+	// the buffers are released from the headers first, a buffer with a reference count of one is then only held by this frame
+	std::vector<Mat> spares;
+	if( !pOriginal.empty() ) spares.push_back( pOriginal );
+	if( !pEdited.empty() && pEdited.datastart!=pOriginal.datastart ) spares.push_back( pEdited );
+	if( !pGreyscale.empty() && pGreyscale.datastart!=pEdited.datastart && pGreyscale.datastart!=pOriginal.datastart ) spares.push_back( pGreyscale );
+	pOriginal.release();
+	pEdited.release();
+	pGreyscale.release();
+
+	pOriginal = copyToSpare( _frame.pOriginal, spares );
+	if( !sharedView( _frame.pEdited, _frame.pOriginal, pOriginal, pEdited ) ) pEdited = copyToSpare( _frame.pEdited, spares );
+	if( !sharedView( _frame.pGreyscale, _frame.pEdited, pEdited, pGreyscale ) && !sharedView( _frame.pGreyscale, _frame.pOriginal, pOriginal, pGreyscale ) ) pGreyscale = copyToSpare( _frame.pGreyscale, spares );
+	pTime = _frame.pTime;
+	pOverlay = _frame.pOverlay;
+	pObjectRegions = _frame.pObjectRegions;
+}
+
+
+void Frame::recycle()
+{
+	// the original and views of it belong to the caller, everything else was allocated by the frame
+	if( !pEdited.empty() && pEdited.datastart!=pOriginal.datastart ) pSpares.push_back( pEdited );
+	if( !pGreyscale.empty() && pGreyscale.datastart!=pEdited.datastart && pGreyscale.datastart!=pOriginal.datastart ) pSpares.push_back( pGreyscale );
+	while( pSpares.size()>maxSpares ) pSpares.erase( pSpares.begin() ); // buffers still held elsewhere are given up eventually
+
+	pOriginal.release();
+	pEdited.release();
+	pGreyscale.release();
+	pTime = 0;
+	pOverlay.release();
+	pObjectRegions.clear();
+}
+
+void Frame::set( Mat _original, Mat _edited, double _time )
+{
+	pOriginal = _original;
+	pEdited = _edited;
+	pTime = _time;
+
+	extractGrey();
+}
+
+Mat Frame::spareCopy( const Mat& _image )
+{
+	return copyToSpare( _image, pSpares );
+}
+
+
+void Frame::setOverlay( Ptr<FrameOverlay> _overlay )
+{
+	pOverlay = _overlay;
+}
+
+Ptr<FrameOverlay> Frame::overlay() const
+{
+	return pOverlay;
+}
+
+
+void Frame::setObjectRegions( const std::vector<ObjectRegion>& _regions )
+{
+	pObjectRegions = _regions;
+}
+
+const std::vector<Frame::ObjectRegion>& Frame::objectRegions() const
+{
+	return pObjectRegions;
+}
+
+
+Mat Frame::takeSpare( Size _size, int _type, std::vector<Mat>& _spares )
+{
+	for( std::vector<Mat>::iterator it=_spares.begin(); it!=_spares.end(); it++ )
+	{
+		if( it->size()!=_size || it->type()!=_type || it->refcount==NULL || *(it->refcount)!=1 ) continue;
+		Mat spare = *it;
+		_spares.erase( it );
+		return spare;
+	}
+	return Mat( _size, _type );
+}
+
+Mat Frame::copyToSpare( const Mat& _source, std::vector<Mat>& _spares )
+{
+	if( _source.empty() ) return Mat();
+
+	Mat copy = takeSpare( _source.size(), _source.type(), _spares );
+	_source.copyTo( copy );
+	return copy;
+}
+
+
+bool Frame::sharedView( const Mat& _view, const Mat& _base, const Mat& _baseCopy, Mat& _copy )
+{
+	if( _view.empty() || _base.empty() || _view.datastart!=_base.datastart ) return false;
+
+	Size wholeSize;
+	Point viewOffset, baseOffset;
+	_view.locateROI( wholeSize, viewOffset );
+	_base.locateROI( wholeSize, baseOffset );
+	Rect area( viewOffset-baseOffset, _view.size() );
+	if( _view.type()!=_base.type() || ( area & Rect( Point(0,0), _baseCopy.size() ) )!=area ) return false;
+
+	_copy = _baseCopy( area );
+	return true;
+}
+
+
 int Frame::memUsage() const
 {
 	int origSize = pOriginal.total()*pOriginal.elemSize();
-	int editSize = pEdited.total()*pEdited.elemSize();
-	return origSize + editSize + sizeof(double);
+	int editSize = ( pEdited.datastart==pOriginal.datastart )? 0 : pEdited.total()*pEdited.elemSize(); // shared until written to
+	int overlaySize = ( pOverlay.empty() )? 0 : pOverlay->memUsage();
+	return origSize + editSize + overlaySize + sizeof(double);
+}
+
+size_t Frame::memUsage( std::set<const uchar*>& _counted ) const
+{
+	size_t overlaySize = ( pOverlay.empty() )? 0 : pOverlay->memUsage();
+	size_t spareSize = 0;
+	for( std::vector<Mat>::const_iterator it=pSpares.begin(); it!=pSpares.end(); it++ ) spareSize += MemoryReport::matMemUsage( *it, _counted );
+	return MemoryReport::matMemUsage( pOriginal, _counted ) + MemoryReport::matMemUsage( pEdited, _counted ) + MemoryReport::matMemUsage( pGreyscale, _counted ) + spareSize + overlaySize;
 }
@@ -140,52 +140,60 @@ void ObjectHandler::buildObjList( vector< list<Ptr<SceneObject> >::iterator >& _
 
 void ObjectHandler::pushFrame( Mat& _img, Mat& _outputImage, double _time )
 {
+	Detection detection;
+	detect( _img, detection );
+	track( detection, _outputImage, _time );
+	return;
+}
 
-	//double time1 = SceneHandler::msTime();
 
-	pImageHeight = _img.size().height;
-	pImageWidth = _img.size().width;
-	pActualTime = _time;
+void ObjectHandler::detect( Mat& _img, Detection& _detection )
+{
+	Profiler& profiler = pScene->profile();
+
 	/*cout<<endl<<"Nr of categorized objects:"<<pCategorized.size();
 	cout<<endl<<"Nr of uncategorized objects:"<<pUncategorized.size();
 	cout<<endl<<"Nr of missing objects:"<<pMissing.size();
 	cout<<endl<<"Nr of lost objects:"<<pLost.size()<<endl;*/
 	
 	// useful image versions
-	Mat greyImg = _img;
-	Mat invGreyImg;
+	_detection.grey = _img;
 	Mat binaryImg;
 
-	bitwise_not( greyImg, invGreyImg ); // calculates image inverse
-	threshold( greyImg, binaryImg, pThreshold, 255, THRESH_BINARY_INV ); // calculates inverted binary black white image
-	Mat corners;
-	//imshow("binary",binaryImg);
-	// list with all active objects
-    vector< list<Ptr<SceneObject> >::iterator > objList;
-	buildObjList( objList );
-
-	/*for( int i=0;i<objList.size();i++ )
+	Profiler::Section thresholdSection( profiler, Profiler::THRESHOLD );
+	// the pyramid is built once, levels that would get too small to hold any object are not created
+	const int minPyramidSize = 32;
+	_detection.pyramid.assign( 1, _detection.grey );
+	for( unsigned int level=1; level<=pyramid_levels; level++ )
 	{
-		
-		vector<Point> predictedROI;
-		( **objList[ i ] ).predictROI( predictedROI );
-		//cout<<endl<<"Predicted region "<<i<<": "<<Mat(predictedROI);
-		RectangleRegion predictedRegion( predictedROI[0], predictedROI[1], predictedROI[2], predictedROI[3] );
-		predictedRegion.draw(_outputImage,Scalar(38,38,255) );
-	}*/
+		Mat& finer = _detection.pyramid.back();
+		if( finer.cols<2*minPyramidSize || finer.rows<2*minPyramidSize ) break;
+		Mat coarser;
+		pyrDown( finer, coarser );
+		_detection.pyramid.push_back( coarser );
+	}
+	Mat& coarsest = _detection.pyramid.back();
+	int scale = 1<<( _detection.pyramid.size()-1 );
+	bool coarseToFine = scale>1;
+
+	if( !coarseToFine ) bitwise_not( _detection.grey, _detection.invGrey ); // calculates image inverse
+	threshold( coarsest, binaryImg, pThreshold, 255, THRESH_BINARY_INV ); // calculates inverted binary black white image
+	//imshow("binary",binaryImg);
 
 	// find objects in frame
 
 	//Mat binaryColor; // necessary in a separate if statement because the contour operation alters the binary input image
 	if( create_threshold_detection_image )
 	{
-		binaryImg.copyTo(pThresholdImage);
-		cv::cvtColor(pThresholdImage,pThresholdImage, CV_GRAY2BGR );
+		if( coarseToFine ) resize( binaryImg, _detection.thresholdImage, _detection.grey.size(), 0, 0, INTER_NEAREST );
+		else binaryImg.copyTo(_detection.thresholdImage);
+		cv::cvtColor(_detection.thresholdImage,_detection.thresholdImage, CV_GRAY2BGR );
 	}
+	thresholdSection.stop();
 
-	vector< vector<Point> > contours;
-	vector< RectangleRegion > regions;
-	objRegions( binaryImg, contours, regions );
+	Profiler::Section regionSection( profiler, Profiler::OBJ_REGIONS );
+	objRegions( binaryImg, _detection.contours, _detection.regions, scale );
+	regionSection.stop();
 
 	
 	//for(int i=0;i<regions.size();i++) regions[i].draw(colorImg,Scalar(30,20,240),2);
@@ -193,35 +201,35 @@ void ObjectHandler::pushFrame( Mat& _img, Mat& _outputImage, double _time )
 	if( create_threshold_detection_image )
 	{
 		//pThresholdImage = binaryColor;
-		drawContours( pThresholdImage, contours, -1, Scalar(250,180,110),2 );
-
-		if( draw_predicted_regions )
-		{
-            for( size_t i=0;i<objList.size();i++ )
-			{
-		
-				vector<Point> predictedROI;
-				( **objList[ i ] ).predictROI( predictedROI );
-				RectangleRegion predictedRegion( predictedROI[0], predictedROI[1], predictedROI[2], predictedROI[3] );
-				predictedRegion.draw(pThresholdImage,Scalar(250,230,200) );
-			}
-		}
+		drawContours( _detection.thresholdImage, _detection.contours, -1, Scalar(250,180,110),2 );
 	}
 
 	
 	// find roi regions
-	vector<Rect> roiRegions;
-	calculateROIs( regions, roiRegions );
+	Profiler::Section roiSection( profiler, Profiler::ROI_PROPERTIES );
+	calculateROIs( _detection.regions, _detection.roiRegions );
 		
 	//for(int i=0;i<regions.size();i++) rectangle( colorImg, roiRegions[i],Scalar(30,20,240),2);
 
 	// set RotatedRectangles relative to the ROIs
-	vector<RectangleRegion> transformedRegions;
-	transformToRelative( roiRegions, regions, transformedRegions );
+	transformToRelative( _detection.roiRegions, _detection.regions, _detection.transformedRegions );
 	
+	// the states are refined at full resolution: if the contours were found on a coarser level, only the ROIs are inverted
+	if( coarseToFine )
+	{
+		_detection.invGrey.create( _detection.grey.size(), _detection.grey.type() );
+		_detection.invGrey.setTo( 0 ); // outside the ROIs, which are read with margins (e.g. by the missing object search)
+		for( size_t i=0; i<_detection.roiRegions.size(); i++ )
+		{
+			Mat greyROI, invROI;
+			calculateROIMat( _detection.grey, _detection.roiRegions[i], greyROI );
+			calculateROIMat( _detection.invGrey, _detection.roiRegions[i], invROI );
+			if( !greyROI.empty() ) bitwise_not( greyROI, invROI );
+		}
+	}
+
 	// calculate sub images that contain the found objects
-	vector<Mat> invROIs;
-	calculateROIMats( invGreyImg, roiRegions, invROIs );
+	calculateROIMats( _detection.invGrey, _detection.roiRegions, _detection.invROIs );
 	
 
 	/*Mat colorImg( binaryImg.size(),CV_8UC3);
@@ -230,53 +238,118 @@ void ObjectHandler::pushFrame( Mat& _img, Mat& _outputImage, double _time )
 	imwrite( "D:\\Benutzer\\stewess\\Documents\\ETH\\FS 2014\\Bachelorarbeit\\Matlab\\subimage.jpg",colorImg ); exit(1);
 	*/
 	// calculate states of the object regions found
-	Mat objectStates;
-	roiProperties( invROIs, transformedRegions, roiRegions, objectStates );
+	roiProperties( _detection.invROIs, _detection.transformedRegions, _detection.roiRegions, _detection.objectStates );
+	roiSection.stop();
+	return;
+}
+
+
+void ObjectHandler::track( Detection& _detection, Mat& _outputImage, double _time, FrameOverlay* _overlay )
+{
+	Profiler& profiler = pScene->profile();
+
+	pImageHeight = _detection.grey.size().height;
+	pImageWidth = _detection.grey.size().width;
+	pActualTime = _time;
+
+	Mat& objectStates = _detection.objectStates;
+	vector< vector<Point> >& contours = _detection.contours;
+
+	// list with all active objects
+    vector< list<Ptr<SceneObject> >::iterator > objList;
+	buildObjList( objList );
 
-	//double time2 = SceneHandler::msTime();
+	/*for( int i=0;i<objList.size();i++ )
+	{
+		
+		vector<Point> predictedROI;
+		( **objList[ i ] ).predictROI( predictedROI );
+		//cout<<endl<<"Predicted region "<<i<<": "<<Mat(predictedROI);
+		RectangleRegion predictedRegion( predictedROI[0], predictedROI[1], predictedROI[2], predictedROI[3] );
+		predictedRegion.draw(_outputImage,Scalar(38,38,255) );
+	}*/
+
+	if( create_threshold_detection_image )
+	{
+		if( draw_predicted_regions )
+		{
+            for( size_t i=0;i<objList.size();i++ )
+			{
+		
+				vector<Point> predictedROI;
+				( **objList[ i ] ).predictROI( predictedROI );
+				RectangleRegion predictedRegion( predictedROI[0], predictedROI[1], predictedROI[2], predictedROI[3] );
+				predictedRegion.draw(_detection.thresholdImage,Scalar(250,230,200) );
+			}
+		}
+		pThresholdImage = _detection.thresholdImage;
+	}
 
 	// calculate predicted states of already found objects
+	Profiler::Section predictionSection( profiler, Profiler::PREDICT_PROPERTIES );
 	Mat predictedStates;
 	predictProperties( objList, predictedStates );
+	predictionSection.stop();
 
 	// match objects
+	Profiler::Section matchingSection( profiler, Profiler::MATCH_OBJECTS );
 	vector<int> objectMapping;
 	vector<bool> foundObjects;
 	matchObjects( objectStates, predictedStates, contours, objectMapping, foundObjects );
+	matchingSection.stop();
 
 	#if SHOWMATCHINGSTEPS==1
 	showMatchWindow(objList,predictedStates, objectStates, objectMapping, "after matchObjects()"); 
 	#endif
 
 	// look for previously calculated objects that couldn't be matched to actual frame
+	Profiler::Section areaMatchSection( profiler, Profiler::FIND_POTENTIAL_AREA_MATCHES );
     vector<vector<int> > objectGroups;
-	findPotentialAreaMatchesForMissingObjects( predictedStates, _outputImage, objList, transformedRegions, contours, objectMapping, foundObjects, objectGroups );
+	findPotentialAreaMatchesForMissingObjects( predictedStates, _outputImage, objList, _detection.transformedRegions, contours, objectMapping, foundObjects, objectGroups );
+	areaMatchSection.stop();
 	
 	#if SHOWMATCHINGSTEPS==1
 	showMatchWindow(objList,predictedStates, objectStates, objectMapping, "after findPotentialAreaMatchesForMissingObjects()");
 	#endif
 
-	locateMissingObjects( invGreyImg, _outputImage, objectStates, objList, objectGroups, objectMapping, foundObjects, contours, regions, roiRegions, invROIs );
+	Profiler::Section locateSection( profiler, Profiler::LOCATE_MISSING_OBJECTS );
+	locateMissingObjects( _detection.pyramid, _outputImage, objectStates, objList, objectGroups, objectMapping, foundObjects, contours, _detection.regions, _detection.roiRegions, _detection.invROIs );
+	locateSection.stop();
 	
 	#if SHOWMATCHINGSTEPS==1
 	showMatchWindow(objList,predictedStates, objectStates, objectMapping, "after locateMissingObjects()");
 	#endif
 
 	// update the object lists
-	updateObjects( objList, objectStates, predictedStates, objectMapping, foundObjects, contours, regions, invROIs );
+	Profiler::Section updateSection( profiler, Profiler::UPDATE_OBJECTS );
+	updateObjects( objList, objectStates, predictedStates, objectMapping, foundObjects, contours, _detection.regions, _detection.invROIs );
+	updateSection.stop();
 
-	//double time3 = SceneHandler::msTime();
-	
-	/*ofstream file;
-	file.open( "chronometries.txt", ios_base::app );
-	file<<time2-time1<<" "<<time3-time2;
-	file.close();*/
+	Tracer& tracer = pScene->tracer();
+	if( tracer.active() )
+	{
+		tracer.counter( "contours", contours.size() );
+		vector< pair<string,double> > objectCounts;
+		objectCounts.push_back( make_pair( string("active"), (double)( pCategorized.size()+pUncategorized.size() ) ) );
+		objectCounts.push_back( make_pair( string("missing"), (double)pMissing.size() ) );
+		objectCounts.push_back( make_pair( string("lost"), (double)pLost.size() ) );
+		tracer.counter( "objects", objectCounts );
+	}
 
-	// draw into output frame
-	draw( _outputImage );
+	// draw into output frame - if drawing is put under deadline control it is skipped when it doesn't fit into the frame anymore
+	FrameScheduler& scheduler = pScene->scheduler();
+	if( scheduler.allows( FrameScheduler::DRAWING ) )
+	{
+		Profiler::Section drawSection( profiler, Profiler::DRAW );
+		double drawStart = FrameScheduler::now();
+		draw( _outputImage, _overlay );
+		scheduler.reportCost( FrameScheduler::DRAWING, FrameScheduler::now()-drawStart );
+	}
 
 	// classify objects
-    updateClassifications( greyImg );
+	Profiler::Section classificationSection( profiler, Profiler::UPDATE_CLASSIFICATIONS );
+    updateClassifications( _detection.grey );
+	classificationSection.stop();
 
 	/*
 	for( int i=0; i<objectStates.size().height;i++ )
@@ -451,6 +524,61 @@ void ObjectHandler::activeIdList( vector<unsigned int>& _idList )
 }
 
 
+void ObjectHandler::activeObjects( vector< Ptr<SceneObject> >& _objList, bool _includeMissing )
+{
+	_objList.clear();
+	_objList.reserve( pCategorized.size()+pUncategorized.size()+( _includeMissing? pMissing.size() : 0 ) );
+
+	_objList.insert( _objList.end(), pCategorized.begin(), pCategorized.end() );
+	_objList.insert( _objList.end(), pUncategorized.begin(), pUncategorized.end() );
+	if( _includeMissing ) _objList.insert( _objList.end(), pMissing.begin(), pMissing.end() );
+
+	return;
+}
+
+
+StreamContext& ObjectHandler::stream()
+{
+	return pScene->stream();
+}
+
+
+void ObjectHandler::memoryReport( MemoryReport& _report )
+{
+	set<const uchar*> counted; // path images may be shared between objects
+
+	list< Ptr<SceneObject> >* active[] = { &pCategorized, &pUncategorized, &pMissing };
+	for( int i=0; i<3; i++ )
+	{
+		list< Ptr<SceneObject> >::iterator it, end = active[i]->end();
+		for( it=active[i]->begin(); it!=end; it++ )
+		{
+			_report.histories += (*it)->historyMemUsage();
+			_report.states += (*it)->pHistory.size();
+			_report.activeObjects++;
+
+			Ptr<Mat> path = (*it)->pathImage();
+			if( !path.empty() ) _report.pathImages += MemoryReport::matMemUsage( *path, counted );
+		}
+	}
+	if( !pPathMat.empty() ) _report.pathImages += MemoryReport::matMemUsage( *pPathMat, counted );
+
+	list< Ptr<SceneObject> >::iterator it, end = pLost.end();
+	for( it=pLost.begin(); it!=end; it++ )
+	{
+		_report.lostObjects += (*it)->historyMemUsage();
+		Ptr<Mat> path = (*it)->pathImage();
+		if( !path.empty() ) _report.lostObjects += MemoryReport::matMemUsage( *path, counted );
+		_report.lostCount++;
+	}
+
+	list<DescriptorCreator*>::iterator dIt, dEnd = pDescriptorCreators.end();
+	for( dIt=pDescriptorCreators.begin(); dIt!=dEnd; dIt++ ) _report.descriptorSets += (*dIt)->memUsage();
+
+	return;
+}
+
+
 unsigned int ObjectHandler::lowestActiveId()
 {
 	vector<unsigned int> idList;
@@ -531,20 +659,42 @@ Ptr<SceneObject> ObjectHandler::getObj( unsigned int _objId )
 }
 
 
-void ObjectHandler::objRegions( Mat& _binaryImg, vector< vector<Point> >& _contours, vector<RectangleRegion>& _regions )
+void ObjectHandler::objRegions( Mat& _binaryImg, vector< vector<Point> >& _contours, vector<RectangleRegion>& _regions, int _scale )
 {
 	vector< vector<Point> > tempContours;
 	findContours( _binaryImg, tempContours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE );
 
+	// a pixel on a coarser level covers _scale x _scale pixels of the original image (0.._scale-1), the contour points are mapped to the centers of these blocks
+	if( _scale>1 )
+	{
+		Point offset( (_scale-1)/2, (_scale-1)/2 );
+		for( uint i=0;i<tempContours.size();i++ )
+		{
+			for( uint j=0;j<tempContours[i].size();j++ ) tempContours[i][j] = tempContours[i][j]*_scale+offset;
+		}
+	}
+
 	// filter out regions that are too small
     for( uint i=0;i<tempContours.size();i++ )
 	{
 		double tempArea = contourArea( tempContours[i] );
 		double tempContourLength = arcLength( tempContours[i], true );
+		// the border blocks reach about _scale/2 beyond their centers: the contour is grown by growth/2 on every side (pyramid_region_growth blocks
+		// less the center pixel, one block gives what the contour through the outer pixels of the full resolution image would measure). For the
+		// bounding extent w x h that adds growth*(w+h)+growth^2 to the area and 4*growth to the length
+		int growth = max( 0, cvRound( pyramid_region_growth*( _scale-1 ) ) );
+		if( growth>0 )
+		{
+			Rect extent = boundingRect( tempContours[i] );
+			tempArea += growth*( extent.width-1 + extent.height-1 ) + growth*growth;
+			tempContourLength += 4*growth;
+		}
 		if( ( tempArea>min_area || tempContourLength > contour_length_switch ) && tempArea<max_area )
 		{
 			_contours.push_back(tempContours[i]);
             RotatedRect temp = minAreaRect(tempContours[i]);
+			temp.size.width += growth;
+			temp.size.height += growth;
             _regions.push_back( RectangleRegion( temp ) );
 		}
 
@@ -1032,9 +1182,9 @@ void ObjectHandler::findMissingObjects( Mat& _predictedStates, Mat& /*_outputIma
 }
 
 
-void ObjectHandler::locateMissingObjects( Mat& /*_invGreyImg*/, Mat& /*_outputImage*/, Mat& _objectStates, vector< list<Ptr<SceneObject> >::iterator >& _objList, vector<vector<int> >& _objectGroups, vector<int>& _objectMapping, vector<bool>& _foundObjects, vector<vector<Point> >& _contours, vector<RectangleRegion>& _regions, vector<Rect>& _roiRegions, vector<Mat>& _invROIs )
+void ObjectHandler::locateMissingObjects( vector<Mat>& _pyramid, Mat& /*_outputImage*/, Mat& _objectStates, vector< list<Ptr<SceneObject> >::iterator >& _objList, vector<vector<int> >& _objectGroups, vector<int>& _objectMapping, vector<bool>& _foundObjects, vector<vector<Point> >& _contours, vector<RectangleRegion>& _regions, vector<Rect>& _roiRegions, vector<Mat>& _invROIs )
 {
-	
+	if( _pyramid.empty() ) return;
 
     for( size_t grpId = 0; grpId<_objectGroups.size() ; grpId++ ) // for each group: grp id matches id of associated "found object" (structure) in actual frame
 	{
@@ -1060,29 +1210,52 @@ void ObjectHandler::locateMissingObjects( Mat& /*_invGreyImg*/, Mat& /*_outputIm
 		}
 
 		// region of interest containing the whole structure:
-		Mat groupROI = pVideo->grey();
+		Mat fullResolution = _pyramid.front();
 		int lowerYBoundary = (roi.y>=0)?roi.y:0;
 		int lowerXBoundary = (roi.x>=0)?roi.x:0;
 		int upperYBoundary = roi.y+roi.height;
 		int upperXBoundary = roi.x+roi.width;
-		upperYBoundary = (upperYBoundary<=groupROI.rows)?upperYBoundary:groupROI.rows;
-		upperXBoundary = (upperXBoundary<=groupROI.cols)?upperXBoundary:groupROI.cols;
-
-		groupROI = groupROI( Range(lowerYBoundary,upperYBoundary),Range(lowerXBoundary,upperXBoundary) );
+		upperYBoundary = (upperYBoundary<=fullResolution.rows)?upperYBoundary:fullResolution.rows;
+		upperXBoundary = (upperXBoundary<=fullResolution.cols)?upperXBoundary:fullResolution.cols;
+
+		// the corners are searched on the pyramid level set, the window sizes of the search shrink with the level
+		unsigned int level = min<size_t>( missing_search_pyramid_level, _pyramid.size()-1 );
+		int scale = 1<<level;
+		int harrisBlockSize = max( 2, 6/scale );
+		int harrisApertureSize = ( scale>1 )? 3 : 5;
+		unsigned int maximaRange = max( 1, 3/scale );
+
+		Mat levelImage = _pyramid[level];
+		int levelLowerY = lowerYBoundary/scale;
+		int levelLowerX = lowerXBoundary/scale;
+		int levelUpperY = min( ( upperYBoundary+scale-1 )/scale, levelImage.rows );
+		int levelUpperX = min( ( upperXBoundary+scale-1 )/scale, levelImage.cols );
+		if( levelUpperY<=levelLowerY || levelUpperX<=levelLowerX ) continue;
+		Mat levelROI = levelImage( Range(levelLowerY,levelUpperY),Range(levelLowerX,levelUpperX) );
 		
 		
 		// corner harris precalculations: calculate relevant corner points
 		Mat cH;
 
-		cornerHarris(groupROI,cH,6,5,0.04); //3-11-0.07 //src,dst,blocksize,ksize(1,3,5or7),k //6-5-0.04
+		cornerHarris(levelROI,cH,harrisBlockSize,harrisApertureSize,0.04); //3-11-0.07 //src,dst,blocksize,ksize(1,3,5or7),k //6-5-0.04
 		
 		Mat localMaxima;
 
-		calcLocalMaxima( cH,localMaxima,3,0.1 );
+		calcLocalMaxima( cH,localMaxima,maximaRange,0.1 );
 
 
 		if( localMaxima.empty() ) continue;
 		if( localMaxima.size().height<2 ) continue; // not enough points in set
+
+		// corners of a coarser level are mapped to the centers of their blocks, relative to the full resolution group ROI
+		if( scale>1 )
+		{
+			for( int i=0; i<localMaxima.rows; i++ )
+			{
+				localMaxima.at<float>(i,0) = ( levelLowerX+localMaxima.at<float>(i,0) )*scale + (scale-1)/2 - lowerXBoundary;
+				localMaxima.at<float>(i,1) = ( levelLowerY+localMaxima.at<float>(i,1) )*scale + (scale-1)/2 - lowerYBoundary;
+			}
+		}
 		/*
 		for( int i=0; i<localMaxima.rows; i++ )
 		{
@@ -2025,16 +2198,17 @@ void ObjectHandler::updateClassifications( Mat _image )
 {
 	if( pObjectTypesInScene.size()==0 ) setupObjectTypesInfo(true);
 
-	double timeLeft = pScene->timeLeft()-time_overhead;
+	FrameScheduler& scheduler = pScene->scheduler();
 
     int nrOfClassifiableObjects = pUncategorized.size()+pCategorized.size();
 
-	for( int i=0; i < nrOfClassifiableObjects && (timeLeft > pEstimatedClassificationTime || !time_awareness); i++ )
+	for( int i=0; i < nrOfClassifiableObjects && ( !time_awareness || scheduler.allows( FrameScheduler::CLASSIFICATION, pEstimatedClassificationTime+time_overhead ) ); i++ )
     {
-		double time_1 = SceneHandler::msTime();
+		double time_1 = FrameScheduler::now();
 		Ptr<SceneObject> objForClassification = getObjForClassification();
 		
 		if( objForClassification == NULL ) break;
+		Tracer::Span objectSpan( pScene->tracer(), "classify object", "id", objForClassification->id() );
 
 		RectangleRegion roi = objForClassification->lastROI();
 		
@@ -2071,7 +2245,7 @@ void ObjectHandler::updateClassifications( Mat _image )
 		{
 			if( !pObjectTypesInScene[classId] ){ continue;} // then the user set a command that this type does not occur in the picture
 
-			double classLikelihood = (*SceneObject::classifierList)[classId]( containingImg, roi, descriptors, objForClassification->id(), classId );
+			double classLikelihood = (*SceneObject::classifierList)[classId]( containingImg, roi, descriptors, objForClassification->id(), classId, this );
 
 			if( classLikelihood>=0 ) objForClassification->addNewLikelihood( classId, classLikelihood ); // add new likelihood for class to object
         }
@@ -2082,8 +2256,8 @@ void ObjectHandler::updateClassifications( Mat _image )
 		if( objReincarnation!=objForClassification ) objForClassification.addref(); // necessary because apparently the copy constructer of the pointer object doesn't increment the reference count - which means it is deleted twice if this isn't added
 		
 		pCategorized.push_front( objReincarnation );
-		timeLeft = pScene->timeLeft()-time_overhead; 
-        pEstimatedClassificationTime = SceneHandler::msTime()-time_1;
+        pEstimatedClassificationTime = FrameScheduler::now()-time_1;
+		scheduler.reportCost( FrameScheduler::CLASSIFICATION, pEstimatedClassificationTime );
 
 	}
 
@@ -2280,19 +2454,38 @@ void ObjectHandler::calcLocalMaxima( Mat& _inputImage, Mat& _pointSet, unsigned
 
 bool ObjectHandler::closeToWindowBorder( Point _point )
 {
-	Mat exampleWindow = pVideo->grey();
-	if( exampleWindow.empty() ) return false;
+	if( pImageWidth==0 || pImageHeight==0 ) return false;
 
 	int lowerXBorder = window_border_range;
-	int upperXBorder = exampleWindow.cols-window_border_range;
+	int upperXBorder = pImageWidth-window_border_range;
 	int lowerYBorder = window_border_range;
-	int upperYBorder = exampleWindow.rows-window_border_range;
+	int upperYBorder = pImageHeight-window_border_range;
 
 	return (_point.x<lowerXBorder) || (_point.x>upperXBorder) || (_point.y<lowerYBorder) || (_point.y>upperYBorder);
 }
 
+void ObjectHandler::objectRegions( vector<Frame::ObjectRegion>& _regions )
+{
+	_regions.clear();
+	for( int set=0; set<2; set++ )
+	{
+		list<Ptr<SceneObject> >& objects = ( set==0 )? pCategorized : pUncategorized;
+		for( list<Ptr<SceneObject> >::iterator it = objects.begin(); it!=objects.end(); it++ )
+		{
+			vector<Point> vertices;
+			(*it)->lastROI().points( vertices );
+
+			Frame::ObjectRegion region;
+			region.id = (*it)->id();
+			region.area = boundingRect( Mat(vertices) );
+			_regions.push_back( region );
+		}
+	}
+}
+
+
 // note: if there is a problem with the drawing, check if simplification of the boolean calculation x=p()||y leads to non-call of p() if y is true...
-void ObjectHandler::draw( Mat& _image )
+void ObjectHandler::draw( Mat& _image, FrameOverlay* _overlay )
 {
 	bool keepDrawing = true;
 	unsigned int drawLevel = 0;
@@ -2310,13 +2503,13 @@ void ObjectHandler::draw( Mat& _image )
 
         for( list<Ptr<SceneObject> >::iterator it = pCategorized.begin(); it!=pCategorized.end(); it++ )
 		{
-			if( path_length == -2 && drawLevel == 0 ) keepDrawing = !(*it)->drawLayer( *pPathMat, drawLevel, (*it)->color() ) || keepDrawing;
-			else keepDrawing = !(*it)->drawLayer( _image, drawLevel, (*it)->color() ) || keepDrawing;
+			if( path_length == -2 && drawLevel == 0 ) keepDrawing = !(*it)->drawLayer( *pPathMat, drawLevel, (*it)->color(), _overlay ) || keepDrawing;
+			else keepDrawing = !(*it)->drawLayer( _image, drawLevel, (*it)->color(), _overlay ) || keepDrawing;
 		}
         for( list<Ptr<SceneObject> >::iterator it = pUncategorized.begin(); it!=pUncategorized.end(); it++ )
 		{
-			if( path_length == -2 && drawLevel == 0 ) keepDrawing = !(*it)->drawLayer( *pPathMat, drawLevel, (*it)->color() ) || keepDrawing;
-			else keepDrawing = !(*it)->drawLayer( _image, drawLevel, (*it)->color() ) || keepDrawing;
+			if( path_length == -2 && drawLevel == 0 ) keepDrawing = !(*it)->drawLayer( *pPathMat, drawLevel, (*it)->color(), _overlay ) || keepDrawing;
+			else keepDrawing = !(*it)->drawLayer( _image, drawLevel, (*it)->color(), _overlay ) || keepDrawing;
 		}
 		// write central path image into output image
 		if( path_length == -2 && drawLevel == 0 ) _image -= *pPathMat;
@@ -2425,8 +2618,11 @@ void ObjectHandler::setupOptions()
 	time_overhead = (*Options::General)["classification"]["time_overhead"].as<double>();
 	create_threshold_detection_image = (*Options::General)["display"]["objects"]["create_threshold_detection_image"].as<bool>();
 	draw_predicted_regions = (*Options::General)["display"]["objects"]["draw_predicted_regions"].as<bool>();
+	pyramid_levels = (*Options::General)["object_detection"]["pyramid_levels"].as<unsigned int>();
+	pyramid_region_growth = (*Options::General)["object_detection"]["pyramid_region_growth"].as<double>();
+	missing_search_pyramid_level = (*Options::General)["object_detection"]["missing_search_pyramid_level"].as<unsigned int>();
 
-	
+	SceneObject::setupOptions(); // not loaded per object: objects are created by the tracking threads of all streams concurrently
 	return;
 }
 
@@ -2456,6 +2652,9 @@ bool ObjectHandler::time_awareness;
 double ObjectHandler::time_overhead;
 bool ObjectHandler::create_threshold_detection_image;
 bool ObjectHandler::draw_predicted_regions;
+unsigned int ObjectHandler::pyramid_levels;
+double ObjectHandler::pyramid_region_growth;
+unsigned int ObjectHandler::missing_search_pyramid_level;
 
 double ObjectHandler::two_pi=2*acos(-1.0);
 double ObjectHandler::pi=acos(-1.0);
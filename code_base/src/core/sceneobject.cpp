@@ -25,8 +25,7 @@
 SceneObject::SceneObject( ObjectHandler* _environmentControl ):pType(-2),pTimeSincePredictionReset(-2)
 {
 	pEnvironmentControl = _environmentControl;
-	pObjectId=objectCount++;
-	setupOptions();
+	pObjectId = ( _environmentControl!=NULL )? _environmentControl->stream().nextObjectId() : objectCount++;
 	pPathMat = NULL;
 	pFramesSinceLastFade = 0;
 	
@@ -72,8 +71,6 @@ SceneObject::SceneObject( Ptr<SceneObject> _toCopy )
 		pVelEMA_S_old[1] = _toCopy->pVelEMA_S_old[1];
 		pVelEMA_S_old[2] = _toCopy->pVelEMA_S_old[2];
 	}
-
-	setupOptions();
 }
 
 
@@ -93,6 +90,11 @@ unsigned int SceneObject::id()
 	return pObjectId;
 }
 
+ObjectHandler* SceneObject::environment()
+{
+	return pEnvironmentControl;
+}
+
 
 void SceneObject::classProperties( string& _className, Scalar& _classColor )
 {
@@ -972,17 +974,17 @@ void SceneObject::draw( Mat& _img, Scalar _color )
 
 
 
-bool SceneObject::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color )
+bool SceneObject::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color, FrameOverlay* _overlay )
 {
 	switch( _layerLevel ){
 		case 0:
-			drawPath( _img,_color );
+			drawPath( _img, _color, _overlay );
 			return false;
 		case 1:
-			drawDirection( _img,Scalar(38,38,255) );
+			drawDirection( _img, Scalar(38,38,255), _overlay );
 			return false;
 		case 2:
-			drawName( _img );
+			drawName( _img, _overlay );
 			return true;
 		default:
 			return true;
@@ -991,7 +993,7 @@ bool SceneObject::drawLayer( Mat& _img, unsigned int _layerLevel, Scalar _color
 
 
 
-void SceneObject::drawPath( Mat& _img, Scalar _color )
+void SceneObject::drawPath( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	if( pHistory.size()<2 ) return;
 
@@ -1003,7 +1005,9 @@ void SceneObject::drawPath( Mat& _img, Scalar _color )
 	if( ObjectHandler::path_length == -2 ) // the passed image is the central path image, draw last made step on it
 	{
 		unsigned int lastElementId = pHistory.size();
-		line( _img, Point( pHistory[lastElementId-2]->x, pHistory[lastElementId-2]->y ), Point( pHistory[lastElementId-1]->x, pHistory[lastElementId-1]->y ), Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		Point start( pHistory[lastElementId-2]->x, pHistory[lastElementId-2]->y ), end( pHistory[lastElementId-1]->x, pHistory[lastElementId-1]->y );
+		line( _img, start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		if( _overlay!=NULL ) _overlay->pathStep( start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ) );
 		return;
 	}
 	else if( ObjectHandler::path_length == -1 ) // draw last made step into the object's own path image
@@ -1016,8 +1020,10 @@ void SceneObject::drawPath( Mat& _img, Scalar _color )
 		}
 
 		unsigned int lastElementId = pHistory.size();
+		Point start( pHistory[lastElementId-2]->x, pHistory[lastElementId-2]->y ), end( pHistory[lastElementId-1]->x, pHistory[lastElementId-1]->y );
 	
-		line( *pPathMat, Point( pHistory[lastElementId-2]->x, pHistory[lastElementId-2]->y ), Point( pHistory[lastElementId-1]->x, pHistory[lastElementId-1]->y ), Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		line( *pPathMat, start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ), 1 );
+		if( _overlay!=NULL ) _overlay->pathStep( start, end, Scalar( 255-_color[0],255-_color[1],255-_color[2] ) );
 
 		_img -= *pPathMat;
 		return;
@@ -1025,40 +1031,17 @@ void SceneObject::drawPath( Mat& _img, Scalar _color )
 	else if( ObjectHandler::path_length == 0 || ObjectHandler::path_length == 1 || ObjectHandler::path_length < -2 ) return;
 
 	// a number of steps that are to be drawn is defined
-	
-	unsigned int pathStep = path_step_length;
-	if( pathStep<1 ) pathStep=1;
-
-	int nrOfSteps = ObjectHandler::path_length/pathStep;
-	int lastStepOvershoot = pHistory.size() % pathStep;
-	
-	
 	vector<Point> path;
-
-	// startpoint on pathStep scale
-	int startPoint = pHistory.size()-nrOfSteps*pathStep; // nrOfSteps*pathStep is not equal the path_length as nrOfSteps as an integer is rounded downwards
-	
-	if( startPoint<0 ) startPoint = 0;
-	else
-	{
-		path.push_back( Point(pHistory[startPoint]->x,pHistory[startPoint]->y) );
-		startPoint += pathStep-lastStepOvershoot;
-	}
-
-
-    for( size_t i=startPoint; i<pHistory.size(); i+=pathStep )
-	{
-		path.push_back( Point(pHistory[i]->x,pHistory[i]->y) );
-		if( i+pathStep >= pHistory.size() ) path.push_back( Point(pHistory[pHistory.size()-1]->x,pHistory[pHistory.size()-1]->y) );
-	}
+	pathPoints( pHistory, ObjectHandler::path_length, path );
 	int size = path.size();
 	const cv::Point *pts = (const cv::Point*) Mat(path).data;
 	polylines(_img,&pts,&size,1,false,_color,1);
+	if( _overlay!=NULL ) _overlay->polyline( 0, path, _color, 1 );
 	return;
 }
 
 
-void SceneObject::drawDirection( Mat& _img, Scalar _color )
+void SceneObject::drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	if( pHistory.size()==0 ) return;
 
@@ -1072,46 +1055,59 @@ void SceneObject::drawDirection( Mat& _img, Scalar _color )
 	Point zwei( current->x+10*myDirection[0], current->y+10*myDirection[1] );
 
 	line( _img, eins, zwei, _color, 2, 8 );
+	if( _overlay!=NULL ) _overlay->line( 1, eins, zwei, _color, 2 );
+}
+
+
+void SceneObject::drawName( Mat& _img, FrameOverlay* _overlay )
+{
+	string name;
+	Scalar color;
+	label( name, color );
+
+	FrameOverlay::drawLabel( _img, pos(), name, color );
+	if( _overlay!=NULL ) _overlay->label( 2, pos(), name, color );
+	return;
 }
 
 
-void SceneObject::drawName( Mat& _img )
+void SceneObject::label( string& _text, Scalar& _color )
 {
 	stringstream nameBuilder;
 
 	string className;
-	Scalar color;
-	
-	classProperties( className, color );
+	classProperties( className, _color );
 
 	nameBuilder<<"id#"<<pObjectId<<":"<<className;
-	string name;
-	nameBuilder>>name;
-
-
-	Point actualPosition=pos();
-	Point textPosition = actualPosition;
-	Point offset(10,15);
-	int fontFace =  FONT_HERSHEY_PLAIN;
-	double fontScale = 0.7;
-	int thickness = 1;
-	int baseline;
-	double rightBorderDistance = 5; // [px]
-	double bottomBorderDistance = 5; // [px]
-	int rectDistX = 2; // [px] backing rectangle: additional width left and right
-	int rectDistY = 3; // [px] backing rectangle: additional height top and bottom
-	Size textSize = getTextSize( name, fontFace, fontScale, thickness, &baseline );
-	if( textPosition.x+offset.x+textSize.width+rightBorderDistance+rectDistX > _img.cols ) textPosition.x = _img.cols-textSize.width-rightBorderDistance-offset.x-rectDistX;
-	if( textPosition.y+offset.y+textSize.height+bottomBorderDistance+rectDistY > _img.rows ) textPosition.y = _img.rows-textSize.height-bottomBorderDistance-offset.y-rectDistY;
-	
-	Point rectPos( textPosition.x+offset.x-rectDistX, textPosition.y+offset.y-textSize.height-rectDistY );
-	Mat opaque( textSize.height+2*rectDistY, textSize.width+2*rectDistX, CV_8UC3, CV_RGB(190,190,190) );
-	Mat toOverlay = _img( Range( rectPos.y, rectPos.y+opaque.rows ),Range( rectPos.x, rectPos.x+opaque.cols ) );
+	nameBuilder>>_text;
+}
+
+
+void SceneObject::pathPoints( const deque< Ptr<State> >& _history, int _pathLength, vector<Point>& _path )
+{
+	_path.clear();
+	unsigned int pathStep = path_step_length;
+	if( pathStep<1 ) pathStep=1;
+
+	int nrOfSteps = _pathLength/pathStep;
+	int lastStepOvershoot = _history.size() % pathStep;
+
+	// startpoint on pathStep scale
+	int startPoint = _history.size()-nrOfSteps*pathStep; // nrOfSteps*pathStep is not equal the path_length as nrOfSteps as an integer is rounded downwards
 	
-	toOverlay = toOverlay+opaque;
-	putText( _img, name, textPosition+offset,  fontFace, fontScale, color, thickness, 8, false );
-	circle( _img, actualPosition, 3, color, 2 );
-	return;
+	if( startPoint<0 ) startPoint = 0;
+	else
+	{
+		_path.push_back( Point(_history[startPoint]->x,_history[startPoint]->y) );
+		startPoint += pathStep-lastStepOvershoot;
+	}
+
+
+    for( size_t i=startPoint; i<_history.size(); i+=pathStep )
+	{
+		_path.push_back( Point(_history[i]->x,_history[i]->y) );
+		if( i+pathStep >= _history.size() ) _path.push_back( Point(_history[_history.size()-1]->x,_history[_history.size()-1]->y) );
+	}
 }
 
 
@@ -1231,7 +1227,7 @@ void SceneObject::setupObjectList()
     if( objectList==NULL )
     {
         objectList = new vector< std::string >;
-        classifierList = new vector< double (*)( Mat&, RectangleRegion&, Mat&, int, int ) >;
+        classifierList = new vector< double (*)( Mat&, RectangleRegion&, Mat&, int, int, ObjectHandler* ) >;
         factoryList = new vector< Ptr<SceneObject> (*)( SceneObject* ) >;
         initializerList = new vector< bool (*)(int, ObjectHandler* )>();
         setOptionsFunctionList = new vector< void (*)( GenericMultiLevelMap<string>& _options, int _classId )>();
@@ -1241,7 +1237,7 @@ void SceneObject::setupObjectList()
 }
 
 
-int SceneObject::registerObject( std::string _name, Ptr<SceneObject> (* _factoryFunction)( SceneObject* _proto ), double (*_classTest)( Mat& _img, RectangleRegion& _boundingRect, Mat&, int _id, int _classId ), bool (*_initializerFunction)( int _classId, ObjectHandler* _environment ), void (*_setOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ), void (*_getOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId )  )
+int SceneObject::registerObject( std::string _name, Ptr<SceneObject> (* _factoryFunction)( SceneObject* _proto ), double (*_classTest)( Mat& _img, RectangleRegion& _boundingRect, Mat&, int _id, int _classId, ObjectHandler* _environment ), bool (*_initializerFunction)( int _classId, ObjectHandler* _environment ), void (*_setOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId ), void (*_getOptionsFunction)( GenericMultiLevelMap<string>& _options, int _classId )  )
 {
     setupObjectList();
 
@@ -1261,7 +1257,7 @@ bool SceneObject::createClassVectors()
 	if( objectList==NULL )
 	{
 		objectList = new vector< std::string >();
-		classifierList = new vector< double (*)( Mat&, RectangleRegion&, Mat&, int, int ) >();
+		classifierList = new vector< double (*)( Mat&, RectangleRegion&, Mat&, int, int, ObjectHandler* ) >();
 		factoryList = new vector< Ptr<SceneObject> (*)( SceneObject* ) >();
 		initializerList = new vector< bool (*)(int _classId, ObjectHandler* _environment)>();
 		setOptionsFunctionList = new vector< void (*)( GenericMultiLevelMap<string>& _options, int _classId )>();
@@ -1292,9 +1288,20 @@ vector<double> SceneObject::direction( double _angle )
 }
 
 
-void SceneObject::resetObjectCount()
+size_t SceneObject::historyMemUsage() const
 {
-	objectCount = 0;
+	size_t usage = pHistory.size()*( sizeof( Ptr<State> )+sizeof(int) ); // pointer and reference counter
+	for( deque< Ptr<State> >::const_iterator it=pHistory.begin(); it!=pHistory.end(); it++ )
+	{
+		if( !it->empty() ) usage += (*it)->memUsage();
+	}
+	return usage;
+}
+
+
+Ptr<Mat> SceneObject::pathImage() const
+{
+	return pPathMat;
 }
 
 
@@ -1314,7 +1321,7 @@ double SceneObject::pVelEMA_alpha = 0.08; // most successful: around 0.08
 
 
 vector< std::string >* SceneObject::objectList;
-vector< double (*)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId ) >* SceneObject::classifierList;
+vector< double (*)( Mat& _img, RectangleRegion& _boundingRect, Mat& _descriptors, int _id, int _classId, ObjectHandler* _environment ) >* SceneObject::classifierList;
 vector< Ptr<SceneObject> (*)(SceneObject* _proto) >* SceneObject::factoryList;
 vector< bool (*)(int _classId, ObjectHandler* _environment)>* SceneObject::initializerList;
 vector< void (*)( GenericMultiLevelMap<string>& _options, int _classId )>* SceneObject::setOptionsFunctionList; // list with functions to set class properties
@@ -1337,3 +1344,9 @@ Point2f SceneObject::State::pos()
 {
 	return Point2f( x,y );
 }
+
+
+size_t SceneObject::State::memUsage() const
+{
+	return sizeof(SceneObject::State);
+}
@@ -500,7 +500,7 @@ double DirectedRodEMA::predictHalfLengthOffset() // since halfLengthOffset is a
 }
 
 
-void DirectedRodEMA::drawDirection( Mat& _img, Scalar _color )
+void DirectedRodEMA::drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	Ptr<SceneObject::State> current = pHistory().back();
 	vector<double> myDirection = direction( current->angle );
@@ -517,6 +517,13 @@ void DirectedRodEMA::drawDirection( Mat& _img, Scalar _color )
 	line( _img, zwei, drei, _color, 2, 8 );
 	line( _img, zwei, vier, _color, 2, 8 );
 
+	if( _overlay!=NULL )
+	{
+		_overlay->line( 1, eins, zwei, _color, 2 );
+		_overlay->line( 1, zwei, drei, _color, 2 );
+		_overlay->line( 1, zwei, vier, _color, 2 );
+	}
+
 	return;
 }
 
@@ -541,3 +548,4 @@ DirectedRodEMA::State::State(){}
 DirectedRodEMA::State::~State(){}
 DirectedRodEMA::State::State( double _x, double _y, double time, double _angle, double _area, int _type ):FreeMovingAverage::State( _x, _y, time, _angle, _area, _type ){}
 DirectedRodEMA::State::State( Point _pos, double time, double _angle, double _area, int _type ):FreeMovingAverage::State( _pos, time, _angle, _area, _type ){}
+size_t DirectedRodEMA::State::memUsage() const{ return sizeof(DirectedRodEMA::State); }
@@ -732,3 +732,4 @@ FreeMovingAverage::State::State(){}
 FreeMovingAverage::State::~State(){}
 FreeMovingAverage::State::State( double _x, double _y, double time, double _angle, double _area, int _type ):SceneObject::State( _x, _y, time, _angle, _area, _type ){}
 FreeMovingAverage::State::State( Point _pos, double time, double _angle, double _area, int _type ):SceneObject::State( _pos, time, _angle, _area, _type ){}
+size_t FreeMovingAverage::State::memUsage() const{ return sizeof(FreeMovingAverage::State); }
@@ -356,3 +356,9 @@ NonHoloEMA3d::State::State( Point _pos, double time, double _angle, double _area
 	type=classId;
 	thetaEstimated = 0;
 }
+
+
+size_t NonHoloEMA3d::State::memUsage() const
+{
+	return sizeof(NonHoloEMA3d::State);
+}
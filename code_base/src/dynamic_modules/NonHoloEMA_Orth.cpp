@@ -272,7 +272,7 @@ double NonHoloEMA_Orth::predictArea()
 }
 
 
-void NonHoloEMA_Orth::drawDirection( Mat& _img, Scalar _color )
+void NonHoloEMA_Orth::drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 	Ptr<SceneObject::State> current = pHistory().back();
 	vector<double> myDirection = direction( current->angle );
@@ -289,6 +289,13 @@ void NonHoloEMA_Orth::drawDirection( Mat& _img, Scalar _color )
 	line( _img, zwei, drei, _color, 2, 8 );
 	line( _img, zwei, vier, _color, 2, 8 );
 
+	if( _overlay!=NULL )
+	{
+		_overlay->line( 1, eins, zwei, _color, 2 );
+		_overlay->line( 1, zwei, drei, _color, 2 );
+		_overlay->line( 1, zwei, vier, _color, 2 );
+	}
+
 	return;
 }
 
@@ -276,7 +276,7 @@ double NonHoloKalman2D::predictArea()
 }
 
 
-void NonHoloKalman2D::drawDirection( Mat& _img, Scalar _color )
+void NonHoloKalman2D::drawDirection( Mat& _img, Scalar _color, FrameOverlay* _overlay )
 {
 
 	Ptr<SceneObject::State> current = pHistory().back();
@@ -294,6 +294,13 @@ void NonHoloKalman2D::drawDirection( Mat& _img, Scalar _color )
 	line( _img, zwei, drei, _color, 2, 8 );
 	line( _img, zwei, vier, _color, 2, 8 );
 
+	if( _overlay!=NULL )
+	{
+		_overlay->line( 1, eins, zwei, _color, 2 );
+		_overlay->line( 1, zwei, drei, _color, 2 );
+		_overlay->line( 1, zwei, vier, _color, 2 );
+	}
+
 	return;
 }
 
@@ -489,3 +489,9 @@ NonHoloKalman3D::State::State( Point _pos, double time, double _angle, double _a
 	type=classId;
 	length = 0;
 }
+
+
+size_t NonHoloKalman3D::State::memUsage() const
+{
+	return sizeof(NonHoloKalman3D::State);
+}
@@ -26,7 +26,7 @@
 bool ColorRangeExpansion::isRegistered = IPAlgorithm::registerAlgorithm ( COLORRANGEEXPANSION_ALGORITHM_NAME, &ColorRangeExpansion::createInstance );
 
 
-ColorRangeExpansion::ColorRangeExpansion(void)
+ColorRangeExpansion::ColorRangeExpansion(void):pHistogramsCalculated(false),pAnalysisRunning(false)
 {
 	resetSetting();
 }
@@ -34,6 +34,7 @@ ColorRangeExpansion::ColorRangeExpansion(void)
 
 ColorRangeExpansion::~ColorRangeExpansion(void)
 {
+	stopAnalysis();
 }
 
 
@@ -46,6 +47,9 @@ Ptr<IPAlgorithm> ColorRangeExpansion::createInstance()
 
 void ColorRangeExpansion::resetSetting()
 {
+	stopAnalysis();
+
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	pSmallPeakNeglectionBandwidth = -1;
 	pPeakExclusivenessWidth = 40;
 	pRecalculationInterval = 0;
@@ -53,6 +57,8 @@ void ColorRangeExpansion::resetSetting()
 	pBrightestOccuringColor = 255;
 	pDarkestOccuringColor = 0;
 	pDarkPeakRelevanceThreshold = 0;
+	pHistogramSamplingStep = 1;
+	pAsynchronousAnalysis = false;
 	return;
 }
 
@@ -74,17 +80,12 @@ bool ColorRangeExpansion::process( Mat& _image )
 	file.open("colorrangetime.txt",std::ios_base::app);
     double time = 1000*((double)clock())/CLOCKS_PER_SEC;*/
 	// update histograms and brightest peaks if necessary
-	if( recalculateSettings() )
-	{
-		calculateHistograms( _image );
-		calculateBrightestPeak( pPeakExclusivenessWidth, pSmallPeakNeglectionBandwidth );
-		calculateBrightestOccuringColor();
-		calculateDarkestOccuringColor();
-	}
+	updateLookUpTable( _image );
 
 	//_image=(_image-pDarkestOccuringColor)*tExpansionFactor; //-> simple version: about two times slower than using look up table
 	//convertScaleAbs(_image,_image,tExpansionFactor,-pDarkestOccuringColor*tExpansionFactor); -> about 5 ms slower than simple version
-	LUT(_image ,pLookUpTable ,_image);
+	Mat lookUpTable = this->lookUpTable(); // taken once: may be replaced by the analysis thread meanwhile
+	if( !lookUpTable.empty() ) LUT(_image ,lookUpTable ,_image);
 	
     /*file<<(1000*((double)clock())/CLOCKS_PER_SEC)-time<<endl;
     file.close();*/
@@ -92,8 +93,117 @@ bool ColorRangeExpansion::process( Mat& _image )
 }
 
 
+bool ColorRangeExpansion::pointWise() const
+{
+	return true;
+}
+
+
+bool ColorRangeExpansion::needsImage() const
+{
+	// same condition as recalculateSettings(), without counting down
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
+	if( pRecalculationInterval<0 || (pRecalculationInterval==0 && pHistogramsCalculated) ) return false;
+	return pStepsToRecalculation==1;
+}
+
+
+void ColorRangeExpansion::updateLookUpTable( const Mat& _image )
+{
+	AnalysisParameters parameters;
+	int samplingStep;
+	bool asynchronous;
+	{
+		boost::mutex::scoped_lock lock( pAnalysisMutex );
+		if( !recalculateSettings() ) return;
+		pHistogramsCalculated = true;
+		parameters.peakExclusivenessWidth = pPeakExclusivenessWidth;
+		parameters.smallPeakNeglectionBandwidth = pSmallPeakNeglectionBandwidth;
+		parameters.darkPeakRelevanceThreshold = pDarkPeakRelevanceThreshold;
+		samplingStep = pHistogramSamplingStep;
+		asynchronous = pAsynchronousAnalysis;
+	}
+
+	vector<Mat> histograms;
+	calculateHistograms( _image, histograms, samplingStep );
+
+	if( asynchronous ) startAnalysis( histograms, parameters );
+	else analyseHistograms( histograms, parameters );
+	return;
+}
+
+
+void ColorRangeExpansion::analyseHistograms( const vector<Mat>& _histograms, const AnalysisParameters& _parameters )
+{
+	if( _histograms.empty() ) return;
+
+	Mat histogram = _histograms[0].clone();
+    for( size_t i=1 ; i<_histograms.size(); i++ ) histogram+=_histograms[i];
+
+	Vector<unsigned int> brightestPeak;
+	bool peakFound = calculateBrightestPeak( _histograms, _parameters.peakExclusivenessWidth, _parameters.smallPeakNeglectionBandwidth, brightestPeak );
+	unsigned int brightestColor = ( peakFound )? calculateBrightestOccuringColor( histogram, brightestPeak ) : 0;
+	unsigned int darkestColor = calculateDarkestOccuringColor( histogram, _parameters.darkPeakRelevanceThreshold );
+
+	// both ends of the range and the table are published at once
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
+	if( peakFound ) pBrightestOccuringColor = brightestColor;
+	pDarkestOccuringColor = darkestColor;
+	calculateExpansionFactor();
+	return;
+}
+
+
+void ColorRangeExpansion::startAnalysis( vector<Mat>& _histograms, const AnalysisParameters& _parameters )
+{
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
+	pPendingHistograms.swap( _histograms );
+	pPendingParameters = _parameters;
+	if( !pAnalysisRunning )
+	{
+		pAnalysisRunning = true;
+		pAnalysisWorker = boost::thread( &ColorRangeExpansion::analysisThread, this );
+	}
+	pHistogramsAvailable.notify_one();
+}
+
+
+void ColorRangeExpansion::stopAnalysis()
+{
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
+	pAnalysisRunning = false;
+	pPendingHistograms.clear();
+	pHistogramsAvailable.notify_all();
+	lock.unlock();
+
+	if( pAnalysisWorker.joinable() ) pAnalysisWorker.join();
+}
+
+
+void ColorRangeExpansion::analysisThread()
+{
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
+	while( true )
+	{
+		while( pAnalysisRunning && pPendingHistograms.empty() ) pHistogramsAvailable.wait( lock );
+		if( !pAnalysisRunning ) break;
+
+		// histograms that arrive meanwhile replace each other, only the newest ones are analysed next
+		vector<Mat> histograms;
+		histograms.swap( pPendingHistograms );
+		AnalysisParameters parameters = pPendingParameters;
+		lock.unlock();
+
+		analyseHistograms( histograms, parameters );
+
+		lock.lock();
+	}
+}
+
+
 string ColorRangeExpansion::options() const
 {
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	stringstream converter;
 	converter << pRecalculationInterval;
 
@@ -108,6 +218,7 @@ bool ColorRangeExpansion::setup( string _setting )
 	stringstream converter;
 
 	converter << _setting;
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	converter >> pRecalculationInterval;
 
 	return true;
@@ -116,6 +227,7 @@ bool ColorRangeExpansion::setup( string _setting )
 
 void ColorRangeExpansion::getOptions( GenericMultiLevelMap<string>& _options ) const
 {
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	_options["recalculation_interval"].as<int>()=pRecalculationInterval;
 	_options["recalculation_interval"]["info"].as<string>()="indicates how often the histogram is being recalculated:  0 = only the first time, negative = never (using default values for brightest and darkest color), 1 = each time, 2 = every second time, 3 = every third, etc";
 	_options["brightest_occuring_color"].as<unsigned int>()=pBrightestOccuringColor;
@@ -128,6 +240,10 @@ void ColorRangeExpansion::getOptions( GenericMultiLevelMap<string>& _options ) c
 	_options["peak_exclusiveness_width"]["info"].as<string>()="specifies the color range over which the calculated peaks need to be a local maxima. default is 20";
 	_options["dark_peak_relevance_threshold"].as<float>()=pDarkPeakRelevanceThreshold;
 	_options["dark_peak_relevance_threshold"]["info"].as<string>()="defines how often a dark color must occur in order not to be neglected when calculating the darkest occuring color";
+	_options["histogram_sampling_step"].as<int>()=pHistogramSamplingStep;
+	_options["histogram_sampling_step"]["info"].as<string>()="the histograms only count every i-th pixel of every i-th row (for 8 bit images), which makes their calculation about i*i times faster. The counts are scaled to the whole image. 1: all pixels are counted";
+	_options["asynchronous_analysis"].as<bool>()=pAsynchronousAnalysis;
+	_options["asynchronous_analysis"]["info"].as<string>()="if true then the histograms are analysed on a thread of their own: the frames only pay for the histogram calculation and apply the latest look up table until the analysis has published a new one";
 		
 	return;
 }
@@ -135,20 +251,27 @@ void ColorRangeExpansion::getOptions( GenericMultiLevelMap<string>& _options ) c
 
 bool ColorRangeExpansion::setOptions( GenericMultiLevelMap<string>& _options )
 {
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	if( _options.hasKey("recalculation_interval") ) pRecalculationInterval = _options["recalculation_interval"].as<int>();
 	if( _options.hasKey("brightest_occuring_color") ) pBrightestOccuringColor = _options["brightest_occuring_color"].as<unsigned int>();
 	if( _options.hasKey("darkest_occuring_color") ) pDarkestOccuringColor = _options["darkest_occuring_color"].as<unsigned int>();
 	if( _options.hasKey("small_peak_neglection_bandwidth") ) pSmallPeakNeglectionBandwidth = _options["small_peak_neglection_bandwidth"].as<int>();
 	if( _options.hasKey("peak_exclusiveness_width") ) pPeakExclusivenessWidth = _options["peak_exclusiveness_width"].as<int>();
 	if( _options.hasKey("dark_peak_relevance_threshold") ) pDarkPeakRelevanceThreshold = _options["dark_peak_relevance_threshold"].as<float>();
-	
+	if( _options.hasKey("histogram_sampling_step") ) pHistogramSamplingStep = max( _options["histogram_sampling_step"].as<int>(), 1 );
+	if( _options.hasKey("asynchronous_analysis") ) pAsynchronousAnalysis = _options["asynchronous_analysis"].as<bool>();
 	calculateExpansionFactor();
+
+	bool asynchronous = pAsynchronousAnalysis;
+	lock.unlock();
+	if( !asynchronous ) stopAnalysis(); // joins the worker, which needs the lock to publish
 	return true;
 }
 
 
 void ColorRangeExpansion::setBrightestColor( unsigned int _color)
 {
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	pBrightestOccuringColor = _color;
 	calculateExpansionFactor();
 	return;
@@ -157,6 +280,7 @@ void ColorRangeExpansion::setBrightestColor( unsigned int _color)
 
 void ColorRangeExpansion::setDarkestColor( unsigned int _color)
 {
+	boost::mutex::scoped_lock lock( pAnalysisMutex );
 	pDarkestOccuringColor = _color;
 	calculateExpansionFactor();
 	return;
@@ -164,7 +288,7 @@ void ColorRangeExpansion::setDarkestColor( unsigned int _color)
 
 void ColorRangeExpansion::calculateExpansionFactor()
 {
-	tExpansionFactor = 255.0/(pBrightestOccuringColor-pDarkestOccuringColor);
+	double expansionFactor = 255.0/(pBrightestOccuringColor-pDarkestOccuringColor);
 
 	Mat lookUpTable(1,256,CV_8U);
 	uchar* element = lookUpTable.data;
@@ -172,28 +296,25 @@ void ColorRangeExpansion::calculateExpansionFactor()
 	{
 		int pixel = i-pDarkestOccuringColor;
 		pixel = (pixel<0)?0:pixel;
-		pixel*=tExpansionFactor;
+		pixel*=expansionFactor;
 		pixel = (pixel>255)?255:pixel;
 		element[i]=pixel;
 	}
-	pLookUpTable=lookUpTable;
+	setLookUpTable( lookUpTable );
 	
 	return;
 }
 
 
-bool ColorRangeExpansion::calculateBrightestOccuringColor()
+unsigned int ColorRangeExpansion::calculateBrightestOccuringColor( const Mat& _histogram, const Vector<unsigned int>& _brightestPeak )
 {
 	//calculate upper end of image color range, starting at brightest peak
-	int brightPeakEnd = pHistograms[0].total();
+	int brightPeakEnd = _histogram.total();
 	int countLowLevelColors=0;
 
-	Mat Histogram = pHistograms[0];
-    for( size_t i=1 ; i<pHistograms.size(); i++ ) Histogram+=pHistograms[i];
-	
-    for( size_t colorId = pBrightestPeak[0]+1; colorId<Histogram.total(); colorId++ )
+    for( size_t colorId = _brightestPeak[0]+1; colorId<_histogram.total(); colorId++ )
 	{
-		if( Histogram.at<float>(colorId) < 0.01*pBrightestPeak[1] )
+		if( _histogram.at<float>(colorId) < 0.01*_brightestPeak[1] )
 		{
 			countLowLevelColors++;
 			if( countLowLevelColors>=3 )
@@ -205,37 +326,29 @@ bool ColorRangeExpansion::calculateBrightestOccuringColor()
 		else countLowLevelColors=0;
 	}
 
-	if( !pBrightestPeak.empty() ) setBrightestColor(brightPeakEnd);
-	else return false;
-
-	return true;
+	return brightPeakEnd;
 }
 
 
-bool ColorRangeExpansion::calculateDarkestOccuringColor()
+unsigned int ColorRangeExpansion::calculateDarkestOccuringColor( const Mat& _histogram, float _relevanceThreshold )
 {
 	//find lower end of image color range
 	int darkestOccuringColor = 0;
 
-	Mat Histogram = pHistograms[0];
-    for( size_t i=1 ; i<pHistograms.size(); i++ ) Histogram+=pHistograms[i];
-
-    for( size_t colorId = 1; colorId < Histogram.total(); colorId++ )
+    for( size_t colorId = 1; colorId < _histogram.total(); colorId++ )
 	{
-		if( Histogram.at<float>(colorId)>pDarkPeakRelevanceThreshold )
+		if( _histogram.at<float>(colorId)>_relevanceThreshold )
 		{
 			darkestOccuringColor = colorId-1;
 			break;
 		}
 	}
 
-	setDarkestColor(darkestOccuringColor);
-	
-	return true;
+	return darkestOccuringColor;
 }
 
 
-bool ColorRangeExpansion::calculateBrightestPeak( unsigned int peakExclusivenessWidth, double bottomSizePercentage )
+bool ColorRangeExpansion::calculateBrightestPeak( const vector<Mat>& _histograms, unsigned int peakExclusivenessWidth, double bottomSizePercentage, Vector<unsigned int>& _brightestPeak )
 {
 	int peakCandidate;
 	double peakValue;
@@ -245,28 +358,28 @@ bool ColorRangeExpansion::calculateBrightestPeak( unsigned int peakExclusiveness
 	int lastSameHeightPeak;
 
     Vector< deque< Vector<unsigned int> > > peakLists;
-	peakLists.resize( pHistograms.size() );
+	peakLists.resize( _histograms.size() );
 
-	pBrightestPeak = Vector<unsigned int>();
+	_brightestPeak = Vector<unsigned int>();
 
 	// creates histograms for all channels
-    for( size_t histIndex=0;histIndex<pHistograms.size();histIndex++ )
+    for( size_t histIndex=0;histIndex<_histograms.size();histIndex++ )
 	{
-		peakValue = pHistograms[histIndex].at<float>(0);
+		peakValue = _histograms[histIndex].at<float>(0);
 		peakCandidate=0;
 		edgeWidthCount=0;
 		lastSameHeightPeak=-1;
 
-        for( size_t color=1; color<pHistograms[histIndex].total(); color++ )
+        for( size_t color=1; color<_histograms[histIndex].total(); color++ )
 		{
-			if( pHistograms[histIndex].at<float>(color) > peakValue )
+			if( _histograms[histIndex].at<float>(color) > peakValue )
 			{
 				peakCandidate = color;
-				peakValue = pHistograms[histIndex].at<float>(color);
+				peakValue = _histograms[histIndex].at<float>(color);
 				edgeWidthCount = 0;
 				lastSameHeightPeak = -1;
 			}
-			else if( pHistograms[histIndex].at<float>(color) == peakValue )
+			else if( _histograms[histIndex].at<float>(color) == peakValue )
 			{
 				lastSameHeightPeak = color; //simple version: for a series of peaks of same height, the position of the peak is calculated as the middle of the first and the final peak...
 				edgeWidthCount = 0;
@@ -306,7 +419,7 @@ bool ColorRangeExpansion::calculateBrightestPeak( unsigned int peakExclusiveness
 		{
             for( unsigned int color=(*peak)[0]-1; color>=((*peak)[0]-minEdgeWidth); color-- )
             {
-				if( pHistograms[histIndex].at<float>(color) > (*peak)[1] )
+				if( _histograms[histIndex].at<float>(color) > (*peak)[1] )
 				{
 					invalidPeaks.push_back(peak);
                     deque<Vector<unsigned int> >::iterator tempPeak = peak;
@@ -336,20 +449,45 @@ bool ColorRangeExpansion::calculateBrightestPeak( unsigned int peakExclusiveness
 		
 		
 		// find the highest peak with brightest color in the set of found peaks
-		if( histIndex==0) pBrightestPeak=peakLists[histIndex].back();
-		else if( pBrightestPeak[0]<peakLists[histIndex].back()[0] ) pBrightestPeak=peakLists[histIndex].back();
+		if( histIndex==0) _brightestPeak=peakLists[histIndex].back();
+		else if( _brightestPeak[0]<peakLists[histIndex].back()[0] ) _brightestPeak=peakLists[histIndex].back();
 	}
 
-	if( pBrightestPeak.empty() ) return false;
+	if( _brightestPeak.empty() ) return false;
 	
 	return true;
 
 }
 
 
-bool ColorRangeExpansion::calculateHistograms( Mat& _image )
+bool ColorRangeExpansion::calculateHistograms( const Mat& _image, vector<Mat>& _histograms, int _samplingStep )
 {
-	
+	int step = max( _samplingStep, 1 );
+	if( step>1 && _image.depth()==CV_8U )
+	{
+		int channels = _image.channels();
+		vector< vector<unsigned int> > counts( channels, vector<unsigned int>( 256, 0 ) );
+		for( int y=0; y<_image.rows; y+=step )
+		{
+			const uchar* row = _image.ptr(y);
+			for( int x=0; x<_image.cols; x+=step )
+			{
+				const uchar* pixel = row+x*channels;
+				for( int c=0; c<channels; c++ ) counts[c][ pixel[c] ]++;
+			}
+		}
+
+		// scaled to the whole image: the thresholds of the analysis refer to pixel counts
+		double scale = (double)_image.total()/( ( (_image.rows+step-1)/step )*( (_image.cols+step-1)/step ) );
+		_histograms.resize( channels );
+		for( int c=0; c<channels; c++ )
+		{
+			_histograms[c] = Mat( 256, 1, CV_32F );
+			for( int i=0; i<256; i++ ) _histograms[c].at<float>(i) = counts[c][i]*scale;
+		}
+		return true;
+	}
+
 	int histSize = 256;
 	float range[] = {0,256};
 	const float* histRange = {range};
@@ -358,11 +496,11 @@ bool ColorRangeExpansion::calculateHistograms( Mat& _image )
 	vector<Mat> splitChannels;
 	split( _image,splitChannels );
 
-	pHistograms.resize( splitChannels.size() );
+	_histograms.resize( splitChannels.size() );
 
     for( size_t i=0; i<splitChannels.size(); i++ )
 	{
-		calcHist( &splitChannels[i], 1, 0, Mat(), pHistograms[i], 1, &histSize, &histRange, uniform, accumulate );
+		calcHist( &splitChannels[i], 1, 0, Mat(), _histograms[i], 1, &histSize, &histRange, uniform, accumulate );
 	}
 
 	return true;
@@ -371,7 +509,7 @@ bool ColorRangeExpansion::calculateHistograms( Mat& _image )
 
 bool ColorRangeExpansion::recalculateSettings()
 {
-    if( pRecalculationInterval<0 || (pRecalculationInterval==0 && pHistograms.size() !=0) )
+    if( pRecalculationInterval<0 || (pRecalculationInterval==0 && pHistogramsCalculated) )
 	{
 		return false;
 	}
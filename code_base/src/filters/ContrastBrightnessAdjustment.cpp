@@ -116,12 +116,18 @@ string ContrastBrightnessAdjustment::description() const
 
 bool ContrastBrightnessAdjustment::process( Mat& _image )
 {
-	LUT(_image ,pLookUpTable ,_image);
+	LUT(_image ,lookUpTable() ,_image);
 
 	return true;
 }
 
 
+bool ContrastBrightnessAdjustment::pointWise() const
+{
+	return true;
+}
+
+
 void ContrastBrightnessAdjustment::getOptions( st_is::GenericMultiLevelMap<string>& _options ) const
 {
 	_options["contrast_factor"].as<double>() = pContrastFactor;
@@ -192,7 +198,7 @@ void ContrastBrightnessAdjustment::recalculateLUT()
 		if( pixel > 255 ) pixel = 255;
 		element[i]=pixel;
 	}
-	pLookUpTable = lookUpTable;
+	setLookUpTable( lookUpTable );
 
 	return;
 }
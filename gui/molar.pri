@@ -7,21 +7,35 @@ HEADERS += ../code_base/stis/include/genericmultilevelmap.hpp \
     ../code_base/stis/ticpp/include/tinystr.h \
     ../code_base/stis/ticpp/include/tinyxml.h \
     ../code_base/include/core/Angle.h \
+    ../code_base/include/core/AsyncCapture.h \
     ../code_base/include/core/average.h \
+    ../code_base/include/core/BoundedQueue.h \
     ../code_base/include/core/CompressedFrame.h \
     ../code_base/include/core/DescriptorCreator.h \
     ../code_base/include/core/Dynamics.h \
     ../code_base/include/core/ExtendedKalmanFilter.h \
+    ../code_base/include/core/FilterChain.h \
     ../code_base/include/core/FilteredDynamics.h \
     ../code_base/include/core/frame.h \
+    ../code_base/include/core/FrameArchive.h \
+    ../code_base/include/core/FrameOverlay.h \
+    ../code_base/include/core/FrameScheduler.h \
     ../code_base/include/core/GenericObject.h \
     ../code_base/include/core/GOData.h \
     ../code_base/include/core/IPAlgorithm.h \
+    ../code_base/include/core/MemoryReport.h \
     ../code_base/include/core/objecthandler.h \
     ../code_base/include/core/Options.h \
+    ../code_base/include/core/OverlayRenderer.h \
+    ../code_base/include/core/Profiler.h \
     ../code_base/include/core/RectangleRegion.h \
     ../code_base/include/core/SceneHandler.h \
+    ../code_base/include/core/SceneHandlerPool.h \
     ../code_base/include/core/sceneobject.h \
+    ../code_base/include/core/SpillWriter.h \
+    ../code_base/include/core/StreamContext.h \
+    ../code_base/include/core/ThumbnailArchive.h \
+    ../code_base/include/core/Tracer.h \
     ../code_base/include/core/VideoBuffer.h \
     ../code_base/include/dynamic_modules/DirectedRodEMA.h \
     ../code_base/include/dynamic_modules/FreeKalman.h \
@@ -39,20 +53,33 @@ HEADERS += ../code_base/stis/include/genericmultilevelmap.hpp \
     ../gui/include/Runner.h \
     ../gui/include/cvmatdisplay.h
 SOURCES += ../code_base/src/core/Angle.cpp \
+    ../code_base/src/core/AsyncCapture.cpp \
     ../code_base/src/core/CompressedFrame.cpp \
     ../code_base/src/core/DescriptorCreator.cpp \
     ../code_base/src/core/Dynamics.cpp \
     ../code_base/src/core/ExtendedKalmanFilter.cpp \
+    ../code_base/src/core/FilterChain.cpp \
     ../code_base/src/core/FilteredDynamics.cpp \
     ../code_base/src/core/frame.cpp \
+    ../code_base/src/core/FrameArchive.cpp \
+    ../code_base/src/core/FrameOverlay.cpp \
+    ../code_base/src/core/FrameScheduler.cpp \
     ../code_base/src/core/GenericObject.cpp \
     ../code_base/src/core/GOData.cpp \
     ../code_base/src/core/IPAlgorithm.cpp \
+    ../code_base/src/core/MemoryReport.cpp \
     ../code_base/src/core/objecthandler.cpp \
     ../code_base/src/core/Options.cpp \
+    ../code_base/src/core/OverlayRenderer.cpp \
+    ../code_base/src/core/Profiler.cpp \
     ../code_base/src/core/RectangleRegion.cpp \
     ../code_base/src/core/SceneHandler.cpp \
+    ../code_base/src/core/SceneHandlerPool.cpp \
     ../code_base/src/core/sceneobject.cpp \
+    ../code_base/src/core/SpillWriter.cpp \
+    ../code_base/src/core/StreamContext.cpp \
+    ../code_base/src/core/ThumbnailArchive.cpp \
+    ../code_base/src/core/Tracer.cpp \
     ../code_base/src/core/VideoBuffer.cpp \
     ../code_base/src/dynamic_modules/DirectedRodEMA.cpp \
     ../code_base/src/dynamic_modules/FreeKalman.cpp \
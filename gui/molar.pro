@@ -12,7 +12,9 @@ unix:!mac {
         -lopencv_features2d \
         -lopencv_ml \
         -lboost_system \
-        -lboost_filesystem
+        -lboost_filesystem \
+        -lboost_chrono \
+        -lboost_thread
 }
 
 INCLUDEPATH += ../code_base/include/core \
@@ -197,7 +197,7 @@ void Runner::reinitialize( bool _withoutLock )
 		pScene->loadFromFile("lastproject.swsc");
         boost::filesystem::remove("temp/tempsave.xml");
 
-		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) SceneObject::resetObjectCount();
+		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) pScene->stream().resetObjectCount();
 
 		if( (*Options::General)["automatically_updated_program_data"]["last_stream_source"]["exists"].as<bool>() )
 		{
@@ -341,7 +341,7 @@ bool Runner::openProject( QString _path )
 	{
 		pScene->loadFromFile( myPath.string() );
 
-		SceneObject::resetObjectCount();
+		pScene->stream().resetObjectCount();
 
 		if( (*Options::General)["automatically_updated_program_data"]["last_stream_source"]["exists"].as<bool>() )
 		{
@@ -381,7 +381,7 @@ void Runner::createNewProject()
 	pVideoWriter = NULL;
 	pScene = new SceneHandler(false);
 	
-	SceneObject::resetObjectCount();
+	pScene->stream().resetObjectCount();
 	Options::resetUserSettings();
 	
 	
@@ -417,7 +417,7 @@ bool Runner::newCamSource( int _cameraId )
 		pScene->loadFromFile("lastproject.swsc");
         boost::filesystem::remove("temp/tempsave.xml");
 
-		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) SceneObject::resetObjectCount();
+		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) pScene->stream().resetObjectCount();
 
 		success = openNewStream( "", _cameraId );
 
@@ -465,7 +465,7 @@ bool Runner::newFileSource( QString _path )
         boost::filesystem::remove("temp/tempsave.xml");
 	
 
-		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) SceneObject::resetObjectCount();
+		if( (*Options::General)["general_settings"]["reset_object_count_on_reload"].as<bool>() ) pScene->stream().resetObjectCount();
 
 		success = openNewStream( myPath.string() );
 		
@@ -586,6 +586,7 @@ bool Runner::saveSnapshot( QString _path )
 void Runner::run()
 {
 	pThreadRunning = true;
+	if( pScene!=NULL ) pScene->tracer().setThreadName( "Runner" );
 
 	//(*pScene).addPreProcessingAlgorithm("color range expansion");
 	//(*pScene).typesInScene("ABFDrill","Unknown Type");
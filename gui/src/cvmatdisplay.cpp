@@ -114,6 +114,14 @@ void CVMatDisplay::convertImage( cv::Mat& _cvImage, cv::Mat& _cvTemp, QImage& _q
     case CV_8UC3:
         cvtColor(_cvImage, _cvTemp, CV_BGR2RGB);
         break;
+    case CV_16UC1: // only the upper 8 bits are displayed
+        _cvImage.convertTo(_cvTemp, CV_8U, 1.0/256);
+        cvtColor(_cvTemp, _cvTemp, CV_GRAY2RGB);
+        break;
+    case CV_16UC3:
+        _cvImage.convertTo(_cvTemp, CV_8UC3, 1.0/256);
+        cvtColor(_cvTemp, _cvTemp, CV_BGR2RGB);
+        break;
     }
 
     // QImage needs the data to be stored continuously in memory
@@ -0,0 +1,36 @@
+#pragma once
+/*Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** minimal checks shared by the test executables: a failing check is reported and counted, main() returns the number of failures */
+
+#include <iostream>
+
+
+/** number of checks that failed so far */
+inline int& testFailures()
+{
+	static int failures=0;
+	return failures;
+}
+
+#define MOLAR_CHECK( _condition ) \
+	do{ if( !(_condition) ){ std::cerr<<__FILE__<<":"<<__LINE__<<":: check failed: "<<#_condition<<std::endl; ++testFailures(); } }while(false)
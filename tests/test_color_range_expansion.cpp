@@ -0,0 +1,180 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <list>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "ColorRangeExpansion.h"
+#include "FilterChain.h"
+#include "TestUtilities.h"
+#include "boost/thread/thread.hpp"
+
+
+using namespace std;
+using namespace cv;
+
+
+/** a noisy colour image whose values only cover [60,180]: the expansion has something to stretch */
+static Mat createImage( int _rows, int _cols )
+{
+	Mat grey( _rows, _cols, CV_8U );
+	RNG rng(7);
+	rng.fill( grey, RNG::NORMAL, 120, 25 );
+	grey = max( grey, 60 );
+	grey = min( grey, 180 );
+
+	Mat image;
+	cvtColor( grey, image, CV_GRAY2BGR );
+	return image;
+}
+
+static void referenceHistograms( const Mat& _image, vector<Mat>& _histograms )
+{
+	int histSize = 256;
+	float range[] = {0,256};
+	const float* histRange = {range};
+
+	vector<Mat> channels;
+	split( _image, channels );
+	_histograms.resize( channels.size() );
+	for( size_t i=0; i<channels.size(); i++ ) calcHist( &channels[i], 1, 0, Mat(), _histograms[i], 1, &histSize, &histRange );
+}
+
+static bool sameTable( const Mat& _first, const Mat& _second )
+{
+	if( _first.empty() || _second.empty() || _first.size()!=_second.size() ) return false;
+	return norm( _first, _second, NORM_INF )==0;
+}
+
+static bool sameImage( const Mat& _first, const Mat& _second )
+{
+	return _first.size()==_second.size() && norm( _first, _second, NORM_INF )==0;
+}
+
+
+/** the sampled histograms have to be those of the sampled grid, scaled to the number of pixels of the whole image */
+static void testSampledHistograms()
+{
+	Mat image = createImage( 240, 320 );
+	vector<Mat> reference;
+	referenceHistograms( image, reference );
+
+	vector<Mat> histograms;
+	ColorRangeExpansion::calculateHistograms( image, histograms, 1 );
+	MOLAR_CHECK( histograms.size()==3 );
+	for( size_t c=0; c<histograms.size(); c++ ) MOLAR_CHECK( norm( histograms[c], reference[c], NORM_L1 )==0 );
+
+	// every second pixel of every second row, four times the counts of the grid
+	Mat grid( image.rows/2, image.cols/2, image.type() );
+	for( int y=0; y<grid.rows; y++ )
+	{
+		for( int x=0; x<grid.cols; x++ ) grid.at<Vec3b>(y,x) = image.at<Vec3b>(2*y,2*x);
+	}
+	vector<Mat> gridReference;
+	referenceHistograms( grid, gridReference );
+
+	ColorRangeExpansion::calculateHistograms( image, histograms, 2 );
+	MOLAR_CHECK( histograms.size()==3 );
+	for( size_t c=0; c<histograms.size(); c++ )
+	{
+		MOLAR_CHECK( norm( histograms[c], 4*gridReference[c], NORM_L1 )==0 );
+		// close to the histogram of the whole image
+		MOLAR_CHECK( norm( histograms[c], reference[c], NORM_L1 )<0.1*image.total() );
+	}
+
+	// image sizes that aren't a multiple of the step: the scaled counts still add up to the number of pixels
+	Mat oddImage = createImage( 241, 321 );
+	ColorRangeExpansion::calculateHistograms( oddImage, histograms, 3 );
+	for( size_t c=0; c<histograms.size(); c++ ) MOLAR_CHECK( std::abs( sum( histograms[c] )[0]-(double)oddImage.total() )<1e-3*oddImage.total() );
+}
+
+
+/** waits until the algorithm publishes the given look up table */
+static bool waitForTable( const IPAlgorithm& _algorithm, const Mat& _table, int _timeoutMs )
+{
+	for( int waited=0; waited<_timeoutMs; waited+=5 )
+	{
+		if( sameTable( _algorithm.lookUpTable(), _table ) ) return true;
+		boost::this_thread::sleep( boost::posix_time::milliseconds(5) );
+	}
+	return sameTable( _algorithm.lookUpTable(), _table );
+}
+
+/** the asynchronous analysis has to publish the table the synchronous one calculates, one or more frames after the histograms were taken,
+* and the FilterChain has to pick it up as soon as it is published */
+static void testAsynchronousTable()
+{
+	Mat image = createImage( 240, 320 );
+
+	GenericMultiLevelMap<string> options;
+	options["recalculation_interval"].as<int>() = 1;
+	options["histogram_sampling_step"].as<int>() = 2;
+	options["asynchronous_analysis"].as<bool>() = false;
+
+	ColorRangeExpansion synchronous;
+	synchronous.setOptions( options );
+	synchronous.updateLookUpTable( image );
+	Mat expected = synchronous.lookUpTable();
+
+	GenericMultiLevelMap<string> expansionEnds;
+	synchronous.getOptions( expansionEnds );
+	MOLAR_CHECK( expansionEnds["darkest_occuring_color"].as<unsigned int>()>0 );
+	Mat expectedImage;
+	LUT( image, expected, expectedImage );
+	MOLAR_CHECK( !sameImage( expectedImage, image ) );
+
+	options["asynchronous_analysis"].as<bool>() = true;
+	ColorRangeExpansion* asynchronous = new ColorRangeExpansion();
+	asynchronous->setOptions( options ); // publishes the identity table of the default expansion ends
+	list< Ptr<IPAlgorithm> > stack;
+	stack.push_back( Ptr<IPAlgorithm>( asynchronous ) );
+	FilterChain chain;
+
+	// the histograms are taken from the image, the table applied to it is the old one or, if the analysis was fast enough, the new one
+	MOLAR_CHECK( asynchronous->needsImage() );
+	Mat frame = image.clone();
+	MOLAR_CHECK( chain.apply( stack, frame ) );
+	MOLAR_CHECK( sameImage( frame, image ) || sameImage( frame, expectedImage ) );
+
+	MOLAR_CHECK( waitForTable( *asynchronous, expected, 5000 ) );
+
+	// the published table is used from the next frame on (the analysis of that frame publishes the same table again)
+	MOLAR_CHECK( asynchronous->needsImage() );
+	frame = image.clone();
+	MOLAR_CHECK( chain.apply( stack, frame ) );
+	MOLAR_CHECK( chain.passes()==1 );
+	MOLAR_CHECK( sameImage( frame, expectedImage ) );
+}
+
+
+int main()
+{
+	testSampledHistograms();
+	testAsynchronousTable();
+
+	if( testFailures()==0 ) cout<<"test_color_range_expansion: passed"<<endl;
+	return testFailures();
+}
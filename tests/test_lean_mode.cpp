@@ -0,0 +1,104 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "SceneHandler.h"
+#include "Options.h"
+#include "TestUtilities.h"
+
+
+using namespace std;
+using namespace cv;
+
+
+/** two dark objects on a bright background that move towards each other, touch (the missing object search has to separate them) and part again */
+static void renderFrame( Mat& _frame, int _i )
+{
+	_frame.create( 240, 320, CV_8UC3 );
+	_frame.setTo( Scalar::all(230) );
+	double offset = 70*cos( _i*0.08 );
+	ellipse( _frame, Point2d( 160-offset, 110 ), Size(28,9), 10, 0, 360, Scalar::all(40), -1 );
+	ellipse( _frame, Point2d( 160+offset, 130 ), Size(28,9), -10, 0, 360, Scalar::all(40), -1 );
+}
+
+/** object positions after every frame */
+typedef vector< vector<Point2d> > Track;
+
+static Track runScene( bool _buffering, int _frames, vector<size_t>& _frameMemory )
+{
+	(*Options::General)["runtime"]["buffer"]["activated"].as<bool>() = _buffering;
+	SceneHandler::setupOptions();
+
+	SceneHandler scene(false);
+	Track track;
+	Mat frame;
+	for( int i=0; i<_frames; i++ )
+	{
+		renderFrame( frame, i );
+		scene.pushFrame( frame, i*33 );
+
+		vector< Ptr<SceneObject> > objects;
+		scene.objects().activeObjects( objects );
+		track.push_back( vector<Point2d>() );
+		for( size_t j=0; j<objects.size(); j++ )
+		{
+			Ptr<SceneObject::State> state = objects[j]->state();
+			if( !state.empty() ) track.back().push_back( Point2d( state->x, state->y ) );
+		}
+		_frameMemory.push_back( scene.memoryReport().frameBuffer );
+	}
+	return track;
+}
+
+
+/** tracks the same scene with and without the video buffer: the lean mode has to track exactly the same and keep the memory used for frames
+* constant (the frame buffers are recycled) */
+int main()
+{
+	const int frames = 120;
+
+	vector<size_t> bufferedMemory, leanMemory;
+	Track buffered = runScene( true, frames, bufferedMemory );
+	Track lean = runScene( false, frames, leanMemory );
+
+	MOLAR_CHECK( buffered.size()==lean.size() );
+	for( size_t i=0; i<buffered.size() && i<lean.size(); i++ )
+	{
+		MOLAR_CHECK( buffered[i].size()==lean[i].size() );
+		for( size_t j=0; j<buffered[i].size() && j<lean[i].size(); j++ )
+		{
+			MOLAR_CHECK( norm( buffered[i][j]-lean[i][j] )<1e-9 );
+		}
+	}
+
+	// a few frames in, the frames in use and the recycled ones don't grow anymore
+	for( int i=10; i<frames; i++ ) MOLAR_CHECK( leanMemory[i]==leanMemory[9] );
+
+	if( testFailures()==0 ) cout<<"test_lean_mode: passed"<<endl;
+	return testFailures();
+}
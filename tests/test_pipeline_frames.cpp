@@ -0,0 +1,68 @@
+/*  Copyright (c) 2014, Stefan Isler, islerstefan@bluewin.ch
+ *
+    This file is part of MOLAR (Multiple Object Localization And Recognition),
+    which was originally developed as part of a Bachelor thesis at the
+    Institute of Robotics and Intelligent Systems (IRIS) of ETH Zurich.
+
+    MOLAR is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    MOLAR is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with MOLAR.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <iostream>
+
+#include <opencv2/core/core.hpp>
+
+#include "SceneHandler.h"
+#include "TestUtilities.h"
+
+
+using namespace std;
+using namespace cv;
+
+
+/** pushes one reused frame buffer through the pipeline, overwriting it right after every push, and checks that each frame
+* arrives in the video buffer with the content it had when it was pushed */
+int main()
+{
+	const int frames = 8;
+
+	SceneHandler scene(false);
+	scene.setDetectionThreads(2);
+	scene.setPipelined(true);
+
+	Mat frame( 120, 160, CV_8UC3 );
+	for( int i=0; i<frames; i++ )
+	{
+		frame.setTo( Scalar::all(10+10*i) );
+		scene.pushFrame( frame, i*40 );
+	}
+	frame.setTo( Scalar::all(0) );
+	scene.flush();
+
+	for( int i=0; i<frames; i++ )
+	{
+		Mat const & original = scene.getOriginalFrame( frames-1-i ); // 0 is the newest frame
+		MOLAR_CHECK( !original.empty() );
+		if( original.empty() ) continue;
+		Scalar value = mean( original );
+		MOLAR_CHECK( value[0]==10+10*i );
+		MOLAR_CHECK( value[2]==10+10*i );
+	}
+
+	scene.setPipelined(false);
+
+	if( testFailures()==0 ) cout<<"test_pipeline_frames: passed"<<endl;
+	return testFailures();
+}